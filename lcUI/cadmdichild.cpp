@@ -15,6 +15,8 @@
 using namespace lc::ui;
 using namespace lc::viewer;
 
+const int CadMdiChild::REBALANCE_DELAY;
+
 CadMdiChild::CadMdiChild(QWidget* parent) :
     QWidget(parent),
     _id(0),
@@ -64,9 +66,19 @@ CadMdiChild::CadMdiChild(QWidget* parent) :
             _viewer, SLOT(setHorizontalOffset(int)));
     connect(verticalScrollBar, SIGNAL(valueChanged(int)),
             _viewer, SLOT(setVerticalOffset(int)));
+
+    // Restarted by each operation, so the storage is rebalanced when the user stops editing
+    _rebalanceTimer = new QTimer(this);
+    _rebalanceTimer->setSingleShot(true);
+    _rebalanceTimer->setInterval(REBALANCE_DELAY);
+    connect(_rebalanceTimer, SIGNAL(timeout()), this, SLOT(rebalance()));
 }
 
 CadMdiChild::~CadMdiChild() {
+    if(_document != nullptr) {
+        _document->commitProcessEvent().disconnect<CadMdiChild, &CadMdiChild::on_commitProcessEvent>(this);
+    }
+
 	if(_destroyCallback) {
 		_destroyCallback(_id);
 	}
@@ -111,6 +123,7 @@ void CadMdiChild::newDocument() {
     // Undo manager takes care that we can undo/redo entities within a document
     _undoManager = std::make_shared<lc::storage::UndoManagerImpl>(10);
     _document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(_undoManager.get());
+    _document->commitProcessEvent().connect<CadMdiChild, &CadMdiChild::on_commitProcessEvent>(this);
 
     _activeLayer = _document->layerByName("0");
 }
@@ -179,6 +192,16 @@ void CadMdiChild::saveFile() {
     lc::persistence::File::save(_document, file.toStdString(), type);
 }
 
+void CadMdiChild::on_commitProcessEvent(const lc::event::CommitProcessEvent& event) {
+    _rebalanceTimer->start();
+}
+
+void CadMdiChild::rebalance() {
+    if(_storageManager != nullptr) {
+        _storageManager->rebalance();
+    }
+}
+
 void CadMdiChild::ctxMenu(const QPoint& pos) {
     auto menu = new QMenu;
     menu->addAction(tr("Test Item"), this, SLOT(test_slot()));
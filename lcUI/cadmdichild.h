@@ -1,5 +1,6 @@
 #pragma once
 #include <QScrollBar>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QKeyEvent>
@@ -8,6 +9,7 @@
 #include <cad/storage/storagemanager.h>
 
 #include "cad/storage/document.h"
+#include "cad/events/commitprocessevent.h"
 #include "cad/storage/undomanager.h"
 #include <drawables/lccursor.h>
 #include <managers/snapmanager.h>
@@ -65,6 +67,13 @@ namespace lc {
 
                 void ctxMenu(const QPoint& pos);
 
+            private slots:
+
+                /**
+                 * \brief Rebalance the storage of the document once no operation was done for a while
+                 */
+                void rebalance();
+
             signals:
 
                 void keyPressed(QKeyEvent* event);
@@ -132,6 +141,13 @@ namespace lc {
                 const viewer::manager::SnapManagerImpl_SPtr& getSnapManager() const;
 
             private:
+                /**
+                 * \brief Time without operations before the storage gets rebalanced, in milliseconds
+                 */
+                static const int REBALANCE_DELAY = 2000;
+
+                void on_commitProcessEvent(const lc::event::CommitProcessEvent& event);
+
                 unsigned int _id;
 
                 LuaIntf::LuaRef _destroyCallback;
@@ -154,6 +170,7 @@ namespace lc {
 
                 QScrollBar* horizontalScrollBar;
                 QScrollBar* verticalScrollBar;
+                QTimer* _rebalanceTimer;
 
                 ui::LCADViewer* _viewer;
         };
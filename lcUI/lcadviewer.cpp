@@ -39,6 +39,7 @@ void LCADViewer::setDocument(std::shared_ptr<lc::storage::Document> document) {
     _docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document, [this](double* x, double* y) {
         _documentPainter->device_to_user(x, y);
     });
+    _tileCache = std::make_shared<lc::viewer::TileCache>(_docCanvas, lc::viewer::createCairoImagePainter);
 
     _document = document;
     _document->commitProcessEvent().connect<LCADViewer, &LCADViewer::on_commitProcessEvent>(this);
@@ -306,8 +307,9 @@ void LCADViewer::updateBackground() {
 }
 
 void LCADViewer::updateDocument() {
-    _documentPainter->clear(1.0, 1.0, 1.0, 0.0);
-    _docCanvas->render(*_documentPainter, lc::viewer::VIEWER_DOCUMENT);
+    // The tiles cover the whole image, so it doesn't need to be cleared
+    auto image = imagemaps.at(_documentPainter);
+    _tileCache->render(*_documentPainter, image->bits(), image->width(), image->height());
 }
 
 const std::shared_ptr<lc::viewer::DocumentCanvas>& LCADViewer::docCanvas() const {
@@ -18,6 +18,7 @@
 #include <managers/dragmanager.h>
 
 #include "documentcanvas.h"
+#include "tilecache.h"
 
 #include "painters/createpainter.h"
 
@@ -132,6 +133,8 @@ namespace lc {
                 // For selection
                 bool _ctrlKeyActive;
                 std::shared_ptr<lc::viewer::DocumentCanvas> _docCanvas;
+                // Rendered tiles of the document, so panning and small edits don't render the whole view
+                lc::viewer::TileCache_SPtr _tileCache;
                 bool _mouseScrollKeyActive;
 
                 bool _operationActive;
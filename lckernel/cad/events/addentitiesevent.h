@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+#include "cad/const.h"
+#include "cad/base/cadentity.h"
+
+namespace lc {
+    namespace event {
+        /**
+         * Event that gets emitted when a set of entities was added to the document at once
+         * Listeners can process the entities in a single pass instead of receiving a AddEntityEvent for each entity.
+         * @param cadEntities
+         */
+        class AddEntitiesEvent {
+            public:
+                /*!
+                 * \brief Construct a Add Entities Event
+                 * \param cadEntities Entities added to the document, must outlive the event
+                 */
+                AddEntitiesEvent(const std::vector<entity::CADEntity_CSPtr>& cadEntities) : _cadEntities(cadEntities) {
+                    std::unordered_set<meta::Block_CSPtr> blocks;
+
+                    for (const auto& entity : _cadEntities) {
+                        if (entity->block() != nullptr && blocks.insert(entity->block()).second) {
+                            _blocks.push_back(entity->block());
+                        }
+                    }
+                }
+
+                /*!
+                 * \brief Returns the entities.
+                 * \return vector of entities
+                 */
+                const std::vector<entity::CADEntity_CSPtr>& entities() const {
+                    return _cadEntities;
+                }
+
+                /*!
+                 * \brief Returns the blocks containing some of the entities.
+                 * \return vector of blocks, without duplicates
+                 */
+                const std::vector<meta::Block_CSPtr>& blocks() const {
+                    return _blocks;
+                }
+
+            private:
+                const std::vector<entity::CADEntity_CSPtr>& _cadEntities;
+                std::vector<meta::Block_CSPtr> _blocks;
+        };
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+#include "cad/const.h"
+#include "cad/base/cadentity.h"
+
+namespace lc {
+    namespace event {
+        /**
+         * Event that gets emitted when a set of entities was removed from the document at once
+         * Listeners can process the entities in a single pass instead of receiving a RemoveEntityEvent for each entity.
+         * @param cadEntities
+         */
+        class RemoveEntitiesEvent {
+            public:
+                /*!
+                 * \brief Construct a Remove Entities Event
+                 * \param cadEntities Entities removed from the document, must outlive the event
+                 */
+                RemoveEntitiesEvent(const std::vector<entity::CADEntity_CSPtr>& cadEntities) : _cadEntities(cadEntities) {
+                    std::unordered_set<meta::Block_CSPtr> blocks;
+
+                    for (const auto& entity : _cadEntities) {
+                        if (entity->block() != nullptr && blocks.insert(entity->block()).second) {
+                            _blocks.push_back(entity->block());
+                        }
+                    }
+                }
+
+                /*!
+                 * \brief Returns the entities.
+                 * \return vector of entities
+                 */
+                const std::vector<entity::CADEntity_CSPtr>& entities() const {
+                    return _cadEntities;
+                }
+
+                /*!
+                 * \brief Returns the blocks containing some of the entities.
+                 * \return vector of blocks, without duplicates
+                 */
+                const std::vector<meta::Block_CSPtr>& blocks() const {
+                    return _blocks;
+                }
+
+            private:
+                const std::vector<entity::CADEntity_CSPtr>& _cadEntities;
+                std::vector<meta::Block_CSPtr> _blocks;
+        };
+    }
+}
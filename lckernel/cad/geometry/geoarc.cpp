@@ -92,14 +92,11 @@ Coordinate Arc::nearestPointOnEntity(const Coordinate &coord) const {
     // if the angle is between start and stop then calculate the nearest point
     // on it's entity
     if (isAngleBetween(angle)) {
-        return center() + angle * radius();
+        return center() + Coordinate(angle) * radius();
     }
 
-    // Find out if angle is closer to start or end and return the appropriate coordinate
-    const auto ad1 = std::abs(angle - _startAngle);
-    const auto ad2 = std::abs(angle - _endAngle);
-
-    if (ad1 <= ad2) {
+    // Find out if start or end is closer and return the appropriate coordinate
+    if (startP().distanceTo(coord) <= endP().distanceTo(coord)) {
         return startP();
     }
     else {
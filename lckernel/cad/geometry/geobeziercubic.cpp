@@ -1,8 +1,17 @@
 #include "geobeziercubic.h"
+#include <algorithm>
+#include <limits>
 
 using namespace lc;
 using namespace geo;
 
+// Parts of the curve deviating less than this fraction of the curve size from their chord are not subdivided
+static const double NEAREST_POINT_FLATNESS = 1e-3;
+// Smallest interval of t which is subdivided
+static const double NEAREST_POINT_MINIMUM_INTERVAL = 1e-9;
+// Newton iterations refining the point found on the chord of a flat part
+static const unsigned int NEAREST_POINT_NEWTON_ITERATIONS = 4;
+
 CubicBezier::CubicBezier(Coordinate point_a, Coordinate point_b, Coordinate point_c, Coordinate point_d) :
         _pointA(std::move(point_a)),
         _pointB(std::move(point_b)),
@@ -18,6 +27,23 @@ CubicBezier::CubicBezier(const CubicBezier &bez) :
 
 }
 
+namespace {
+    /**
+     * @brief Roots of a t^2 + b t + c, also when a is 0
+     */
+    std::vector<double> derivativeRoots(double a, double b, double c) {
+        if (std::abs(a) < std::numeric_limits<double>::epsilon()) {
+            if (std::abs(b) < std::numeric_limits<double>::epsilon()) {
+                return std::vector<double>();
+            }
+
+            return {-c / b};
+        }
+
+        return lc::maths::Math::quadraticSolver({b / a, c / a});
+    }
+}
+
 const Area CubicBezier::boundingBox() const {
     auto v1 =(_pointB - _pointA)*3;
     auto v2 = (_pointC - _pointB)*3;
@@ -27,12 +53,11 @@ const Area CubicBezier::boundingBox() const {
     auto b = (v2 - v1)*2;
     const auto& c = v1;
 
-    std::vector<double> x_roots = lc::maths::Math::quadraticSolver({b.x()/a.x(), c.x()/a.x()});
-    std::vector<double> y_roots = lc::maths::Math::quadraticSolver({b.y()/a.y(), b.y()/a.y()});
-
-    std::vector<double> x_{_pointA.x(), _pointB.x(),_pointC.x(), _pointD.x() };
-    std::vector<double> y_{_pointA.y(), _pointB.y(),_pointC.y(), _pointD.y() };
+    std::vector<double> x_roots = derivativeRoots(a.x(), b.x(), c.x());
+    std::vector<double> y_roots = derivativeRoots(a.y(), b.y(), c.y());
 
+    std::vector<double> x_{_pointA.x(), _pointD.x() };
+    std::vector<double> y_{_pointA.y(), _pointD.y() };
 
     for(const double tx_ : x_roots) {
         if(tx_ > 0. && tx_ < 1.0) {
@@ -108,21 +133,101 @@ Coordinate CubicBezier::nearestPointOnEntity(const Coordinate& coord) const {
  * @return vector of t values for bezier
  */
 std::vector<double> CubicBezier::nearestPointTValue(const lc::geo::Coordinate &coord) const {
-    //    auto pos = _pointA - coord;
+    /*
+     * The distance to a cubic bezier has no closed form, so the curve is subdivided.
+     * A part of the curve lies within the box of its control points, parts which can't be closer
+     * than the closest point found so far are skipped. Parts which are flat enough are replaced by
+     * their chord, the point found on the chord is refined with Newton's method on the curve.
+     */
+    struct Part {
+        Coordinate a, b, c, d;
+        double t0, t1;
+    };
+
+    const auto box = boundingBox();
+    const double size = box.minP().distanceTo(box.maxP());
+    const double flatness = std::max(size * NEAREST_POINT_FLATNESS, std::numeric_limits<double>::epsilon());
+
+    double bestT = 0.;
+    double best = coord.distanceTo(_pointA);
+    if (coord.distanceTo(_pointD) < best) {
+        bestT = 1.;
+        best = coord.distanceTo(_pointD);
+    }
 
-    //    auto Ax = _pointB.x() - _pointA.x();
-    //    auto Ay = _pointB.y() - _pointA.y();
-    //    auto Bx = _pointA.x() - (_pointB.x()*2.0) + _pointC.x();
-    //    auto By = _pointA.y() - (_pointB.y()*2.0) + _pointC.y();
+    std::vector<Part> parts{{_pointA, _pointB, _pointC, _pointD, 0., 1.}};
+    while (!parts.empty()) {
+        const Part part = parts.back();
+        parts.pop_back();
 
-    //    auto a = Bx * Bx + By * By;
-    //    auto b = (3 * (Ax * Bx + Ay * By)) / a;
-    //    auto c = (2 * (Ax * Ax + Ay * Ay) + pos.x() * Bx + pos.y() * By) / a;
-    //    auto d = (pos.x() * Ax + pos.y() * Ay) / a;
+        const Area hull = Area(part.a, part.d).merge(part.b).merge(part.c);
+        const double dx = std::max(std::max(hull.minP().x() - coord.x(), 0.), coord.x() - hull.maxP().x());
+        const double dy = std::max(std::max(hull.minP().y() - coord.y(), 0.), coord.y() - hull.maxP().y());
+        if (std::sqrt(dx * dx + dy * dy) >= best) {
+            continue;
+        }
 
-    //    return lc::Math::cubicSolver({b, c, d});
-    std::vector<double> empty(0, 0.);
-    return empty; // TODO: no return statement
+        const auto chord = part.d - part.a;
+        const double chordLength = chord.magnitude();
+        const double deviation = chordLength < flatness ?
+                                 std::max(part.b.distanceTo(part.a), part.c.distanceTo(part.a)) :
+                                 std::max(std::abs(chord.x() * (part.b.y() - part.a.y()) - chord.y() * (part.b.x() - part.a.x())),
+                                          std::abs(chord.x() * (part.c.y() - part.a.y()) - chord.y() * (part.c.x() - part.a.x()))) / chordLength;
+
+        if (deviation > flatness && part.t1 - part.t0 > NEAREST_POINT_MINIMUM_INTERVAL) {
+            const auto ab = part.a.mid(part.b);
+            const auto bc = part.b.mid(part.c);
+            const auto cd = part.c.mid(part.d);
+            const auto abc = ab.mid(bc);
+            const auto bcd = bc.mid(cd);
+            const auto middle = abc.mid(bcd);
+            const double t = (part.t0 + part.t1) / 2.;
+
+            parts.push_back({middle, bcd, cd, part.d, t, part.t1});
+            parts.push_back({part.a, ab, abc, middle, part.t0, t});
+            continue;
+        }
+
+        double t = part.t0;
+        if (chordLength > 0.) {
+            const double s = std::min(std::max((coord - part.a).dot(chord) / (chordLength * chordLength), 0.), 1.);
+            t = part.t0 + s * (part.t1 - part.t0);
+        }
+
+        for (unsigned int i = 0; i < NEAREST_POINT_NEWTON_ITERATIONS; i++) {
+            const auto delta = DirectValueAt(t) - coord;
+            const auto first = derivative(t);
+            const auto second = secondDerivative(t);
+            const double denominator = first.dot(first) + delta.dot(second);
+
+            if (std::abs(denominator) < std::numeric_limits<double>::epsilon()) {
+                break;
+            }
+
+            t = std::min(std::max(t - delta.dot(first) / denominator, 0.), 1.);
+        }
+
+        const double distance = coord.distanceTo(DirectValueAt(t));
+        if (distance < best) {
+            best = distance;
+            bestT = t;
+        }
+    }
+
+    return {bestT};
+}
+
+Coordinate CubicBezier::derivative(double t) const {
+    const double one_minus_t = 1. - t;
+
+    return (_pointB - _pointA) * (3. * one_minus_t * one_minus_t) +
+           (_pointC - _pointB) * (6. * one_minus_t * t) +
+           (_pointD - _pointC) * (3. * t * t);
+}
+
+Coordinate CubicBezier::secondDerivative(double t) const {
+    return (_pointC - _pointB * 2. + _pointA) * (6. * (1. - t)) +
+           (_pointD - _pointC * 2. + _pointB) * (6. * t);
 }
 
 const std::vector<geo::Coordinate> CubicBezier::getCP() const {
@@ -142,20 +247,19 @@ const std::vector<geo::Coordinate> CubicBezier::getCP() const {
 const lc::geo::Coordinate CubicBezier::returnCasesForNearestPoint(
         double min_distance, const lc::geo::Coordinate &coord,
         const lc::geo::Coordinate &ret) const {
-    //    auto distance_to_A = coord.distanceTo(_pointA);
-    //    auto distance_to_C = coord.distanceTo(_pointC);
-
-    //    // Point is on curve
-    //    if(min_distance < distance_to_A && min_distance < distance_to_C) {
-    //        return ret;
-    //    }
-    //    // Point is on starting of Curve
-    //    if (distance_to_A < distance_to_C) {
-    //        return _pointA;
-    //    }
-    //    // Point is end of curve
-    //    return _pointC;
-    return ret; // TODO: no return statement
+    auto distance_to_A = coord.distanceTo(_pointA);
+    auto distance_to_D = coord.distanceTo(_pointD);
+
+    // Point is on curve
+    if(min_distance < distance_to_A && min_distance < distance_to_D) {
+        return ret;
+    }
+    // Point is on starting of Curve
+    if (distance_to_A < distance_to_D) {
+        return _pointA;
+    }
+    // Point is end of curve
+    return _pointD;
 }
 
 Coordinate CubicBezier::CasteljauAt(std::vector<Coordinate> points, double t) const {
@@ -139,6 +139,15 @@ namespace lc {
                 virtual BB_CSPtr mirror(const geo::Coordinate& axis1, const geo::Coordinate& axis2) const override;
 
             private:
+                /**
+                 * @brief First derivative of the bezier at time t
+                 */
+                Coordinate derivative(double t) const;
+
+                /**
+                 * @brief Second derivative of the bezier at time t
+                 */
+                Coordinate secondDerivative(double t) const;
 
                 virtual std::vector<double> nearestPointTValue(const Coordinate &coord) const override;
                 virtual const lc::geo::Coordinate returnCasesForNearestPoint(
@@ -66,16 +66,21 @@ double Spline::fitTolerance() const {
 }
 
 Coordinate Spline::nearestPointOnPath(const Coordinate &coord) const {
-    /* TODO implement
-     * fix compiler warning
-     */
-    return Coordinate();
+    // The path of a spline ends where the spline ends
+    return nearestPointOnEntity(coord);
 }
+
 Coordinate Spline::nearestPointOnEntity(const Coordinate &coord) const {
-    /* TODO implement
-     * fix compiler warning
-     */
-    return Coordinate();
+    if (_beziers.empty()) {
+        return _controlPoints.empty() ? Coordinate() : _controlPoints.front();
+    }
+
+    // Only the beziers with a bounding box closer than the nearest point found so far are solved
+    auto nearest = bezierTree().nearest(coord, [this, &coord](size_t index) {
+        return _beziers[index]->nearestPointOnEntity(coord).distanceTo(coord);
+    });
+
+    return _beziers[nearest.first]->nearestPointOnEntity(coord);
 }
 
 void Spline::populateCurve() {
@@ -99,10 +104,23 @@ void Spline::populateCurve() {
     }
 }
 
-const std::vector<BB_CSPtr> Spline::beziers() const {
+const std::vector<BB_CSPtr>& Spline::beziers() const {
     return _beziers;
 }
 
+const lc::storage::SegmentBVH& Spline::bezierTree() const {
+    return _bezierTree.get([this]() {
+        std::vector<Area> boxes;
+        boxes.reserve(_beziers.size());
+
+        for (const auto& bezier : _beziers) {
+            boxes.push_back(bezier->boundingBox());
+        }
+
+        return boxes;
+    });
+}
+
 /*
  * Need to be updated to return bezier objects instead of returning coordinate vectors.
  * No external need to cast to bezier and then find intersections.
@@ -7,6 +7,7 @@
 #include "cad/geometry/geobezierbase.h"
 #include "cad/geometry/geobezier.h"
 #include "cad/geometry/geobeziercubic.h"
+#include "cad/storage/segmentbvh.h"
 #include <tinyspline/tinysplinecpp.h>
 
 namespace lc {
@@ -97,7 +98,14 @@ namespace lc {
                  * @return bool closed
                  */
                 bool closed() const;
-                const std::vector<BB_CSPtr> beziers() const;
+                const std::vector<BB_CSPtr>& beziers() const;
+
+                /**
+                 * @brief Bounding volume hierarchy over the bounding boxes of beziers(), built on first use
+                 * Copies of the spline share it
+                 */
+                const storage::SegmentBVH& bezierTree() const;
+
                 void generateBeziers();
                 void trimAtPoint(const geo::Coordinate& c);
 
@@ -107,6 +115,7 @@ namespace lc {
                 void populateCurve();
                 /*!
                  * \brief returns the nearest Point On Path
+                 * The path of a spline is the spline itself
                  * \param lc::geo::Coordinate coord
                  * \return lc::geo::Coordinate nearest coordinate
                  */
@@ -114,6 +123,7 @@ namespace lc {
 
                 /*!
                  * \brief returns the nearest Point On Entity itself.
+                 * Uses bezierTree() to solve only the beziers which can contain the nearest point
                  * \param lc::geo::Coordinate coord
                  * \return lc::geo::Coordinate nearest coordinate
                  */
@@ -145,6 +155,7 @@ namespace lc {
 
                 ts::BSpline _splineCurve;
                 std::vector<BB_CSPtr> _beziers;
+                storage::LazySegmentBVH _bezierTree;
                 const splineflag _flags;
         };
     }
@@ -1,8 +1,190 @@
 #include "intersect.h"
 #include "cad/math/intersectionhandler.h"
+#include <algorithm>
+#include <thread>
 
 using namespace lc::maths;
 
+namespace {
+    // Pairs of entities are only spread over multiple threads when each thread gets at least this many pairs
+    const size_t MINIMUM_PAIRS_PER_THREAD = 256;
+
+    using EntityPair = std::pair<size_t, size_t>;
+
+    /**
+     * Call func(const LWSegment2D&) for the segments of lwp which can intersect something inside area.
+     * All segments are visited when intersections on the path outside the segments are requested.
+     */
+    template<typename T>
+    void visitSegments(const lc::entity::LWPolyline& lwp, const lc::geo::Area& area,
+                       Intersect::Method method, double tolerance, T func) {
+        if (method == Intersect::OnPath) {
+            for (const auto& segment : lwp.segments()) {
+                func(segment);
+            }
+            return;
+        }
+
+        lwp.visitSegments(area.increaseBy(tolerance), func);
+    }
+
+    /**
+     * Sweep and prune over the bounding boxes, returns the pairs of boxes that overlap sorted on index.
+     * Boxes are sorted on their left side, while sweeping from left to right only the boxes that weren't passed yet
+     * are kept active and tested in y.
+     * When firstOther is smaller than the number of boxes, only pairs of a box before firstOther with a box starting
+     * at firstOther are returned.
+     */
+    std::vector<EntityPair> overlappingPairs(const std::vector<lc::geo::Area>& boxes, size_t firstOther) {
+        std::vector<size_t> order(boxes.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return boxes[a].minP().x() < boxes[b].minP().x() ||
+                   (boxes[a].minP().x() == boxes[b].minP().x() && a < b);
+        });
+
+        const bool across = firstOther < boxes.size();
+        std::vector<EntityPair> pairs;
+        std::vector<size_t> active;
+
+        for (size_t i : order) {
+            const auto& box = boxes[i];
+
+            active.erase(std::remove_if(active.begin(), active.end(), [&](size_t a) {
+                return boxes[a].maxP().x() < box.minP().x();
+            }), active.end());
+
+            for (size_t a : active) {
+                if (across && (a < firstOther) == (i < firstOther)) {
+                    continue;
+                }
+
+                if (boxes[a].maxP().y() >= box.minP().y() && boxes[a].minP().y() <= box.maxP().y()) {
+                    pairs.emplace_back(std::min(a, i), std::max(a, i));
+                }
+            }
+
+            active.push_back(i);
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    /**
+     * Split count pairs in contiguous ranges over multiple threads.
+     * intersectRange(begin, end) returns the intersections of a range of pairs, the results are merged in the
+     * order of the ranges so they don't depend on the number of threads
+     */
+    template<typename T>
+    std::vector<lc::geo::Coordinate> intersectPairs(size_t count, T intersectRange) {
+        const size_t threads = std::max((size_t) 1, std::min((size_t) std::thread::hardware_concurrency(),
+                                                             count / MINIMUM_PAIRS_PER_THREAD));
+
+        if (threads == 1) {
+            return intersectRange(0, count);
+        }
+
+        std::vector<std::vector<lc::geo::Coordinate>> results(threads);
+        auto intersectChunk = [&](size_t chunk) {
+            results[chunk] = intersectRange(count * chunk / threads, count * (chunk + 1) / threads);
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+
+        for (size_t chunk = 1; chunk < threads; chunk++) {
+            workers.emplace_back(intersectChunk, chunk);
+        }
+
+        intersectChunk(0);
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        std::vector<lc::geo::Coordinate> result = std::move(results[0]);
+        for (size_t chunk = 1; chunk < threads; chunk++) {
+            result.insert(result.end(), results[chunk].begin(), results[chunk].end());
+        }
+
+        return result;
+    }
+
+    /**
+     * Intersect the pairs of entities and others with overlapping bounding boxes.
+     * When others is empty, the pairs within entities are intersected instead.
+     * Paths extend beyond the bounding box of an entity, so all pairs are intersected with OnPath
+     */
+    std::vector<lc::geo::Coordinate> intersectEntities(const std::vector<lc::entity::CADEntity_CSPtr>& entities,
+                                                       const std::vector<lc::entity::CADEntity_CSPtr>& others,
+                                                       Intersect::Method method, double tolerance) {
+        auto entity = [&](size_t index) -> const lc::entity::CADEntity& {
+            return index < entities.size() ? *entities[index] : *others[index - entities.size()];
+        };
+
+        if (method == Intersect::OnPath) {
+            if (others.empty()) {
+                const size_t n = entities.size();
+
+                if (n < 2) {
+                    return {};
+                }
+
+                return intersectPairs(n * (n - 1) / 2, [&](size_t begin, size_t end) {
+                    // Find the pair at index begin, pairs are ordered as (0, 1), (0, 2) .. (1, 2) ..
+                    size_t a = 0;
+                    while (begin - (a * (2 * n - a - 1)) / 2 >= n - a - 1) {
+                        a++;
+                    }
+                    size_t b = a + 1 + begin - (a * (2 * n - a - 1)) / 2;
+
+                    Intersect intersect(method, tolerance);
+                    for (size_t i = begin; i < end; i++) {
+                        visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, entity(a), entity(b));
+
+                        if (++b == n) {
+                            a++;
+                            b = a + 1;
+                        }
+                    }
+                    return intersect.result();
+                });
+            }
+
+            return intersectPairs(entities.size() * others.size(), [&](size_t begin, size_t end) {
+                Intersect intersect(method, tolerance);
+                for (size_t i = begin; i < end; i++) {
+                    visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *entities[i / others.size()],
+                                                                  *others[i % others.size()]);
+                }
+                return intersect.result();
+            });
+        }
+
+        std::vector<lc::geo::Area> boxes;
+        boxes.reserve(entities.size() + others.size());
+        for (const auto& e : entities) {
+            boxes.push_back(e->boundingBox().increaseBy(tolerance));
+        }
+        for (const auto& e : others) {
+            boxes.push_back(e->boundingBox().increaseBy(tolerance));
+        }
+
+        const auto pairs = overlappingPairs(boxes, others.empty() ? boxes.size() : entities.size());
+
+        return intersectPairs(pairs.size(), [&](size_t begin, size_t end) {
+            Intersect intersect(method, tolerance);
+            for (size_t i = begin; i < end; i++) {
+                visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, entity(pairs[i].first), entity(pairs[i].second));
+            }
+            return intersect.result();
+        });
+    }
+}
 
 Intersect::Intersect(Method method, double tolerance) :
         _method(method),
@@ -60,20 +242,13 @@ bool Intersect::operator()(const lc::geo::Vector& v, const lc::entity::Spline& s
 }
 
 bool Intersect::operator()(const lc::geo::Vector& v, const lc::entity::LWPolyline& lwp) {
-    auto list1 = lwp.asEntities();
-
-    // Note: The dynamic_pointer_cast won't win a beauty contest, but the plan is to split
-    // the EntityVisitor into a GeoVisitor and EntityVisitor such that a application deciding
-    // to use double dispatch can decide to use a specific implementation.
-    // Once added, we can get rid of the dynamic_pointer_casts and simply
-    // call entity1.visit(entity2);
-    for (auto &entity1 : list1) {
-        if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity1)) {
-            geovisit(v, *arc.get());
+    visitSegments(lwp, lc::geo::Area(v.start(), v.end()), _method, _tolerance, [&](const lc::entity::LWSegment2D& segment) {
+        if (segment.isArc()) {
+            geovisit(v, segment.arc());
         } else {
-            geovisit(v, *std::dynamic_pointer_cast<const lc::geo::Vector>(entity1).get());
+            geovisit(v, segment.vector());
         }
-    }
+    });
     return false;
 }
 
@@ -121,19 +296,13 @@ bool Intersect::operator()(const lc::entity::Line& l, const lc::entity::Spline&
 }
 
 bool Intersect::operator()(const lc::entity::Line& l, const lc::entity::LWPolyline& lwp) {
-    auto &&list1 = lwp.asEntities();
-    // Note: The dynamic_pointer_cast won't win a beauty contest, but the plan is to split
-    // the EntityVisitor into a GeoVisitor and EntityVisitor such that a application deciding
-    // to use double dispatch can decide to use a specific implementation.
-    // Once added, we can get rid of the dynamic_pointer_casts and simply
-    // call entity1.visit(entity2);
-    for (auto &entity1 : list1) {
-        if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity1)) {
-            geovisit(l, *arc.get());
+    visitSegments(lwp, lc::geo::Area(l.start(), l.end()), _method, _tolerance, [&](const lc::entity::LWSegment2D& segment) {
+        if (segment.isArc()) {
+            geovisit(l, segment.arc());
         } else {
-            geovisit(l, *std::dynamic_pointer_cast<const lc::geo::Vector>(entity1).get());
+            geovisit(l, segment.vector());
         }
-    }
+    });
     return false;
 }
 
@@ -237,20 +406,15 @@ bool Intersect::operator()(const lc::geo::Circle& c, const lc::entity::Spline& s
 }
 
 bool Intersect::operator()(const lc::geo::Circle&c, const lc::entity::LWPolyline& lwp) {
-    auto &list1 = lwp.asEntities();
     auto a = lc::geo::Arc(c.center(), c.radius(), -M_PI, M_PI);
-    // Note: The dynamic_pointer_cast won't win a beauty contest, but the plan is to split
-    // the EntityVisitor into a GeoVisitor and EntityVisitor such that a application deciding
-    // to use double dispatch can decide to use a specific implementation.
-    // Once added, we can get rid of the dynamic_pointer_casts and simply
-    // call entity1.visit(entity2);
-    for (auto &entity1 : list1) {
-        if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity1)) {
-            geovisit(a, *arc.get());
+    auto area = lc::geo::Area(c.center() - c.radius(), c.center() + c.radius());
+    visitSegments(lwp, area, _method, _tolerance, [&](const lc::entity::LWSegment2D& segment) {
+        if (segment.isArc()) {
+            geovisit(a, segment.arc());
         } else {
-            geovisit(*std::dynamic_pointer_cast<const lc::geo::Vector>(entity1).get(), a);
+            geovisit(segment.vector(), a);
         }
-    }
+    });
     return false;
 }
 
@@ -340,20 +504,14 @@ bool Intersect::operator()(const lc::entity::Arc& a, const lc::entity::Spline& s
 }
 
 bool Intersect::operator()(const lc::entity::Arc& a, const lc::entity::LWPolyline& lwp) {
-    auto &list1 = lwp.asEntities();
-    // Note: The dynamic_pointer_cast won't win a beauty contest, but the plan is to split
-    // the EntityVisitor into a GeoVisitor and EntityVisitor such that a application deciding
-    // to use double dispatch can decide to use a specific implementation.
-    // Once added, we can get rid of the dynamic_pointer_casts and simply
-    // call entity1.visit(entity2);
-    for (auto &entity1 : list1) {
-        if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity1)) {
-            geovisit(a, *arc.get());
+    visitSegments(lwp, a.boundingBox(), _method, _tolerance, [&](const lc::entity::LWSegment2D& segment) {
+        if (segment.isArc()) {
+            geovisit(a, segment.arc());
         }
         else {
-            geovisit(*std::dynamic_pointer_cast<const lc::geo::Vector>(entity1).get(), a);
+            geovisit(segment.vector(), a);
         }
-    }
+    });
     return false; //visit(l1, a1);
 }
 
@@ -483,34 +641,30 @@ bool Intersect::operator()(const lc::entity::LWPolyline& lwp, const lc::entity::
 }
 
 bool Intersect::operator()(const lc::entity::LWPolyline& lwp1, const lc::entity::LWPolyline& lwp2) {
-    auto &list1 = lwp1.asEntities();
-    auto &list2 = lwp2.asEntities();
-
-    // Note: The dynamic_pointer_cast won't win a beauty contest, but the plan is to split
-    // the EntityVisitor into a GeoVisitor and EntityVisitor such that a application deciding
-    // to use double dispatch can decide to use a specific implementation.
-    // Once added, we can get rid of the dynamic_pointer_casts and simply
-    // call entity1.visit(entity2);
-    for (auto &entity1 : list1) {
-        for (auto &entity2 : list2) {
-            if (auto vector = std::dynamic_pointer_cast<const lc::geo::Vector>(entity1)) {
-                if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity2)) {
-                    geovisit(*vector.get(), *arc.get());
+    // The segments of the longest polyline are looked up with the segments of the other one
+    const bool swap = lwp1.segments().size() > lwp2.segments().size();
+    const auto& shortest = swap ? lwp2 : lwp1;
+    const auto& longest = swap ? lwp1 : lwp2;
+
+    for (const auto& segment1 : shortest.segments()) {
+        visitSegments(longest, segment1.boundingBox, _method, _tolerance, [&](const lc::entity::LWSegment2D& segment2) {
+            if (!segment1.isArc()) {
+                if (segment2.isArc()) {
+                    geovisit(segment1.vector(), segment2.arc());
                 }
                 else {
-                    geovisit(*vector.get(), *std::dynamic_pointer_cast<const lc::geo::Vector>(entity2).get());
+                    geovisit(segment1.vector(), segment2.vector());
                 }
             }
             else {
-                if (auto arc = std::dynamic_pointer_cast<const lc::geo::Arc>(entity2)) {
-                    geovisit(*std::dynamic_pointer_cast<const lc::geo::Arc>(entity1).get(), *arc.get());
+                if (segment2.isArc()) {
+                    geovisit(segment1.arc(), segment2.arc());
                 }
                 else {
-                    geovisit(*std::dynamic_pointer_cast<const lc::geo::Vector>(entity2).get(),
-                             *std::dynamic_pointer_cast<const lc::geo::Arc>(entity1).get());
+                    geovisit(segment2.vector(), segment1.arc());
                 }
             }
-        }
+        });
     }
     return false;
 }
@@ -605,15 +759,7 @@ IntersectMany::IntersectMany(std::vector<entity::CADEntity_CSPtr> entities, Inte
 }
 
 std::vector<lc::geo::Coordinate> IntersectMany::result() const {
-    Intersect intersect(_method, _tolerance);
-    if (_entities.size() > 1) {
-        for (size_t outer = 0; outer < (_entities.size() - 1); outer++) {
-            for (size_t inner = outer + 1; inner < _entities.size(); inner++) {
-                visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *_entities.at(outer).get(), *_entities.at(inner).get());
-            }
-        }
-    }
-    return intersect.result();
+    return intersectEntities(_entities, {}, _method, _tolerance);
 }
 
 /***
@@ -631,16 +777,240 @@ IntersectAgainstOthers::IntersectAgainstOthers(std::vector<entity::CADEntity_CSP
 }
 
 std::vector<lc::geo::Coordinate> IntersectAgainstOthers::result() const {
-    Intersect intersect(_method, _tolerance);
-    /*FIXME unused
-    for (auto &other : _others) {
-        for (auto &entity : _entities) {
-               visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *other.get(), *entity.get());
+    if (_others.empty()) {
+        return {};
+    }
+
+    return intersectEntities(_entities, _others, _method, _tolerance);
+}
+
+/***
+ *    |_| _  _  |~|~ _ _|_ _  _ _ _  __|_/\  _ _  _
+ *    | |(_|_\  _|_| | | (/_| _\(/_(_ |/~~\| (/_(_|
+ */
+HasIntersectArea::HasIntersectArea(const geo::Area& area, double tolerance) :
+        _minX(area.minP().x() - tolerance),
+        _minY(area.minP().y() - tolerance),
+        _maxX(area.maxP().x() + tolerance),
+        _maxY(area.maxP().y() + tolerance),
+        _result(false) {
+}
+
+bool HasIntersectArea::result() const {
+    return _result;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::Point& p) {
+    _result = inArea(p);
+    return true;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::Line& l) {
+    _result = crossesSegment(l.start(), l.end());
+    return true;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::Circle& c) {
+    _result = crossesArc(c.center(), c.radius(), nullptr);
+    return true;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::Arc& a) {
+    _result = crossesArc(a.center(), a.radius(), &a);
+    return true;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::Ellipse& e) {
+    _result = false;
+
+    // A point of the ellipse within the area
+    if (inArea(e.isArc() ? e.startPoint() : e.getPoint(0.))) {
+        _result = true;
+        return true;
+    }
+
+    // Transform the corners of the area to the coordinate system where the ellipse is a unit circle
+    const double a = e.majorRadius();
+    const double b = e.minorRadius();
+    const double angle = e.majorP().angle();
+    const double cos = std::cos(-angle);
+    const double sin = std::sin(-angle);
+
+    double u[4];
+    double v[4];
+    const double x[4] = {_minX, _maxX, _maxX, _minX};
+    const double y[4] = {_minY, _minY, _maxY, _maxY};
+
+    for (int i = 0; i < 4; i++) {
+        const double dx = x[i] - e.center().x();
+        const double dy = y[i] - e.center().y();
+        u[i] = (dx * cos - dy * sin) / a;
+        v[i] = (dx * sin + dy * cos) / b;
+    }
+
+    // Intersect each edge with the unit circle
+    for (int i = 0; i < 4; i++) {
+        const int j = (i + 1) % 4;
+        const double du = u[j] - u[i];
+        const double dv = v[j] - v[i];
+
+        const double qa = du * du + dv * dv;
+        const double qb = 2. * (u[i] * du + v[i] * dv);
+        const double qc = u[i] * u[i] + v[i] * v[i] - 1.;
+        const double discriminant = qb * qb - 4. * qa * qc;
+
+        if (discriminant < 0.) {
+            continue;
+        }
+
+        const double root = std::sqrt(discriminant);
+        for (double t : {(-qb - root) / (2. * qa), (-qb + root) / (2. * qa)}) {
+            if (t < 0. || t > 1.) {
+                continue;
+            }
+
+            const double ellipseAngle = std::atan2(v[i] + t * dv, u[i] + t * du);
+            if (!e.isArc() || isAngleBetween(ellipseAngle, e.startAngle(), e.endAngle(), !e.isReversed())) {
+                _result = true;
+                return true;
+            }
         }
     }
-    */
-    std::cerr << __PRETTY_FUNCTION__ << " requires implementation" << std::endl;
 
-    return intersect.result();
+    return true;
+}
+
+bool HasIntersectArea::operator()(const lc::entity::LWPolyline& lwp) {
+    _result = false;
+
+    const geo::Area area(geo::Coordinate(_minX, _minY), geo::Coordinate(_maxX, _maxY));
+    lwp.visitSegments(area, [this](const lc::entity::LWSegment2D& segment) {
+        const auto& box = segment.boundingBox;
+        if (_result || box.maxP().x() < _minX || box.minP().x() > _maxX || box.maxP().y() < _minY || box.minP().y() > _maxY) {
+            return;
+        }
+
+        if (segment.isArc()) {
+            const auto arc = segment.arc();
+            _result = crossesArc(segment.center, segment.radius, &arc);
+        }
+        else {
+            _result = crossesSegment(segment.start, segment.end);
+        }
+    });
+
+    return true;
+}
+
+/**
+ * Math::isAngleBetween expects all angles between -PI and PI, stored angles can be outside this range
+ */
+bool HasIntersectArea::isAngleBetween(double angle, double start, double end, bool CCW) {
+    return Math::isAngleBetween(angle, Math::correctAngle(start), Math::correctAngle(end), CCW);
+}
+
+bool HasIntersectArea::inArea(const geo::Coordinate& coordinate) const {
+    return coordinate.x() >= _minX && coordinate.x() <= _maxX && coordinate.y() >= _minY && coordinate.y() <= _maxY;
+}
+
+/**
+ * Liang-Barsky, clip the segment against each side of the area and test if something is left
+ */
+bool HasIntersectArea::crossesSegment(const geo::Coordinate& start, const geo::Coordinate& end) const {
+    const double dx = end.x() - start.x();
+    const double dy = end.y() - start.y();
+
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {start.x() - _minX, _maxX - start.x(), start.y() - _minY, _maxY - start.y()};
+
+    double t0 = 0.;
+    double t1 = 1.;
+
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.) {
+            // Parallel to this side, and outside of it
+            if (q[i] < 0.) {
+                return false;
+            }
+            continue;
+        }
+
+        const double t = q[i] / p[i];
+
+        if (p[i] < 0.) {
+            if (t > t1) {
+                return false;
+            }
+            t0 = std::max(t0, t);
+        }
+        else {
+            if (t < t0) {
+                return false;
+            }
+            t1 = std::min(t1, t);
+        }
+    }
+
+    return true;
 }
 
+/**
+ * Test a circle, or a arc of it when arc isn't nullptr.
+ * The curve is connected, so it's within the area when one of it's points is within the area or it crosses an edge
+ */
+bool HasIntersectArea::crossesArc(const geo::Coordinate& center, double radius, const geo::Arc* arc) const {
+    const double cx = center.x();
+    const double cy = center.y();
+
+    // Area further away than the radius
+    const double nearX = std::max(std::max(_minX - cx, cx - _maxX), 0.);
+    const double nearY = std::max(std::max(_minY - cy, cy - _maxY), 0.);
+    if (nearX * nearX + nearY * nearY > radius * radius) {
+        return false;
+    }
+
+    // Area completely inside the circle
+    const double farX = std::max(std::abs(_minX - cx), std::abs(_maxX - cx));
+    const double farY = std::max(std::abs(_minY - cy), std::abs(_maxY - cy));
+    if (farX * farX + farY * farY < radius * radius) {
+        return false;
+    }
+
+    if (inArea(arc != nullptr ? arc->startP() : geo::Coordinate(cx + radius, cy))) {
+        return true;
+    }
+
+    auto onCurve = [arc](double dx, double dy) {
+        return arc == nullptr || isAngleBetween(std::atan2(dy, dx), arc->startAngle(), arc->endAngle(), arc->CCW());
+    };
+
+    for (double x : {_minX, _maxX}) {
+        const double dx = x - cx;
+
+        if (std::abs(dx) <= radius) {
+            const double h = std::sqrt(radius * radius - dx * dx);
+
+            for (double dy : {-h, h}) {
+                if (cy + dy >= _minY && cy + dy <= _maxY && onCurve(dx, dy)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    for (double y : {_minY, _maxY}) {
+        const double dy = y - cy;
+
+        if (std::abs(dy) <= radius) {
+            const double w = std::sqrt(radius * radius - dy * dy);
+
+            for (double dx : {-w, w}) {
+                if (cx + dx >= _minX && cx + dx <= _maxX && onCurve(dx, dy)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
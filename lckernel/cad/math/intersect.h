@@ -44,12 +44,7 @@ namespace lc {
                     // When method == Any is selected, the system will return that coordinate, otherwise
                     // the point must be on both
 
-                    // Test = 2 // I am considering to add a 'Test' option, this would allow to set a boolean if
-                    // a intersection would have happened. This would potentially speed up line/line intersections
-                    // during area selection where usually CAD drawings do contain a lot of lines.
-                    // THis would also help during selection of LWPolylines where we can stop testing if
-                    // any point would have been found.
-
+                    // To only test if an entity crosses an area, for example during area selection, use HasIntersectArea
                 };
                 Intersect(Method method, double tolerance);
 
@@ -212,6 +207,49 @@ namespace lc {
                 const double _tolerance;
         };
 
+        /**
+          * @brief test if the path of a entity is located within or crosses a area, without calculating intersection points
+          * Lines and the segments of LWPolylines are clipped against the area (Liang-Barsky),
+          * circles, arcs and ellipses are tested analytically against the edges of the area.
+          * Nothing gets allocated, so this can be used for each entity during a crossing selection.
+          * operator() returns false when there is no dedicated test for the type of entity,
+          * use Intersect with the edges of the area for those.
+          * @sa Intersect
+          */
+        class HasIntersectArea {
+            public:
+                HasIntersectArea(const geo::Area& area, double tolerance);
+
+                bool operator()(const lc::entity::Point& p);
+                bool operator()(const lc::entity::Line& l);
+                bool operator()(const lc::entity::Circle& c);
+                bool operator()(const lc::entity::Arc& a);
+                bool operator()(const lc::entity::Ellipse& e);
+                bool operator()(const lc::entity::LWPolyline& lwp);
+
+                template<typename S>
+                bool operator()(const S& s) {
+                    return false;
+                }
+
+                bool result() const;
+
+            private:
+                bool inArea(const geo::Coordinate& coordinate) const;
+
+                bool crossesSegment(const geo::Coordinate& start, const geo::Coordinate& end) const;
+
+                bool crossesArc(const geo::Coordinate& center, double radius, const geo::Arc* arc) const;
+
+                static bool isAngleBetween(double angle, double start, double end, bool CCW);
+
+                const double _minX;
+                const double _minY;
+                const double _maxX;
+                const double _maxY;
+                bool _result;
+        };
+
         /**
           * @brief calculate intersection points of many entities but beal out asap when a intersection point was found
           * @note Can we make this into a general template ???
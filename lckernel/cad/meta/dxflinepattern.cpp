@@ -92,14 +92,16 @@ std::vector<double> DxfLinePatternByValue::generatePattern(const std::vector<dou
 }
 
 const std::vector<double> DxfLinePatternByValue::lcPattern(double lineWidth) const {
-    try {
-        return _lcPatterns.at(lineWidth);
-    }
-    catch (std::out_of_range &e) {
-        auto pattern = generatePattern(_path, _length, lineWidth);
-        _lcPatterns[lineWidth] = pattern;
-        return pattern;
+    std::lock_guard<std::mutex> lock(_lcPatternsMutex);
+
+    auto it = _lcPatterns.find(lineWidth);
+    if (it != _lcPatterns.end()) {
+        return it->second;
     }
+
+    auto pattern = generatePattern(_path, _length, lineWidth);
+    _lcPatterns[lineWidth] = pattern;
+    return pattern;
 }
 
 const std::string DxfLinePatternByValue::name() const {
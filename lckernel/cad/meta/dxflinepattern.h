@@ -9,6 +9,7 @@
 #include <cassert>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <cad/builders/linepattern.h>
 
 namespace lc {
@@ -86,6 +87,8 @@ namespace lc {
                 //Might grow out of proportions if too much line sizes are rendered
                 //We should find a way to remove widths unrendered for x drawing cycles
                 mutable std::map<double, std::vector<double>> _lcPatterns;
+                // Viewers resolve line patterns from multiple threads
+                mutable std::mutex _lcPatternsMutex;
 
                 double _length;
         };
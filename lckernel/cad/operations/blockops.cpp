@@ -61,15 +61,19 @@ void ReplaceBlock::redo() const {
 void ReplaceBlock::processInternal() {
     auto entities = document()->entitiesByBlock(_oldBlock).asVector();
 
+    std::vector<entity::CADEntity_CSPtr> modified;
+    modified.reserve(entities.size());
     for(const auto& entity : entities) {
-        document()->removeEntity(entity);
-        document()->insertEntity(entity->modify(
+        modified.push_back(entity->modify(
                 entity->layer(),
                 entity->metaInfo(),
                 _newBlock
         ));
     }
 
+    document()->removeEntities(entities);
+    document()->insertEntities(modified);
+
     document()->removeDocumentMetaType(_oldBlock);
     document()->addDocumentMetaType(_newBlock);
 
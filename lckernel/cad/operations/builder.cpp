@@ -28,6 +28,16 @@ void Builder::redo() const {
     }
 }
 
+size_t Builder::memorySize() const {
+    size_t size = DocumentOperation::memorySize() + _operations.capacity() * sizeof(DocumentOperation_SPtr);
+
+    for(const auto& operation : _operations) {
+        size += operation->memorySize();
+    }
+
+    return size;
+}
+
 void Builder::processInternal() {
     for(const auto& operation : _operations) {
         operation->processInternal();
@@ -24,6 +24,8 @@ namespace lc {
                 void undo() const override;
                 void redo() const override;
 
+                size_t memorySize() const override;
+
             protected:
                 virtual void processInternal() override;
 
@@ -4,6 +4,9 @@
 using namespace lc;
 using namespace operation;
 
+// Object, shared_ptr control block and allocation overhead of a line, most entities are about this size
+const size_t EntityBuilder::ENTITY_MEMORY_SIZE = 256;
+
 EntityBuilder::EntityBuilder(const std::shared_ptr<storage::Document>& document) :
         DocumentOperation(document, "EntityBuilder") {
 }
@@ -21,7 +24,7 @@ EntityBuilder* EntityBuilder::appendOperation(Base_SPtr operation) {
 void EntityBuilder::processInternal() {
     processStack();
 
-    auto ec = document()->entityContainer();
+    const auto& ec = document()->entityContainer();
 
     // Build a buffer with all entities we need to remove during a undo cycle
     for (const auto& entity : _workingBuffer) {
@@ -33,38 +36,41 @@ void EntityBuilder::processInternal() {
     }
 
     // Remove entities
-    for (const auto& entity : _entitiesThatNeedsRemoval) {
-        document()->removeEntity(entity);
-    }
+    document()->removeEntities(_entitiesThatNeedsRemoval);
 
     // Add/Update all entities in the document
-    for (const auto& entity : _workingBuffer) {
-        document()->insertEntity(entity);
-    }
+    document()->insertEntities(_workingBuffer);
+
+    // The buffers are kept in the undo history
+    _workingBuffer.shrink_to_fit();
+    _entitiesThatWhereUpdated.shrink_to_fit();
+    _entitiesThatNeedsRemoval.shrink_to_fit();
+    _stack.shrink_to_fit();
 }
 
-void EntityBuilder::undo() const {
-    for (const auto& entity : _workingBuffer) {
-        document()->removeEntity(entity);
-    }
+size_t EntityBuilder::memorySize() const {
+    const size_t buffers = _stack.capacity() * sizeof(Base_SPtr) +
+                           (_workingBuffer.capacity() +
+                            _entitiesThatWhereUpdated.capacity() +
+                            _entitiesThatNeedsRemoval.capacity()) * sizeof(entity::CADEntity_CSPtr);
 
-    for (const auto& entity : _entitiesThatWhereUpdated) {
-        document()->insertEntity(entity);
-    }
+    return DocumentOperation::memorySize() + buffers +
+           (_entitiesThatWhereUpdated.size() + _entitiesThatNeedsRemoval.size()) * ENTITY_MEMORY_SIZE;
+}
 
-    for (const auto& entity : _entitiesThatNeedsRemoval) {
-        document()->insertEntity(entity);
-    }
+void EntityBuilder::undo() const {
+    document()->removeEntities(_workingBuffer);
+
+    std::vector<entity::CADEntity_CSPtr> restored;
+    restored.reserve(_entitiesThatWhereUpdated.size() + _entitiesThatNeedsRemoval.size());
+    restored.insert(restored.end(), _entitiesThatWhereUpdated.begin(), _entitiesThatWhereUpdated.end());
+    restored.insert(restored.end(), _entitiesThatNeedsRemoval.begin(), _entitiesThatNeedsRemoval.end());
+    document()->insertEntities(restored);
 }
 
 void EntityBuilder::redo() const {
-    for (const auto& entity : _entitiesThatNeedsRemoval) {
-        document()->removeEntity(entity);
-    }
-
-    for (const auto& entity : _workingBuffer) {
-        document()->insertEntity(entity);
-    }
+    document()->removeEntities(_entitiesThatNeedsRemoval);
+    document()->insertEntities(_workingBuffer);
 }
 
 void EntityBuilder::processStack() {
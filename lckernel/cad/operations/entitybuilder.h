@@ -40,6 +40,18 @@ namespace lc {
                 virtual void undo() const;
                 virtual void redo() const;
 
+                /**
+                 * @brief Estimated memory used by the operation
+                 * The entities added by the operation are in the document, only the entities which were removed or
+                 * replaced are counted.
+                 */
+                size_t memorySize() const override;
+
+                /**
+                 * @brief Estimated size of a entity
+                 */
+                static const size_t ENTITY_MEMORY_SIZE;
+
                 /**
                  * @brief Apply the operations
                  * Apply operations on the entities without updating the document, and clear the stack.
@@ -2,9 +2,113 @@
 #include "cad/storage/document.h"
 
 #include "cad/storage/storagemanager.h"
+#include "cad/primitive/line.h"
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
 using namespace lc;
 using namespace lc::operation;
 
+namespace {
+    /**
+     * @brief Number of entities transformed together, small enough for the entities to stay in the cache
+     */
+    const size_t TRANSFORM_BATCH_SIZE = 256;
+
+    /**
+     * @brief Transform a set of entities, keeping their order
+     * The points of the lines are copied into arrays and transformed in a single loop the compiler can vectorise,
+     * the lines are then created like Line::move(), Line::rotate(), Line::scale() and Line::copy() would.
+     * Other entities are transformed by transformEntity.
+     * @param transformPoints function transforming n points given as arrays of x, y and z
+     * @param transformEntity function transforming a single entity
+     * @param sameID true if the lines keep their ID
+     */
+    template<typename PointTransform, typename EntityTransform>
+    std::vector<entity::CADEntity_CSPtr> transformEntities(const std::vector<entity::CADEntity_CSPtr>& entities,
+                                                           PointTransform transformPoints,
+                                                           EntityTransform transformEntity,
+                                                           bool sameID) {
+        std::vector<entity::CADEntity_CSPtr> newQueue;
+        newQueue.reserve(entities.size());
+
+        const entity::Line* lines[TRANSFORM_BATCH_SIZE];
+        double x[2 * TRANSFORM_BATCH_SIZE];
+        double y[2 * TRANSFORM_BATCH_SIZE];
+        double z[2 * TRANSFORM_BATCH_SIZE];
+
+        for (size_t first = 0; first < entities.size(); first += TRANSFORM_BATCH_SIZE) {
+            const size_t count = std::min(TRANSFORM_BATCH_SIZE, entities.size() - first);
+            size_t points = 0;
+
+            for (size_t i = 0; i < count; i++) {
+                const auto& entity = *entities[first + i];
+
+                // Only lines, derived classes need their own transformation
+                if (typeid(entity) != typeid(entity::Line)) {
+                    lines[i] = nullptr;
+                    continue;
+                }
+
+                auto line = static_cast<const entity::Line*>(&entity);
+                lines[i] = line;
+
+                x[points] = line->start().x();
+                y[points] = line->start().y();
+                z[points] = line->start().z();
+                x[points + 1] = line->end().x();
+                y[points + 1] = line->end().y();
+                z[points + 1] = line->end().z();
+                points += 2;
+            }
+
+            transformPoints(x, y, z, points);
+
+            size_t point = 0;
+            for (size_t i = 0; i < count; i++) {
+                auto line = lines[i];
+                if (line == nullptr) {
+                    newQueue.push_back(transformEntity(entities[first + i]));
+                    continue;
+                }
+
+                auto newLine = std::make_shared<entity::Line>(geo::Coordinate(x[point], y[point], z[point]),
+                                                              geo::Coordinate(x[point + 1], y[point + 1], z[point + 1]),
+                                                              line->layer(),
+                                                              line->metaInfo(),
+                                                              line->block());
+                if (sameID) {
+                    newLine->setID(line->id());
+                }
+
+                newQueue.push_back(std::move(newLine));
+                point += 2;
+            }
+        }
+
+        return newQueue;
+    }
+
+    /**
+     * @brief Translate points, same as geo::Coordinate::operator+
+     */
+    struct Translation {
+        geo::Coordinate offset;
+
+        void operator()(double* x, double* y, double* z, size_t n) const {
+            const double ox = offset.x();
+            const double oy = offset.y();
+            const double oz = offset.z();
+
+            for (size_t i = 0; i < n; i++) {
+                x[i] += ox;
+                y[i] += oy;
+                z[i] += oz;
+            }
+        }
+    };
+}
+
 /********************************************************************************************************/
 /** Base                                                                                              ***/
 /********************************************************************************************************/
@@ -13,10 +117,10 @@ Begin::Begin() :  Base() {
 
 std::vector<entity::CADEntity_CSPtr> Begin::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     _entities.insert(_entities.end(), entities.begin(), entities.end());
     return entities;
 }
@@ -34,10 +138,10 @@ Loop::Loop(const int numTimes) :  Base(), _numTimes(numTimes) {
 
 std::vector<entity::CADEntity_CSPtr> Loop::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     std::vector<entity::CADEntity_CSPtr> final;
 
     // Find the start
@@ -76,18 +180,13 @@ Move::Move(geo::Coordinate offset) :
 
 std::vector<entity::CADEntity_CSPtr>  Move::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->move(_offset);
-        newQueue.push_back(e);
-    }
-
-    return newQueue;
+    const std::vector<Base_SPtr>& operationStack) {
+    return transformEntities(entities, Translation{_offset}, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->move(_offset);
+    }, true);
 }
 
 /********************************************************************************************************/
@@ -100,19 +199,15 @@ Copy::Copy(geo::Coordinate offset) :
 
 std::vector<entity::CADEntity_CSPtr> Copy::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
+    const std::vector<Base_SPtr>& operationStack) {
+    workingBuffer.insert(workingBuffer.end(), entities.begin(), entities.end());
 
-    for (const auto& entity : entities) {
-        auto e = entity->copy(_offset);
-        workingBuffer.push_back(entity);
-        newQueue.push_back(e);
-    }
-
-    return newQueue;
+    return transformEntities(entities, Translation{_offset}, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->copy(_offset);
+    }, false);
 }
 
 /********************************************************************************************************/
@@ -126,18 +221,29 @@ Scale::Scale(geo::Coordinate scale_center, geo::Coordinate scale_factor) :
 
 std::vector<entity::CADEntity_CSPtr> Scale::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->scale(_scale_center, _scale_factor);
-        newQueue.push_back(e);
-    }
+    const std::vector<Base_SPtr>& operationStack) {
+    // Same as geo::Coordinate::scale()
+    auto scalePoints = [this](double* x, double* y, double* z, size_t n) {
+        const double cx = _scale_center.x();
+        const double cy = _scale_center.y();
+        const double cz = _scale_center.z();
+        const double fx = _scale_factor.x();
+        const double fy = _scale_factor.y();
+        const double fz = _scale_factor.z();
+
+        for (size_t i = 0; i < n; i++) {
+            x[i] = cx + (x[i] - cx) * fx;
+            y[i] = cy + (y[i] - cy) * fy;
+            z[i] = cz + (z[i] - cz) * fz;
+        }
+    };
 
-    return newQueue;
+    return transformEntities(entities, scalePoints, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->scale(_scale_center, _scale_factor);
+    }, true);
 }
 
 /********************************************************************************************************/
@@ -151,18 +257,30 @@ Rotate::Rotate(geo::Coordinate rotation_center, const double rotation_angle) :
 
 std::vector<entity::CADEntity_CSPtr> Rotate::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
-    std::vector<entity::CADEntity_CSPtr> newQueue;
-
-    for (const auto& entity : entities) {
-        auto e = entity->rotate(_rotation_center, _rotation_angle);
-        newQueue.push_back(e);
-    }
+    const std::vector<Base_SPtr>& operationStack) {
+    // Same as geo::Coordinate::rotate(), the sine and cosine are computed once for all points
+    auto rotatePoints = [this](double* x, double* y, double* z, size_t n) {
+        const double cx = _rotation_center.x();
+        const double cy = _rotation_center.y();
+        const double cz = _rotation_center.z();
+        const double cosA = std::cos(_rotation_angle);
+        const double sinA = std::sin(_rotation_angle);
+
+        for (size_t i = 0; i < n; i++) {
+            const double dx = x[i] - cx;
+            const double dy = y[i] - cy;
+            x[i] = cx + (dx * cosA - dy * sinA);
+            y[i] = cy + (dx * sinA + dy * cosA);
+            z[i] = cz;
+        }
+    };
 
-    return newQueue;
+    return transformEntities(entities, rotatePoints, [this](const entity::CADEntity_CSPtr& entity) {
+        return entity->rotate(_rotation_center, _rotation_angle);
+    }, true);
 }
 
 /********************************************************************************************************/
@@ -173,10 +291,10 @@ Push::Push() : Base() {
 
 std::vector<entity::CADEntity_CSPtr> Push::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     std::vector<entity::CADEntity_CSPtr> newQueue(workingBuffer);
     newQueue.insert(newQueue.end(), entities.begin(), entities.end());
     workingBuffer.clear();
@@ -193,10 +311,10 @@ SelectByLayer::SelectByLayer(meta::Layer_CSPtr layer) :
 
 std::vector<entity::CADEntity_CSPtr> SelectByLayer::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
 
     std::vector<entity::CADEntity_CSPtr> e;
 
@@ -222,10 +340,10 @@ Remove::Remove() : Base() {
 
 std::vector<entity::CADEntity_CSPtr> Remove::process(
     const std::shared_ptr<storage::Document> document,
-    const std::vector<entity::CADEntity_CSPtr> entities,
+    const std::vector<entity::CADEntity_CSPtr>& entities,
     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
     std::vector<entity::CADEntity_CSPtr>& removals,
-    const std::vector<Base_SPtr> operationStack) {
+    const std::vector<Base_SPtr>& operationStack) {
     removals.insert(removals.end(), entities.begin(), entities.end());
     std::vector<entity::CADEntity_CSPtr> e;
     return e;
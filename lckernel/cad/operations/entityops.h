@@ -25,10 +25,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    const std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack
+                    const std::vector<Base_SPtr>& operationStack
                 ) = 0;
         };
 
@@ -57,10 +57,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const storage::Document_SPtr document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
             private:
                 int _numTimes;
@@ -93,10 +93,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
                 std::vector<entity::CADEntity_CSPtr> getEntities() const;
 
@@ -131,10 +131,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
             private:
                 geo::Coordinate _offset;
@@ -167,10 +167,10 @@ namespace lc {
 
                 std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack) override;
+                    const std::vector<Base_SPtr>& operationStack) override;
 
             private:
                 geo::Coordinate _offset;
@@ -203,10 +203,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
             private:
                 geo::Coordinate _rotation_center;
@@ -222,10 +222,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
             private:
                 geo::Coordinate _scale_center;
@@ -261,10 +261,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector<entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
         };
         DECLARE_SHORT_SHARED_PTR(Push)
 
@@ -293,10 +293,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector <entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
 
             private:
                 meta::Layer_CSPtr _layer;
@@ -328,10 +328,10 @@ namespace lc {
 
                 virtual std::vector<entity::CADEntity_CSPtr> process(
                     const std::shared_ptr<storage::Document> document,
-                    std::vector<entity::CADEntity_CSPtr> entities,
+                    const std::vector<entity::CADEntity_CSPtr>& entities,
                     std::vector <entity::CADEntity_CSPtr>& workingBuffer,
                     std::vector<entity::CADEntity_CSPtr>& removals,
-                    const std::vector<Base_SPtr> operationStack);
+                    const std::vector<Base_SPtr>& operationStack);
         };
         DECLARE_SHORT_SHARED_PTR(Remove)
     }
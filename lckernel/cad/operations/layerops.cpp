@@ -41,25 +41,18 @@ void RemoveLayer::processInternal() {
     auto le = document()->entityContainer().entitiesByLayer(_layer).asVector();
     _entities.insert(_entities.end(), le.begin(), le.end());
 
-    for (const auto& i : _entities) {
-        document()->removeEntity(i);
-    }
+    document()->removeEntities(_entities);
 
     document()->removeDocumentMetaType(_layer);
 }
 
 void RemoveLayer::undo() const {
     document()->addDocumentMetaType(_layer);
-
-    for (const auto& i : _entities) {
-        document()->insertEntity(i);
-    }
+    document()->insertEntities(_entities);
 }
 
 void RemoveLayer::redo() const {
-    for (const auto& i : _entities) {
-        document()->removeEntity(i);
-    }
+    document()->removeEntities(_entities);
 
     document()->removeDocumentMetaType(_layer);
 }
@@ -81,11 +74,15 @@ void ReplaceLayer::processInternal() {
 void ReplaceLayer::undo() const {
     auto le = document()->entityContainer().entitiesByLayer(_newLayer).asVector();
 
+    std::vector<entity::CADEntity_CSPtr> modified;
+    modified.reserve(le.size());
     for (const auto& i : le) {
-        document()->removeEntity(i);
-        document()->insertEntity(i->modify(_oldLayer, i->metaInfo(), i->block()));
+        modified.push_back(i->modify(_oldLayer, i->metaInfo(), i->block()));
     }
 
+    document()->removeEntities(le);
+    document()->insertEntities(modified);
+
     document()->removeDocumentMetaType(_newLayer);
     document()->addDocumentMetaType(_oldLayer);
 }
@@ -93,11 +90,15 @@ void ReplaceLayer::undo() const {
 void ReplaceLayer::redo() const {
     auto le = document()->entityContainer().entitiesByLayer(_oldLayer).asVector();
 
+    std::vector<entity::CADEntity_CSPtr> modified;
+    modified.reserve(le.size());
     for (const auto& i : le) {
-        document()->removeEntity(i);
-        document()->insertEntity(i->modify(_newLayer, i->metaInfo(), i->block()));
+        modified.push_back(i->modify(_newLayer, i->metaInfo(), i->block()));
     }
 
+    document()->removeEntities(le);
+    document()->insertEntities(modified);
+
     document()->removeDocumentMetaType(_oldLayer);
     document()->addDocumentMetaType(_newLayer);
 }
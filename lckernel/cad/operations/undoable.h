@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "cad/const.h"
 #include <memory>
@@ -61,6 +62,19 @@ namespace lc {
                     return _text;
                 }
 
+                /*!
+                 * \brief Estimated memory used by the operation
+                 *
+                 * Number of bytes the operation keeps alive to be able to undo or redo it,
+                 * used by the undo manager to limit the size of the history.
+                 * Operations keeping entities should include the entities only they hold.
+                 *
+                 * @return
+                 */
+                virtual size_t memorySize() const {
+                    return sizeof(Undoable) + _text.capacity();
+                }
+
             private:
                 std::string _text;
         };
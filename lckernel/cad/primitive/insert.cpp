@@ -1,4 +1,6 @@
 #include "insert.h"
+#include "cad/interface/entitydispatch.h"
+#include <algorithm>
 
 using namespace lc;
 using namespace entity;
@@ -10,9 +12,7 @@ Insert::Insert(const Insert_CSPtr& other, bool sameID) :
     _displayBlock(other->_displayBlock) {
 
     calculateBoundingBox();
-
-    _document->addEntityEvent().connect<Insert, &Insert::on_addEntityEvent>(this);
-    _document->removeEntityEvent().connect<Insert, &Insert::on_removeEntityEvent>(this);
+    connectDocument();
 }
 
 Insert::Insert(const builder::InsertBuilder& builder) :
@@ -22,14 +22,25 @@ Insert::Insert(const builder::InsertBuilder& builder) :
     _displayBlock(builder.displayBlock()) {
 
     calculateBoundingBox();
+    connectDocument();
+}
 
+Insert::~Insert() {
+    disconnectDocument();
+}
+
+void Insert::connectDocument() {
     _document->addEntityEvent().connect<Insert, &Insert::on_addEntityEvent>(this);
     _document->removeEntityEvent().connect<Insert, &Insert::on_removeEntityEvent>(this);
+    _document->addEntitiesEvent().connect<Insert, &Insert::on_addEntitiesEvent>(this);
+    _document->removeEntitiesEvent().connect<Insert, &Insert::on_removeEntitiesEvent>(this);
 }
 
-Insert::~Insert() {
-    document()->addEntityEvent().disconnect<Insert, &Insert::on_addEntityEvent>(this);
-    document()->removeEntityEvent().disconnect<Insert, &Insert::on_removeEntityEvent>(this);
+void Insert::disconnectDocument() {
+    _document->addEntityEvent().disconnect<Insert, &Insert::on_addEntityEvent>(this);
+    _document->removeEntityEvent().disconnect<Insert, &Insert::on_removeEntityEvent>(this);
+    _document->addEntitiesEvent().disconnect<Insert, &Insert::on_addEntitiesEvent>(this);
+    _document->removeEntitiesEvent().disconnect<Insert, &Insert::on_removeEntitiesEvent>(this);
 }
 
 const meta::Block_CSPtr& Insert::displayBlock() const {
@@ -85,7 +96,7 @@ CADEntity_CSPtr Insert::modify(meta::Layer_CSPtr layer, meta::MetaInfo_CSPtr met
 }
 
 void Insert::dispatch(EntityDispatch& dispatch) const {
-    //TODO
+    dispatch.visit(shared_from_this());
 }
 
 std::map<unsigned int, geo::Coordinate> entity::Insert::dragPoints() const {
@@ -160,4 +171,18 @@ void Insert::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
     if(event.entity()->block() == _displayBlock) {
         calculateBoundingBox();
     }
+}
+
+void Insert::on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+    const auto& blocks = event.blocks();
+    if(std::find(blocks.begin(), blocks.end(), _displayBlock) != blocks.end()) {
+        calculateBoundingBox();
+    }
+}
+
+void Insert::on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent& event) {
+    const auto& blocks = event.blocks();
+    if(std::find(blocks.begin(), blocks.end(), _displayBlock) != blocks.end()) {
+        calculateBoundingBox();
+    }
 }
\ No newline at end of file
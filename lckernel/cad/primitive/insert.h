@@ -54,6 +54,14 @@ namespace lc {
 
                 void on_addEntityEvent(const lc::event::AddEntityEvent&);
                 void on_removeEntityEvent(const lc::event::RemoveEntityEvent&);
+                void on_addEntitiesEvent(const lc::event::AddEntitiesEvent&);
+                void on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent&);
+
+                /**
+                 * Connect or disconnect the events of the document changing the display block
+                 */
+                void connectDocument();
+                void disconnectDocument();
 
                 storage::Document_SPtr _document;
                 geo::Coordinate _position;
@@ -1,5 +1,6 @@
 #include <memory>
 #include <cmath>
+#include <limits>
 #include "cad/primitive/lwpolyline.h"
 #include "cad/geometry/geoarc.h"
 #include <cad/vo/entitycoordinate.h>
@@ -11,6 +12,36 @@
 using namespace lc;
 using namespace entity;
 
+const size_t LWPolyline::SEGMENT_TREE_MINIMUM_SIZE;
+
+LWSegment2D::LWSegment2D(const geo::Coordinate& start, const geo::Coordinate& end, double bulge) :
+        start(start),
+        end(end),
+        bulge(bulge),
+        radius(0.),
+        startAngle(0.),
+        endAngle(0.),
+        CCW(true),
+        boundingBox(start, end) {
+
+    if (isArc()) {
+        const auto arc = geo::Arc::createArcBulge(start, end, bulge);
+        center = arc.center();
+        radius = arc.radius();
+        startAngle = arc.startAngle();
+        endAngle = arc.endAngle();
+        CCW = arc.CCW();
+        boundingBox = arc.boundingBox();
+    }
+}
+
+geo::Coordinate LWSegment2D::nearestPointOnEntity(const geo::Coordinate& coord) const {
+    if (isArc()) {
+        return arc().nearestPointOnEntity(coord);
+    }
+
+    return vector().nearestPointOnEntity(coord);
+}
 
 LWPolyline::LWPolyline(std::vector<LWVertex2D> vertex,
                        double width,
@@ -29,7 +60,7 @@ LWPolyline::LWPolyline(std::vector<LWVertex2D> vertex,
         _closed(closed),
         _extrusionDirection(std::move(extrusionDirection)) {
 
-    generateEntities();
+    generateSegments();
 
 }
 
@@ -40,8 +71,26 @@ LWPolyline::LWPolyline(const LWPolyline_CSPtr& other, bool sameID) :
         _elevation(other->_elevation),
         _tickness(other->_tickness),
         _closed(other->_closed),
-        _extrusionDirection(other->_extrusionDirection) {
-    generateEntities();
+        _extrusionDirection(other->_extrusionDirection),
+        _segments(other->_segments),
+        _boundingBox(other->_boundingBox),
+        _segmentTree(other->_segmentTree) {
+}
+
+LWPolyline::LWPolyline(const LWPolyline_CSPtr& other,
+                       meta::Layer_CSPtr layer,
+                       meta::MetaInfo_CSPtr metaInfo,
+                       meta::Block_CSPtr block) :
+        CADEntity(std::move(layer), std::move(metaInfo), std::move(block)),
+        _vertex(other->_vertex),
+        _width(other->_width),
+        _elevation(other->_elevation),
+        _tickness(other->_tickness),
+        _closed(other->_closed),
+        _extrusionDirection(other->_extrusionDirection),
+        _segments(other->_segments),
+        _boundingBox(other->_boundingBox),
+        _segmentTree(other->_segmentTree) {
 }
 
 CADEntity_CSPtr LWPolyline::move(const geo::Coordinate& offset) const {
@@ -122,73 +171,53 @@ CADEntity_CSPtr LWPolyline::scale(const geo::Coordinate& scale_center, const geo
 }
 
 const geo::Area LWPolyline::boundingBox() const {
-    if(_entities.empty()) {
-        return geo::Area();
-    }
-
-    auto it = _entities.begin();
-    geo::Area area = (*it)->boundingBox();
-    it++;
-
-    while(it != _entities.end()) {
-        area = area.merge((*it)->boundingBox());
-        it++;
-    }
-
-    return area;
+    return _boundingBox;
 }
 
 CADEntity_CSPtr LWPolyline::modify(meta::Layer_CSPtr layer, meta::MetaInfo_CSPtr metaInfo, meta::Block_CSPtr block) const {
-    auto newEntity = std::make_shared<LWPolyline>(
-            _vertex,
-            _width,
-            _elevation,
-            _tickness,
-            _closed,
-            _extrusionDirection,
-            std::move(layer),
-            std::move(metaInfo),
-            std::move(block)
+    // The geometry doesn't change, so the segments and their tree are shared
+    auto newEntity = std::make_shared<LWPolyline>(shared_from_this(),
+                                                  std::move(layer),
+                                                  std::move(metaInfo),
+                                                  std::move(block)
     );
     newEntity->setID(this->id());
 
     return newEntity;
 }
 
-void LWPolyline::generateEntities() {
-    auto itr = _vertex.begin();
-    auto lastPoint = itr;
-    itr++;
-    while (itr != vertex().end()) {
-        if (lastPoint->bulge() != 0.) {
-            _entities.push_back(std::make_shared<const Arc>(
-                    geo::Arc::createArcBulge(lastPoint->location(), itr->location(), lastPoint->bulge()),
-                    layer(),
-                    metaInfo(),
-                    block()
-            ));
-        }
-        else {
-            _entities.push_back(std::make_shared<const Line>(lastPoint->location(), itr->location(), layer(), metaInfo(), block()));
-        }
-        lastPoint = itr;
-        itr++;
+void LWPolyline::generateSegments() {
+    if (_vertex.size() < 2) {
+        return;
+    }
+
+    _segments.reserve(_closed ? _vertex.size() : _vertex.size() - 1);
+
+    for (size_t i = 1; i < _vertex.size(); i++) {
+        _segments.emplace_back(_vertex[i - 1].location(), _vertex[i].location(), _vertex[i - 1].bulge());
     }
 
     if (_closed) {
-        auto firstP = _vertex.begin();
-        if (lastPoint->bulge() != 0.) {
-            _entities.push_back(std::make_shared<const Arc>(
-                    geo::Arc::createArcBulge(lastPoint->location(), firstP->location(), lastPoint->bulge()),
-                    layer(),
-                    metaInfo(),
-                    block()
-            ));
-        }
-        else {
-            _entities.push_back(std::make_shared<const Line>(lastPoint->location(), firstP->location(), layer(), metaInfo(), block()));
-        }
+        _segments.emplace_back(_vertex.back().location(), _vertex.front().location(), _vertex.back().bulge());
     }
+
+    _boundingBox = _segments.front().boundingBox;
+    for (const auto& segment : _segments) {
+        _boundingBox = _boundingBox.merge(segment.boundingBox);
+    }
+}
+
+const storage::SegmentBVH& LWPolyline::segmentTree() const {
+    return _segmentTree.get([this]() {
+        std::vector<geo::Area> boxes;
+        boxes.reserve(_segments.size());
+
+        for (const auto& segment : _segments) {
+            boxes.push_back(segment.isArc() ? segment.boundingBox.merge(segment.center) : segment.boundingBox);
+        }
+
+        return boxes;
+    });
 }
 
 std::vector<EntityCoordinate> LWPolyline::snapPoints(const geo::Coordinate& coord,
@@ -197,53 +226,54 @@ std::vector<EntityCoordinate> LWPolyline::snapPoints(const geo::Coordinate& coor
                                                      int maxNumberOfSnapPoints) const {
     std::vector<EntityCoordinate> points;
     if ((bool) (constrain.constrain() & SimpleSnapConstrain::LOGICAL)) {
-        const auto &&entities = asEntities();
-        for (auto &geoItem : entities) {
-            if (auto vector = std::dynamic_pointer_cast<const geo::Vector>(geoItem)) {
-                points.emplace_back(vector->start(), -1);
-                points.emplace_back(vector->end(), -2);
-            } else if (auto arc = std::dynamic_pointer_cast<const geo::Arc>(geoItem)) {
-                points.emplace_back(arc->startP(), -3);
-                points.emplace_back(arc->endP(), -4);
-                points.emplace_back(arc->center(), -5);
+        // Snap points further away than minDistanceToSnap are removed by snapPointsCleanup
+        const geo::Area snapArea(coord - minDistanceToSnap, coord + minDistanceToSnap);
+
+        visitSegments(snapArea, [&points](const LWSegment2D& segment) {
+            if (!segment.isArc()) {
+                points.emplace_back(segment.start, -1);
+                points.emplace_back(segment.end, -2);
+            } else {
+                const auto arc = segment.arc();
+                points.emplace_back(arc.startP(), -3);
+                points.emplace_back(arc.endP(), -4);
+                points.emplace_back(arc.center(), -5);
 
                 // Add 4 coordinates
                 // Top Point
-                if (arc->isAngleBetween(.5 * M_PI)) {
-                    const auto coord = arc->center() + lc::geo::Coordinate(0., arc->radius());
+                if (arc.isAngleBetween(.5 * M_PI)) {
+                    const auto coord = arc.center() + lc::geo::Coordinate(0., arc.radius());
                     points.emplace_back(coord, 1);
                 }
                 // Right Point
-                if (arc->isAngleBetween(0)) {
-                    const auto coord = arc->center() + lc::geo::Coordinate(arc->radius(), 0.);
+                if (arc.isAngleBetween(0)) {
+                    const auto coord = arc.center() + lc::geo::Coordinate(arc.radius(), 0.);
                     points.emplace_back(coord, 2);
                 }
                 // Left Point
-                if (arc->isAngleBetween(M_PI)) {
-                    const auto coord = arc->center() + lc::geo::Coordinate(-arc->radius(), 0.);
+                if (arc.isAngleBetween(M_PI)) {
+                    const auto coord = arc.center() + lc::geo::Coordinate(-arc.radius(), 0.);
                     points.emplace_back(coord, 3);
                 }
                 // Bottom Point
-                if (arc->isAngleBetween(-.5 * M_PI)) {
-                    const auto coord = arc->center() + lc::geo::Coordinate(0., -arc->radius());
+                if (arc.isAngleBetween(-.5 * M_PI)) {
+                    const auto coord = arc.center() + lc::geo::Coordinate(0., -arc.radius());
                     points.emplace_back(coord, 4);
                 }
-            } else {
-                std::cerr << "Unknown entity found in LWPolyline during snapPoints generation" << std::endl;
             }
-        }
+        });
     }
 
     if ((bool) (constrain.constrain() & SimpleSnapConstrain::ON_ENTITY)) {
-        auto &&info = nearestPointOnPath2(coord);
-        geo::Coordinate npoe = std::get<0>(info);
-        if (auto &arc = std::get<2>(info)) {
-            const double a = (npoe - arc->center()).angle();
-            if (arc->isAngleBetween(a)) {
+        auto info = nearestPointOnPath2(coord);
+        geo::Coordinate npoe = info.first;
+        if (info.second != nullptr && info.second->isArc()) {
+            const double a = (npoe - info.second->center).angle();
+            if (info.second->arc().isAngleBetween(a)) {
                 points.emplace_back(npoe, -6);
             }
-        } else if (auto &vector = std::get<1>(info)) {
-            if (vector->nearestPointOnEntity(coord).distanceTo(coord) < minDistanceToSnap) {
+        } else if (info.second != nullptr) {
+            if (info.second->vector().nearestPointOnEntity(coord).distanceTo(coord) < minDistanceToSnap) {
                 points.emplace_back(npoe, -7);
             }
         }
@@ -260,40 +290,35 @@ std::vector<EntityCoordinate> LWPolyline::snapPoints(const geo::Coordinate& coor
 }
 
 geo::Coordinate LWPolyline::nearestPointOnPath(const geo::Coordinate& coord) const {
-    auto &&info = nearestPointOnPath2(coord);
-    return std::get<0>(info);
+    return nearestPointOnPath2(coord).first;
 }
 
-std::tuple<geo::Coordinate, std::shared_ptr<const geo::Vector>, std::shared_ptr<const geo::Arc>>
-LWPolyline::nearestPointOnPath2(const geo::Coordinate& coord) const {
-    const auto &&entities = asEntities();
+std::pair<geo::Coordinate, const LWSegment2D*> LWPolyline::nearestPointOnPath2(const geo::Coordinate& coord) const {
+    if (_segments.size() >= SEGMENT_TREE_MINIMUM_SIZE) {
+        auto nearest = segmentTree().nearest(coord, [this, &coord](size_t index) {
+            return _segments[index].nearestPointOnEntity(coord).distanceTo(coord);
+        });
+
+        const auto& segment = _segments[nearest.first];
+        return std::make_pair(segment.nearestPointOnEntity(coord), &segment);
+    }
 
     double minimumDistance = std::numeric_limits<double>::max();
-    std::shared_ptr<const geo::Vector> nearestVector = nullptr;
-    std::shared_ptr<const geo::Arc> nearestArc = nullptr;
+    const LWSegment2D* nearestSegment = nullptr;
     geo::Coordinate nearestCoordinate;
-    for (auto &geoItem : entities) {
-        if (auto vector = std::dynamic_pointer_cast<const geo::Vector>(geoItem)) {
-            auto npoe = vector->nearestPointOnPath(coord);
-            auto thisDistance = npoe.distanceTo(coord);
-            if (thisDistance < minimumDistance) {
-                minimumDistance = thisDistance;
-                nearestCoordinate = npoe;
-                nearestVector = vector;
-            }
-        } else if (auto arc = std::dynamic_pointer_cast<const geo::Arc>(geoItem)) {
-            auto npoe = arc->nearestPointOnPath(coord);
-            auto thisDistance = npoe.distanceTo(coord);
-            if (thisDistance < minimumDistance) {
-                minimumDistance = thisDistance;
-                nearestCoordinate = npoe;
-                nearestArc = arc;
-            }
-        } else {
-            std::cerr << "Unknown entity found in LWPolyline during boundingBox generation" << std::endl;
+
+    for (const auto& segment : _segments) {
+        const auto npoe = segment.nearestPointOnEntity(coord);
+        const auto thisDistance = npoe.distanceTo(coord);
+
+        if (thisDistance < minimumDistance) {
+            minimumDistance = thisDistance;
+            nearestCoordinate = npoe;
+            nearestSegment = &segment;
         }
     }
-    return std::make_tuple(nearestCoordinate, nearestVector, nearestArc);
+
+    return std::make_pair(nearestCoordinate, nearestSegment);
 }
 
 
@@ -338,5 +363,17 @@ CADEntity_CSPtr LWPolyline::setDragPoints(std::map<unsigned int, lc::geo::Coordi
 }
 
 std::vector<CADEntity_CSPtr> const LWPolyline::asEntities() const {
-    return _entities;
+    std::vector<CADEntity_CSPtr> entities;
+    entities.reserve(_segments.size());
+
+    for (const auto& segment : _segments) {
+        if (segment.isArc()) {
+            entities.push_back(std::make_shared<const Arc>(segment.arc(), layer(), metaInfo(), block()));
+        }
+        else {
+            entities.push_back(std::make_shared<const Line>(segment.start, segment.end, layer(), metaInfo(), block()));
+        }
+    }
+
+    return entities;
 }
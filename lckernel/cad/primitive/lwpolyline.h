@@ -7,6 +7,10 @@
 
 #include "cad/vo/entitycoordinate.h"
 #include "cad/geometry/geobase.h"
+#include "cad/geometry/geoarc.h"
+#include "cad/geometry/geoarea.h"
+#include "cad/geometry/geovector.h"
+#include "cad/storage/segmentbvh.h"
 #include "cad/interface/snapable.h"
 #include "cad/interface/draggable.h"
 #include <vector>
@@ -86,6 +90,45 @@ namespace lc {
             double _bulge;
         };
 
+        /**
+         * Segment between two vertices of a LWPolyline, a straight line or an arc when bulge isn't 0.
+         * The geometry of the arc and the bounding box are calculated once when the polyline is created,
+         * so the segments can be iterated without creating entities.
+         */
+        struct LWSegment2D {
+            LWSegment2D(const geo::Coordinate& start, const geo::Coordinate& end, double bulge);
+
+            bool isArc() const {
+                return bulge != 0.;
+            }
+
+            geo::Vector vector() const {
+                return geo::Vector(start, end);
+            }
+
+            geo::Arc arc() const {
+                return geo::Arc(center, radius, startAngle, endAngle, CCW);
+            }
+
+            /**
+             * @brief nearest point on the segment itself, the ends are used when the projection is outside
+             */
+            geo::Coordinate nearestPointOnEntity(const geo::Coordinate& coord) const;
+
+            geo::Coordinate start;
+            geo::Coordinate end;
+            double bulge;
+
+            // Only used when this segment is an arc
+            geo::Coordinate center;
+            double radius;
+            double startAngle;
+            double endAngle;
+            bool CCW;
+
+            geo::Area boundingBox;
+        };
+
         /**
          * Lightweight polyline
          */
@@ -118,6 +161,17 @@ namespace lc {
 
             LWPolyline(const LWPolyline_CSPtr& other, bool sameID = false);
 
+            /**
+             * @brief Create a polyline with the geometry of other, sharing its segment tree
+             * @param other polyline to copy the geometry from
+             * @param layer
+             * @param metaInfo
+             * @param block
+             */
+            LWPolyline(const LWPolyline_CSPtr& other,
+                       meta::Layer_CSPtr layer,
+                       meta::MetaInfo_CSPtr metaInfo,
+                       meta::Block_CSPtr block);
 
             double width() const {
                 return _width;
@@ -150,14 +204,56 @@ namespace lc {
                                                              int maxNumberOfSnapPoints) const override;
 
             virtual geo::Coordinate nearestPointOnPath(const geo::Coordinate &coord) const override;
-            std::tuple<geo::Coordinate, std::shared_ptr<const geo::Vector>, std::shared_ptr<const geo::Arc>>
-            nearestPointOnPath2(const geo::Coordinate &coord) const;
+
+            /**
+             * @brief nearestPointOnPath2
+             * @return nearest point on the path and the segment it belongs to, nullptr when there are no segments
+             */
+            std::pair<geo::Coordinate, const LWSegment2D*> nearestPointOnPath2(const geo::Coordinate &coord) const;
+
+            /**
+             * @brief segments of the polyline, in order of the vertices
+             * The last segment connects the last and the first vertex when the polyline is closed
+             */
+            const std::vector<LWSegment2D>& segments() const {
+                return _segments;
+            }
+
+            /**
+             * @brief Bounding volume hierarchy over segments(), built on first use
+             * The box of an arc includes its center, which is a snap point
+             */
+            const storage::SegmentBVH& segmentTree() const;
+
+            /**
+             * @brief visitSegments
+             * Call func(const LWSegment2D&) for each segment which can overlap area.
+             * Small polylines simply visit all segments, larger polylines use segmentTree()
+             */
+            template<typename T>
+            void visitSegments(const geo::Area& area, T func) const {
+                if (_segments.size() < SEGMENT_TREE_MINIMUM_SIZE) {
+                    for (const auto& segment : _segments) {
+                        func(segment);
+                    }
+                    return;
+                }
+
+                segmentTree().visitOverlapping(area, [this, &func](size_t index) {
+                    func(_segments[index]);
+                });
+            }
+
+            /**
+             * @brief Number of segments from which segmentTree() is used to find segments
+             */
+            static const size_t SEGMENT_TREE_MINIMUM_SIZE = 32;
 
         private:
             /**
-             * @brief Generate entities of the polyline
+             * @brief Generate segments of the polyline
              */
-            void generateEntities();
+            void generateSegments();
 
             const std::vector<LWVertex2D> _vertex;
             const double _width;
@@ -165,7 +261,9 @@ namespace lc {
             const double _tickness;
             const bool _closed; // If we had more 'flag' options we should consider using an enum instead of separate variables to make constructors easier
             const geo::Coordinate _extrusionDirection;
-            std::vector<CADEntity_CSPtr> _entities;
+            std::vector<LWSegment2D> _segments;
+            geo::Area _boundingBox;
+            storage::LazySegmentBVH _segmentTree;
 
         public:
             /**
@@ -214,7 +312,8 @@ namespace lc {
 
             /**
              * Return a vector of entities for this polyline
-             * The vector will contain entity::vector and entity::Arc items
+             * The vector will contain entity::Line and entity::Arc items, which are created on each call.
+             * Use segments() to iterate over the geometry without creating entities
              */
             std::vector<CADEntity_CSPtr> const asEntities() const;
 
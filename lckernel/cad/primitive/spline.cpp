@@ -34,18 +34,16 @@ Spline::Spline(
 
 Spline::Spline(const Spline_CSPtr& other, bool sameID) :
         CADEntity(other, sameID),
-        geo::Spline(
-                other->controlPoints(),
-                other->knotPoints(),
-                other->fitPoints(),
-                other->degree(),
-                other->closed(),
-                other->fitTolerance(),
-                other->startTanX(), other->startTanY(), other->startTanZ(),
-                other->endTanX(), other->endTanY(), other->endTanZ(),
-                other->nX(), other->nY(), other->nZ(),
-                other->flags()
-        ),
+        geo::Spline(*other),
+        _boundingBox(other->boundingBox()) {
+}
+
+Spline::Spline(const Spline_CSPtr& other,
+               meta::Layer_CSPtr layer,
+               meta::MetaInfo_CSPtr metaInfo,
+               meta::Block_CSPtr block) :
+        CADEntity(std::move(layer), std::move(metaInfo), std::move(block)),
+        geo::Spline(*other),
         _boundingBox(other->boundingBox()) {
 }
 
@@ -53,17 +51,26 @@ std::vector<EntityCoordinate> Spline::snapPoints(const geo::Coordinate& coord,
                                                  const SimpleSnapConstrain & constrain,
                                                  double minDistanceToSnap,
                                                  int maxNumberOfSnapPoints) const {
-    /* TODO implement
-     * fix compiler warning
-     */
-    return std::vector<EntityCoordinate>();
+    std::vector<EntityCoordinate> points;
+
+    if ((bool) (constrain.constrain() & SimpleSnapConstrain::LOGICAL) && !beziers().empty()) {
+        points.emplace_back(beziers().front()->DirectValueAt(0.), 0);
+        points.emplace_back(beziers().back()->DirectValueAt(1.), 1);
+    }
+
+    if ((bool) (constrain.constrain() & SimpleSnapConstrain::ON_ENTITY) ||
+        (bool) (constrain.constrain() & SimpleSnapConstrain::ON_ENTITYPATH)) {
+        geo::Coordinate npoe = nearestPointOnEntity(coord);
+        points.emplace_back(npoe, -1);
+    }
+
+    // Cleanup array of snappoints
+    Snapable::snapPointsCleanup(points, coord, maxNumberOfSnapPoints, minDistanceToSnap);
+    return points;
 }
 
 geo::Coordinate Spline::nearestPointOnPath(const geo::Coordinate& coord) const {
-    /* TODO implement
-     * fix compiler warning
-     */
-    return geo::Coordinate();
+    return geo::Spline::nearestPointOnPath(coord);
 }
 
 CADEntity_CSPtr Spline::move(const geo::Coordinate& offset) const {
@@ -222,19 +229,11 @@ const geo::Area Spline::boundingBox() const {
 }
 
 CADEntity_CSPtr Spline::modify(meta::Layer_CSPtr layer, meta::MetaInfo_CSPtr metaInfo, meta::Block_CSPtr block) const {
-    auto newSpline = std::make_shared<Spline>(
-            controlPoints(),
-            knotPoints(),
-            fitPoints(),
-            degree(),
-            closed(),
-            fitTolerance(),
-            startTanX(), startTanY(), startTanZ(),
-            endTanX(), endTanY(), endTanZ(),
-            nX(), nY(), nZ(), flags(),
-            layer,
-            metaInfo,
-            block
+    // The geometry doesn't change, so the beziers and their tree are shared
+    auto newSpline = std::make_shared<Spline>(shared_from_this(),
+                                              std::move(layer),
+                                              std::move(metaInfo),
+                                              std::move(block)
     );
     newSpline->setID(id());
 
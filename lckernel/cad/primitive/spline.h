@@ -55,6 +55,18 @@ namespace lc {
 
             Spline(const Spline_CSPtr& other, bool sameID = false);
 
+            /**
+             * @brief Create a spline with the geometry of other, sharing its beziers and their tree
+             * @param other spline to copy the geometry from
+             * @param layer
+             * @param metaInfo
+             * @param block
+             */
+            Spline(const Spline_CSPtr& other,
+                   meta::Layer_CSPtr layer,
+                   meta::MetaInfo_CSPtr metaInfo,
+                   meta::Block_CSPtr block);
+
             std::vector<EntityCoordinate> snapPoints(const geo::Coordinate &coord,
                                                      const SimpleSnapConstrain & constrain,
                                                      double minDistanceToSnap,
@@ -16,6 +16,8 @@ Document::Document():
         _addEntityEvent(),
         _replaceEntityEvent(),
         _removeEntityEvent(),
+        _addEntitiesEvent(),
+        _removeEntitiesEvent(),
         _addLayerEvent(),
         _replaceLayerEvent(),
         _removeLayerEvent(),
@@ -59,6 +61,14 @@ Nano::Signal<void(const lc::event::RemoveEntityEvent&)>& Document::removeEntityE
     return this->_removeEntityEvent;
 }
 
+Nano::Signal<void(const lc::event::AddEntitiesEvent&)>& Document::addEntitiesEvent() {
+    return this->_addEntitiesEvent;
+}
+
+Nano::Signal<void(const lc::event::RemoveEntitiesEvent&)>& Document::removeEntitiesEvent() {
+    return this->_removeEntitiesEvent;
+}
+
 Nano::Signal<void(const lc::event::RemoveLayerEvent&)>& Document::removeLayerEvent() {
     return this->_removeLayerEvent;
 }
@@ -19,7 +19,9 @@
 #include "cad/events/commitprocessevent.h"
 
 #include "cad/events/addentityevent.h"
+#include "cad/events/addentitiesevent.h"
 #include "cad/events/removeentityevent.h"
+#include "cad/events/removeentitiesevent.h"
 #include "cad/events/replaceentityevent.h"
 
 #include "cad/events/addlinepatternevent.h"
@@ -69,6 +71,16 @@ namespace lc {
                  */
                 virtual Nano::Signal<void(const lc::event::RemoveEntityEvent&)>& removeEntityEvent();
 
+                /*!
+                 * \brief Event to add a set of entities, send instead of AddEntityEvent by insertEntities()
+                 */
+                virtual Nano::Signal<void(const lc::event::AddEntitiesEvent&)>& addEntitiesEvent();
+
+                /*!
+                 * \brief Event to remove a set of entities, send instead of RemoveEntityEvent by removeEntities()
+                 */
+                virtual Nano::Signal<void(const lc::event::RemoveEntitiesEvent&)>& removeEntitiesEvent();
+
                 /*!
                  * \brief Event to remove an layer
                  */
@@ -151,12 +163,26 @@ namespace lc {
                  */
                 virtual void insertEntity(const entity::CADEntity_CSPtr& cadEntity) = 0;
 
+                /*!
+                 * \brief add a large number of entities to the document at once.
+                 * A single AddEntitiesEvent is send for all entities
+                 * \param cadEntities Entities to be added
+                 */
+                virtual void insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) = 0;
+
                 /*!
                  * \brief removes an entity from the document.
                  * \param id ID of the entity to be removed.
                  */
                 virtual void removeEntity(const entity::CADEntity_CSPtr& entity) = 0;
 
+                /*!
+                 * \brief removes a set of entities from the document.
+                 * A single RemoveEntitiesEvent is send for all entities
+                 * \param entities Entities to be removed
+                 */
+                virtual void removeEntities(const std::vector<entity::CADEntity_CSPtr>& entities) = 0;
+
                 /**
                 *  \brief add a new layer to the document
                 *  \param layer layer to be added.
@@ -239,6 +265,8 @@ namespace lc {
                 Nano::Signal<void(const lc::event::AddEntityEvent&)> _addEntityEvent;
                 Nano::Signal<void(const lc::event::ReplaceEntityEvent&)> _replaceEntityEvent;
                 Nano::Signal<void(const lc::event::RemoveEntityEvent&)> _removeEntityEvent;
+                Nano::Signal<void(const lc::event::AddEntitiesEvent&)> _addEntitiesEvent;
+                Nano::Signal<void(const lc::event::RemoveEntitiesEvent&)> _removeEntitiesEvent;
 
                 Nano::Signal<void(const lc::event::AddLayerEvent&)> _addLayerEvent;
                 Nano::Signal<void(const lc::event::ReplaceLayerEvent&)> _replaceLayerEvent;
@@ -8,6 +8,9 @@
 
 using namespace lc::storage;
 
+// Number of entities from where the spatial index is build in a single pass
+static const size_t BULK_INSERT_THRESHOLD = 1000;
+
 DocumentImpl::DocumentImpl(StorageManager_SPtr storageManager) :
         Document() ,
         _storageManager(std::move(storageManager)) {
@@ -45,15 +48,62 @@ void DocumentImpl::commit(const operation::DocumentOperation_SPtr& operation) {
 }
 
 void DocumentImpl::insertEntity(const entity::CADEntity_CSPtr& cadEntity) {
-    if (_storageManager->entityByID(cadEntity->id()) != nullptr) {
-        removeEntity(cadEntity);
+    auto old = _storageManager->entityByID(cadEntity->id());
+    if (old != nullptr) {
+        removeEntity(old);
     }
 
     _storageManager->insertEntity(cadEntity);
+    entityInserted(cadEntity);
+
     event::AddEntityEvent event(cadEntity);
     addEntityEvent()(event);
 
+    if (cadEntity->block() != nullptr) {
+        updateInserts({cadEntity->block()});
+    }
+}
+
+void DocumentImpl::insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) {
+    if (cadEntities.empty()) {
+        return;
+    }
+
+    // Entities replaced by a new version
+    std::vector<entity::CADEntity_CSPtr> replaced;
+    for (const auto& cadEntity : cadEntities) {
+        auto old = _storageManager->entityByID(cadEntity->id());
+        if (old != nullptr) {
+            replaced.push_back(std::move(old));
+        }
+    }
+    removeEntities(replaced);
+
+    if (cadEntities.size() >= BULK_INSERT_THRESHOLD) {
+        _storageManager->insertEntities(cadEntities);
+    }
+    else {
+        for (const auto& cadEntity : cadEntities) {
+            _storageManager->insertEntity(cadEntity);
+        }
+    }
+
+    for (const auto& cadEntity : cadEntities) {
+        entityInserted(cadEntity);
+    }
+
+    event::AddEntitiesEvent event(cadEntities);
+    addEntitiesEvent()(event);
+
+    updateInserts(event.blocks());
+}
+
+void DocumentImpl::entityInserted(const entity::CADEntity_CSPtr& cadEntity) {
     auto insert = std::dynamic_pointer_cast<const entity::Insert>(cadEntity);
+    if (insert != nullptr) {
+        _inserts[insert->displayBlock()].insert(insert);
+    }
+
     if (insert != nullptr && std::dynamic_pointer_cast<const entity::CustomEntity>(cadEntity) == nullptr) {
         auto ces = std::dynamic_pointer_cast<const meta::CustomEntityStorage>(insert->displayBlock());
 
@@ -65,18 +115,73 @@ void DocumentImpl::insertEntity(const entity::CADEntity_CSPtr& cadEntity) {
 }
 
 void DocumentImpl::removeEntity(const entity::CADEntity_CSPtr& entity) {
+    entityRemoved(entity);
+
+    if (_storageManager->entityByID(entity->id()) != nullptr) {
+        _storageManager->removeEntity(entity);
+        event::RemoveEntityEvent event(entity);
+        removeEntityEvent()(event);
+
+        if (entity->block() != nullptr) {
+            updateInserts({entity->block()});
+        }
+    }
+}
+
+void DocumentImpl::removeEntities(const std::vector<entity::CADEntity_CSPtr>& entities) {
+    std::vector<entity::CADEntity_CSPtr> removed;
+    removed.reserve(entities.size());
+
+    for (const auto& entity : entities) {
+        entityRemoved(entity);
+
+        if (_storageManager->entityByID(entity->id()) != nullptr) {
+            _storageManager->removeEntity(entity);
+            removed.push_back(entity);
+        }
+    }
+
+    if (!removed.empty()) {
+        event::RemoveEntitiesEvent event(removed);
+        removeEntitiesEvent()(event);
+
+        updateInserts(event.blocks());
+    }
+}
+
+void DocumentImpl::entityRemoved(const entity::CADEntity_CSPtr& entity) {
     auto insert = std::dynamic_pointer_cast<const entity::Insert>(entity);
+    if (insert != nullptr) {
+        auto it = _inserts.find(insert->displayBlock());
+        if (it != _inserts.end()) {
+            it->second.erase(insert);
+
+            if (it->second.empty()) {
+                _inserts.erase(it);
+            }
+        }
+    }
+
     if (insert != nullptr && std::dynamic_pointer_cast<const entity::CustomEntity>(entity) == nullptr) {
         auto ces = std::dynamic_pointer_cast<const meta::CustomEntityStorage>(insert->displayBlock());
         if (ces != nullptr) {
             _waitingCustomEntities[ces->pluginName()].erase(insert);
         }
     }
+}
 
-    if (_storageManager->entityByID(entity->id()) != nullptr) {
-        _storageManager->removeEntity(entity);
-        event::RemoveEntityEvent event(entity);
-        removeEntityEvent()(event);
+void DocumentImpl::updateInserts(const std::vector<meta::Block_CSPtr>& blocks) {
+    for (const auto& block : blocks) {
+        auto it = _inserts.find(block);
+        if (it == _inserts.end()) {
+            continue;
+        }
+
+        // The inserts already calculated their new bounding box when the event was send,
+        // inserting them again replaces the bounding box stored in the spatial index
+        for (const auto& insert : it->second) {
+            _storageManager->insertEntity(insert);
+        }
     }
 }
 
@@ -3,6 +3,7 @@
 #include <mutex>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <map>
 #include "cad/const.h"
@@ -22,8 +23,12 @@ namespace lc {
             public:
                 void insertEntity(const entity::CADEntity_CSPtr& cadEntity) override;
 
+                void insertEntities(const std::vector<entity::CADEntity_CSPtr>& cadEntities) override;
+
                 void removeEntity(const entity::CADEntity_CSPtr& entity) override;
 
+                void removeEntities(const std::vector<entity::CADEntity_CSPtr>& entities) override;
+
                 void addDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt) override;
 
                 void removeDocumentMetaType(const meta::DocumentMetaType_CSPtr& dmt) override;
@@ -81,12 +86,29 @@ namespace lc {
                 std::vector<lc::meta::Block_CSPtr> blocks() const override;
 
             private:
+                /**
+                 * Register custom entities for a inserted entity
+                 */
+                void entityInserted(const entity::CADEntity_CSPtr& cadEntity);
+
+                /**
+                 * Unregister custom entities for a removed entity
+                 */
+                void entityRemoved(const entity::CADEntity_CSPtr& entity);
+
+                /**
+                 * Index the inserts of blocks which entities changed again, their bounding box changed
+                 */
+                void updateInserts(const std::vector<meta::Block_CSPtr>& blocks);
+
                 std::mutex _documentMutex;
                 // AI am considering remove the shared_ptr from this one so we can never get a shared object from it
                 StorageManager_SPtr _storageManager;
 
                 std::map<std::string, std::unordered_set<entity::Insert_CSPtr>> _waitingCustomEntities;
                 std::unordered_set<entity::Insert_CSPtr> _newWaitingCustomEntities;
+                // Inserts in the document for each displayed block
+                std::unordered_map<meta::Block_CSPtr, std::unordered_set<entity::Insert_CSPtr>> _inserts;
         };
     }
 }
@@ -29,9 +29,12 @@ namespace lc {
          * this might be a little fast, but marginally... A other option could be is to configure the quadtree
          * to set a large number of objects
          *
+         * The root bounds of the quad tree are not fixed, the root grows when a entity is inserted outside of it
+         * and is fitted to the entities when a large number of entities gets inserted at once.
          *
-         * @todo once a while we should create a new entity container to setup the root bounds correctly
-         * this would normally not needed when getting a copy. This can be added within the optimise method?
+         * Copies share the quad tree until one of them is modified (copy on write), so copying a container, for
+         * example to keep a snapshot or to return it by value, doesn't copy the entities. The tree is only copied
+         * when a container is modified while an other container still uses it.
          */
         template<typename CT>
         class EntityContainer {
@@ -42,34 +45,21 @@ namespace lc {
                  * Usually you would retrieve a EntityContainer from the document
                  */
                 EntityContainer() {
-                    _tree = new QuadTree<CT>(geo::Area(geo::Coordinate(-500000., -500000.),
-                                                       geo::Coordinate(500000., 500000.)
+                    // Initial bounds, the tree gets fitted to the first entity
+                    _tree = std::make_shared<QuadTree<CT>>(geo::Area(geo::Coordinate(-500000., -500000.),
+                                                                     geo::Coordinate(500000., 500000.)
                     ));
                 }
 
                 /**
                  * @brief EntityContainer
-                 * Copy Constructor
+                 * Copy Constructor, the quad tree is shared until one of the containers is modified
                  */
-                EntityContainer(const EntityContainer& other) {
-                    _tree = new QuadTree<CT>(*other._tree);
-                }
-
-
-                virtual ~EntityContainer() {
-                    delete _tree;
-                }
+                EntityContainer(const EntityContainer& other) = default;
 
-                EntityContainer& operator=(const EntityContainer& ec) {
-                    if (this != &ec) {
-                        if (_tree) {
-                            delete _tree;
-                        }
-                        _tree = new QuadTree<CT>(*ec._tree);
-                    }
+                virtual ~EntityContainer() = default;
 
-                    return *this;
-                }
+                EntityContainer& operator=(const EntityContainer& ec) = default;
 
                 /*!
                  * \brief add an entity to the EntityContainer
@@ -77,9 +67,20 @@ namespace lc {
                  * \param entity entity to be added to the document.
                  */
                 void insert(CT entity) {
+                    detach();
                     _tree->insert(entity);
                 }
 
+                /*!
+                 * \brief Add a large number of entities at once
+                 * The spatial index is build in a single pass when the batch is large compared to this container
+                 * Any entity that already exists will get replaced
+                 * \param entities
+                 */
+                void insert(const std::vector<CT>& entities) {
+                    detach();
+                    _tree->bulkLoad(entities);
+                }
 
                 /*!
                  * \brief Add all entities to this container
@@ -87,9 +88,8 @@ namespace lc {
                  * \param EntityContainer to be combined to the document.
                  */
                 void combine(const EntityContainer& entities) {
-                    for (auto i : entities.asVector(std::numeric_limits<short>::max())) {
-                        _tree->insert(i);
-                    }
+                    detach();
+                    _tree->bulkLoad(entities.asVector(std::numeric_limits<short>::max()));
                 }
 
                 /*!
@@ -97,6 +97,7 @@ namespace lc {
                  * \param id Entity ID of entity which is to be removed.
                  */
                 void remove(CT entity) {
+                    detach();
                     _tree->erase(entity);
                 }
 
@@ -163,24 +164,36 @@ namespace lc {
                  * Find all entities within a selected area based on boundingbox of the entities
                  * @param area
                  * @return
-                 * TODO: Consider giving a container to drop entities into. This can be used for example during drawing
-                 * where we don't require  a QuadTree but just a linear array of entities tobe drawn
                  */
                 EntityContainer entitiesFullWithinArea(const geo::Area& area,
                                                        const short maxLevel = std::numeric_limits<short>::max()) const {
                     EntityContainer container;
-                    std::vector<CT> entities = _tree->retrieve(area, maxLevel);
 
-                    for (auto i : entities) {
-                        // If the item fully with's with the selection area sinmply add it
-                        if (i->boundingBox().inArea(area)) {
-                            container.insert(i);
-                        }
-                    }
+                    eachFullWithinArea(area, [&container](const CT& entity) {
+                        container.insert(entity);
+                    }, maxLevel);
 
                     return container;
                 }
 
+                /**
+                 * @brief eachFullWithinArea
+                 * Call func for each entity that fits fully within area, based on the boundingbox of the entities
+                 * Unlike entitiesFullWithinArea no container is created, func must not modify this container
+                 * @param area
+                 * @param func function called with a const CT&
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void eachFullWithinArea(const geo::Area& area, T func,
+                                        const short maxLevel = std::numeric_limits<short>::max()) const {
+                    _tree->visitOverlapping(area, [&](const CT& entity, const geo::Area& boundingBox) {
+                        if (boundingBox.inArea(area)) {
+                            func(entity);
+                        }
+                    }, maxLevel);
+                }
+
                 /**
                  * Calculate boundingBox of all entities in this container
                  */
@@ -201,69 +214,34 @@ namespace lc {
                  * Find all entities within a selected area or where the path is crossing the area bounderies
                  * @param area
                  * @return
-                 *
-                 * TODO: create a version like this to get a rought estimate of what's located within a area
-                 * this can be used to accelerate drawing performance.
-                 * TODO: Consider giving a container to drop entities into. This can be used for example during drawing
-                 * where we don't require  a QuadTree but just a linear array of entities tobe drawn
                  */
                 EntityContainer entitiesWithinAndCrossingArea(const geo::Area& area,
                                                               const short maxLevel = std::numeric_limits<short>::max()) const {
                     EntityContainer container;
-                    std::vector<CT> entities = _tree->retrieve(area, maxLevel);
 
-                    for (auto i : entities) {
-
-                        // If the item fully with's with the selection area sinmply add it
-                        if (i->boundingBox().inArea(area)) {
-                            container.insert(i);
-                            continue;
-                        }
-
-                        // if it has 2 corners inside area, we know for 100% sure that the entity, or
-                        // at least part of it is located within area
-                        // We test for 2 (not 1) because for exampke with a arc we can have one corner inside
-                        // The area, but still not intersecting with area
-                        auto c = i->boundingBox().numCornersInside(area);
-
-                        if (c == 2) {
-                            container.insert(i);
-                            continue;
-                        }
-
-                        // Path to area intersection testing
-                        lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, 10e-4);
+                    eachWithinAndCrossingArea(area, [&container](const CT& entity) {
+                        container.insert(entity);
+                    }, maxLevel);
 
-                        auto&& v = area.top();
-                        visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, v, *i.get());
-                        if (!intersect.result().empty()) {
-                            container.insert(i);
-                            continue;
-                        }
-
-                        v = area.left();
-                        visitorDispatcher<bool, GeoEntityVisitor>(intersect, v, *i.get());
-                        if (!intersect.result().empty()) {
-                            container.insert(i);
-                            continue;
-                        }
-
-                        v = area.bottom();
-                        visitorDispatcher<bool, GeoEntityVisitor>(intersect, v, *i.get());
-                        if (!intersect.result().empty()) {
-                            container.insert(i);
-                            continue;
-                        }
+                    return container;
+                }
 
-                        v = area.right();
-                        visitorDispatcher<bool, GeoEntityVisitor>(intersect, v, *i.get());
-                        if (!intersect.result().empty()) {
-                            container.insert(i);
-                            continue;
+                /**
+                 * @brief eachWithinAndCrossingArea
+                 * Call func for each entity within a selected area or where the path is crossing the area bounderies
+                 * Unlike entitiesWithinAndCrossingArea no container is created, func must not modify this container
+                 * @param area
+                 * @param func function called with a const CT&
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void eachWithinAndCrossingArea(const geo::Area& area, T func,
+                                               const short maxLevel = std::numeric_limits<short>::max()) const {
+                    _tree->visitOverlapping(area, [&](const CT& entity, const geo::Area& boundingBox) {
+                        if (withinOrCrossing(entity, boundingBox, area)) {
+                            func(entity);
                         }
-                    }
-
-                    return container;
+                    }, maxLevel);
                 }
 
                 /**
@@ -280,16 +258,64 @@ namespace lc {
                                                   const short maxLevel = std::numeric_limits<short>::max()) const {
                     EntityContainer container;
 
-                    std::vector<CT>&& entities = _tree->retrieve(area, maxLevel);
+                    eachWithinAndCrossingAreaFast(area, [&container](const CT& entity) {
+                        container.insert(entity);
+                    }, maxLevel);
 
-                    for (auto& i : entities) {
-                        // If the item fully with's with the selection area simply add it
-                        if (i->boundingBox().overlaps(area)) {
-                            container.insert(i);
+                    return container;
+                }
+
+                /**
+                 * @brief eachWithinAndCrossingAreaFast
+                 * Call func for each entity who's bounding box overlaps with area.
+                 * This is the version to use during drawing, where a linear list of entities is all we need:
+                 * no container or temporary list is created. func must not modify this container
+                 *
+                 * Example:
+                 * <pre>
+                 *  _visibleDrawables.clear();
+                 *  entityContainer.eachWithinAndCrossingAreaFast(visibleUserArea, [&](const CADEntity_CSPtr& entity) {
+                 *      _visibleDrawables.push_back(_entityDrawItem[entity]);
+                 *  });
+                 * </pre>
+                 * @param area
+                 * @param func function called with a const CT&
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void eachWithinAndCrossingAreaFast(const geo::Area& area, T func,
+                                                   const short maxLevel = std::numeric_limits<short>::max()) const {
+                    _tree->visitOverlapping(area, [&](const CT& entity, const geo::Area&) {
+                        func(entity);
+                    }, maxLevel);
+                }
+
+                /**
+                 * @brief eachWithinAndCrossingAreaDetail
+                 * Same as eachWithinAndCrossingAreaFast, but entities smaller than minimumSize are culled.
+                 * Nodes of the tree too small to hold an entity of minimumSize are not visited at all,
+                 * culledFunc is called once for each of them with one of their entities.
+                 * Smaller entities in the visited nodes are passed to culledFunc one by one.
+                 * culledFunc is called as culledFunc(const CT& entity, const geo::Area& culledArea)
+                 * @param area
+                 * @param minimumSize
+                 * @param func function called with a const CT&
+                 * @param culledFunc
+                 */
+                template<typename T, typename U>
+                void eachWithinAndCrossingAreaDetail(const geo::Area& area, double minimumSize, T func, U culledFunc) const {
+                    const short maxLevel = _tree->levelForSize(minimumSize);
+
+                    _tree->visitOverlapping(area, [&](const CT& entity, const geo::Area& boundingBox) {
+                        if (boundingBox.width() < minimumSize && boundingBox.height() < minimumSize) {
+                            culledFunc(entity, boundingBox);
                         }
-                    }
+                        else {
+                            func(entity);
+                        }
+                    }, maxLevel);
 
-                    return container;
+                    _tree->visitCulled(area, culledFunc, maxLevel);
                 }
 
                 /*!
@@ -300,15 +326,28 @@ namespace lc {
                  */
                 std::vector<lc::EntityDistance> getEntityPathsNearCoordinate(const lc::geo::Coordinate& point,
                                                                              double distance) const {
+                    std::vector<lc::EntityDistance> entities;
+                    getEntityPathsNearCoordinate(point, distance, entities);
+                    return entities;
+                }
 
-                    const auto area = lc::geo::Area(lc::geo::Coordinate(point.x(), point.y()) + distance / 2.,
-                                                    lc::geo::Coordinate(point.x(), point.y()) + distance / 2.);
-                    std::vector<CT> ent = _tree->retrieve(area);
+                /*!
+                 * \brief getEntityPathsNearCoordinate
+                 * Same as above, but appends the found entities to a list owned by the caller.
+                 * Callers that run often (for example on each mouse move) can re-use the list to avoid allocations.
+                 * \param point point where to look for entities
+                 * \param distance maximum distance from this point where the function would consider adding it to a list
+                 * \param entities list where the entities near this coordinate get appended to
+                 */
+                void getEntityPathsNearCoordinate(const lc::geo::Coordinate& point,
+                                                  double distance,
+                                                  std::vector<lc::EntityDistance>& entities) const {
+
+                    const auto area = lc::geo::Area(point - distance, point + distance);
 
                     // Now calculate for each entity if we are near the entities path
-                    std::vector<lc::EntityDistance> entities;
-                    for (auto item : ent) {
-                        lc::entity::Snapable_CSPtr entity = std::dynamic_pointer_cast<const lc::entity::Snapable>(item);
+                    _tree->visitOverlapping(area, [&](const CT& item, const geo::Area&) {
+                        auto entity = std::dynamic_pointer_cast<const lc::entity::Snapable>(item);
 
                         if (entity != nullptr) { // Not all entities might be snapable, so we only test if this is possible.
                             lc::geo::Coordinate eCoordinate = entity->nearestPointOnPath(point);
@@ -316,9 +355,37 @@ namespace lc {
                                 entities.emplace_back(item, eCoordinate);
                             }
                         }
-                    }
+                    });
+                }
 
-                    return entities;
+                /*!
+                 * \brief nearestEntityPaths
+                 * Find the entities with a path closest to point, closest first.
+                 * Unlike getEntityPathsNearCoordinate the amount of work doesn't grow with the number of entities
+                 * near point, only the bounding boxes of the tree and the k closest entities get tested.
+                 * \param point point where to look for entities
+                 * \param k maximum number of entities to find
+                 * \param distance maximum distance between point and the path of an entity
+                 * \param entities list where the entities near this coordinate get appended to
+                 */
+                void nearestEntityPaths(const lc::geo::Coordinate& point,
+                                        unsigned int k,
+                                        double distance,
+                                        std::vector<lc::EntityDistance>& entities) const {
+                    const auto nearest = _tree->nearest(point, k, distance, [&](const CT& item) {
+                        auto entity = std::dynamic_pointer_cast<const lc::entity::Snapable>(item);
+
+                        if (entity == nullptr) {
+                            return std::numeric_limits<double>::infinity();
+                        }
+
+                        return entity->nearestPointOnPath(point).distanceTo(point);
+                    });
+
+                    for (const auto& item : nearest) {
+                        auto entity = std::dynamic_pointer_cast<const lc::entity::Snapable>(item.first);
+                        entities.emplace_back(item.first, entity->nearestPointOnPath(point));
+                    }
                 }
 
                 /**
@@ -332,10 +399,24 @@ namespace lc {
 
                 /**
                  * @brief optimise
-                 * this container
+                 * this container, a tree shared with a copy is only detached when it has empty nodes to remove
                  */
                 void optimise() {
-                    _tree->optimise();
+                    if (_tree->dirty()) {
+                        detach();
+                        _tree->optimise();
+                    }
+                }
+
+                /**
+                 * @brief rebalance
+                 * Rebuild the tree of this container when enough entities changed, see QuadTree::rebalance
+                 */
+                void rebalance() {
+                    if (_tree->needsRebalance()) {
+                        detach();
+                        _tree->rebalance();
+                    }
                 }
 
 
@@ -361,7 +442,55 @@ namespace lc {
                 }
 
             private:
-                QuadTree<CT>* _tree;
+                /**
+                 * @brief withinOrCrossing
+                 * Test if entity is located within area or if it's path is crossing the area bounderies
+                 */
+                static bool withinOrCrossing(const CT& entity, const geo::Area& boundingBox, const geo::Area& area) {
+                    // If the item fully with's with the selection area sinmply add it
+                    if (boundingBox.inArea(area)) {
+                        return true;
+                    }
+
+                    // if it has 2 corners inside area, we know for 100% sure that the entity, or
+                    // at least part of it is located within area
+                    // We test for 2 (not 1) because for exampke with a arc we can have one corner inside
+                    // The area, but still not intersecting with area
+                    if (boundingBox.numCornersInside(area) == 2) {
+                        return true;
+                    }
+
+                    // Path to area intersection testing
+                    lc::maths::HasIntersectArea hasIntersect(area, 10e-4);
+                    if (visitorDispatcher<bool, GeoEntityVisitor>(hasIntersect, *entity.get())) {
+                        return hasIntersect.result();
+                    }
+
+                    // Entities without a dedicated test are intersected with each edge of the area
+                    for (auto&& v : {area.top(), area.left(), area.bottom(), area.right()}) {
+                        lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, 10e-4);
+                        visitorDispatcher<bool, GeoEntityVisitor>(intersect, v, *entity.get());
+
+                        if (!intersect.result().empty()) {
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+
+            private:
+                /**
+                 * @brief detach
+                 * Copy the quad tree before it gets modified when other containers use it
+                 */
+                void detach() {
+                    if (_tree.use_count() > 1) {
+                        _tree = std::make_shared<QuadTree<CT>>(*_tree);
+                    }
+                }
+
+                std::shared_ptr<QuadTree<CT>> _tree;
         };
     }
 }
@@ -5,7 +5,11 @@
 #include <unordered_map>
 #include <vector>
 #include <climits>
+#include <limits>
+#include <cmath>
+#include <cstdint>
 #include <array>
+#include <queue>
 #include "cad/geometry/geoarea.h"
 #include "cad/base/cadentity.h"
 #include <typeinfo>
@@ -499,103 +503,1302 @@ namespace lc {
          * The more object's per level the less memory it uses, but the more possiblew object's it will return during
          * retrieve
          *
-         * We could change std::vector<E> _objects; into a std::map to speed up deletion of items within the tree
-         * At this moment we need to walk over the tree to find the item's location, then delete it However,
-         * this will consume more memory
+         * Unlike QuadTreeSub, nodes are not allocated one by one but live in a single arena (std::vector) and
+         * refer to each other by index. The 4 children of a node are always stored next to each other, so a node
+         * only needs to know the index of it's first child. Blocks of children that get removed during optimise
+         * are kept on a free list and re-used by the next split.
          *
-         * mutable std::map<ID_DATATYPE, E> *_cadentities; can be removed all together, but this will
-         * slowdown testing the routine entityByID
+         * Nodes left without objects by erase are remembered, optimise only collapses the branches of these nodes,
+         * so it's cost depends on the number of changes instead of the size of the tree. rebalance rebuilds the whole
+         * tree and fits the root to the entities, it's meant to run when the application is idle.
+         *
+         * A side table maps each entity ID to the node and slot it is stored in, this replaces the walk down the tree
+         * and the linear scan of QuadTreeSub::erase with a swap and pop. The same table is used for entityByID.
+         *
+         * QuadTreeSub is kept as the pointer based reference implementation.
          */
         template<typename E>
-        class QuadTree : public QuadTreeSub<E> {
+        class QuadTree {
             public:
-                QuadTree(int level, const geo::Area& pBounds, short maxLevels, short maxObjects) :
-                        QuadTreeSub<E>(level, pBounds, maxLevels, maxObjects) {
+                /**
+                 * @brief Node
+                 * A single node within the arena
+                 */
+                struct Node {
+                    double minX;
+                    double minY;
+                    double maxX;
+                    double maxY;
+                    double verticalMidpoint;
+                    double horizontalMidpoint;
+                    // Index of the first of the 4 children, or -1 when this node wasn't split
+                    int firstChild;
+                    // Index of the parent, or -1 for the root
+                    int parent;
+                    std::vector<E> objects;
+                    // Bounding boxes of the objects, stored as separate minX, minY, maxX and maxY arrays so they can be
+                    // tested in batches. The 4 arrays share a single block, each with room for boundsCapacity values
+                    std::vector<double> objectBounds;
+                    unsigned int boundsCapacity;
+                    // The node is waiting in the list of nodes to optimise
+                    bool dirty;
+
+                    Node(double minX, double minY, double maxX, double maxY) :
+                            minX(minX),
+                            minY(minY),
+                            maxX(maxX),
+                            maxY(maxY),
+                            verticalMidpoint(minX + (maxX - minX) / 2.),
+                            horizontalMidpoint(minY + (maxY - minY) / 2.),
+                            firstChild(-1),
+                            parent(-1),
+                            boundsCapacity(0),
+                            dirty(false) {
+                    }
 
-                }
+                    geo::Area bounds() const {
+                        return geo::Area(geo::Coordinate(minX, minY), geo::Coordinate(maxX, maxY));
+                    }
+
+                    void setBounds(double pMinX, double pMinY, double pMaxX, double pMaxY) {
+                        minX = pMinX;
+                        minY = pMinY;
+                        maxX = pMaxX;
+                        maxY = pMaxY;
+                        verticalMidpoint = minX + (maxX - minX) / 2.;
+                        horizontalMidpoint = minY + (maxY - minY) / 2.;
+                    }
+
+                    const double* objectMinX() const {
+                        return objectBounds.data();
+                    }
+
+                    const double* objectMinY() const {
+                        return objectBounds.data() + boundsCapacity;
+                    }
+
+                    const double* objectMaxX() const {
+                        return objectBounds.data() + 2 * boundsCapacity;
+                    }
 
-                QuadTree(const geo::Area& bounds) : QuadTreeSub<E>(bounds) {
+                    const double* objectMaxY() const {
+                        return objectBounds.data() + 3 * boundsCapacity;
+                    }
+
+                    /**
+                     * Bounding box of a object, as it was when the object was added
+                     */
+                    geo::Area objectBoundingBox(unsigned int slot) const {
+                        return geo::Area(geo::Coordinate(objectMinX()[slot], objectMinY()[slot]),
+                                         geo::Coordinate(objectMaxX()[slot], objectMaxY()[slot]));
+                    }
+
+                    void add(const E& entity, const geo::Area& boundingBox) {
+                        const unsigned int slot = objects.size();
+
+                        if (slot == boundsCapacity) {
+                            reserve(slot == 0 ? 8 : slot * 2);
+                        }
+
+                        objects.push_back(entity);
+                        objectBounds[slot] = boundingBox.minP().x();
+                        objectBounds[boundsCapacity + slot] = boundingBox.minP().y();
+                        objectBounds[2 * boundsCapacity + slot] = boundingBox.maxP().x();
+                        objectBounds[3 * boundsCapacity + slot] = boundingBox.maxP().y();
+                    }
 
+                    /**
+                     * Remove a object, the last object takes it's place
+                     */
+                    void remove(unsigned int slot) {
+                        const unsigned int last = objects.size() - 1;
+
+                        if (slot != last) {
+                            objects[slot] = std::move(objects.back());
+
+                            for (unsigned int i = 0; i < 4; i++) {
+                                objectBounds[i * boundsCapacity + slot] = objectBounds[i * boundsCapacity + last];
+                            }
+                        }
+
+                        objects.pop_back();
+                    }
+
+                    void reserve(unsigned int size) {
+                        if (size <= boundsCapacity) {
+                            return;
+                        }
+
+                        std::vector<double> bounds(4 * size);
+
+                        for (unsigned int i = 0; i < 4; i++) {
+                            std::copy(objectBounds.begin() + i * boundsCapacity,
+                                      objectBounds.begin() + i * boundsCapacity + objects.size(),
+                                      bounds.begin() + i * size);
+                        }
+
+                        objects.reserve(size);
+                        objectBounds.swap(bounds);
+                        boundsCapacity = size;
+                    }
+
+                    void clear() {
+                        objects.clear();
+                    }
+                };
+
+                QuadTree(int level, const geo::Area& pBounds, short maxLevels, short maxObjects) :
+                        _level(level),
+                        _maxLevels(maxLevels),
+                        _maxObjects(maxObjects),
+                        _changes(0) {
+                    _nodes.emplace_back(pBounds.minP().x(), pBounds.minP().y(), pBounds.maxP().x(), pBounds.maxP().y());
+                    _nodes[0].reserve(maxObjects / 2);
                 }
 
-                QuadTree(const QuadTree& other) : QuadTreeSub<E>(other), _cadentities(other._cadentities) {
+                QuadTree(const geo::Area& bounds) : QuadTree(0, bounds, 10, 25) {
 
                 }
 
-                QuadTree() : QuadTreeSub<E>(0, geo::Area(geo::Coordinate(0., 0.), geo::Coordinate(1., 1.)), 8, 25) {
+                QuadTree(const QuadTree& other) = default;
+
+                QuadTree() : QuadTree(0, geo::Area(geo::Coordinate(0., 0.), geo::Coordinate(1., 1.)), 8, 25) {
 
                 }
 
+                QuadTree& operator=(const QuadTree& other) = default;
+
+                virtual ~QuadTree() = default;
+
                 /**
                  * @brief clear
                  * Clear the quad tree by removing all levels and removing all stored entities
                  */
                 void clear() {
-                    QuadTreeSub<E>::clear();
-                    _cadentities.clear();
+                    _nodes.erase(_nodes.begin() + 1, _nodes.end());
+                    _nodes[0].firstChild = -1;
+                    _nodes[0].clear();
+                    _nodes[0].dirty = false;
+                    _freeBlocks.clear();
+                    _dirtyNodes.clear();
+                    _locations.clear();
+                    _changes = 0;
                 }
 
                 /**
                  * @brief insert
                  * Insert entity into the quad tree
-                 * @param pRect
+                 * If a entity with the same ID already exists, it will be replaced
                  * @param entity
                  */
                 void insert(const E entity) {
-                    // LOG4CXX_DEBUG(logger, "level " << _level);
-                    //Update cache
-                    if (_cadentities.count(entity->id()) > 0) {
-                        //LOG4CXX_DEBUG(logger, "This id was already added, please fix. It's not allowed to add the same ID twice");
+                    insert(entity, entity->boundingBox());
+                }
+
+                /**
+                 * @brief insert
+                 * Insert entity into the quad tree with a already calculated bounding box
+                 * @param entity
+                 * @param entityBoundingBox
+                 */
+                void insert(const E entity, const geo::Area& entityBoundingBox) {
+                    // Single lookup in the side table, the location is filled in once the node is known
+                    auto result = _locations.emplace(entity->id(), Location{entity, 0, 0});
+                    Location& location = result.first->second;
+
+                    if (!result.second) {
+                        remove(location.node, location.slot);
+                        location.entity = entity;
+                        _changes++;
+                    }
+
+                    grow(entityBoundingBox, _locations.size() == 1);
+
+                    // Find the deepest node where this item fits
+                    unsigned int node = 0;
+                    short level = _level;
+
+                    while (_nodes[node].firstChild != -1) {
+                        short index = quadrantIndex(_nodes[node], entityBoundingBox);
+
+                        if (index == -1) {
+                            break;
+                        }
+
+                        node = _nodes[node].firstChild + index;
+                        level++;
+                    }
+
+                    location.node = node;
+                    location.slot = _nodes[node].objects.size();
+                    _nodes[node].add(entity, entityBoundingBox);
+                    _changes++;
+
+                    // If it fits in this box, see if we can/must split this area into sub area's
+                    if (_nodes[node].firstChild == -1 && _nodes[node].objects.size() >= _maxObjects && level < _maxLevels) {
+                        split(node, level);
+                    }
+                }
+
+                /**
+                 * @brief bulkLoad
+                 * Insert a large number of entities at once, for example when a file is opened.
+                 * The bounding box of each entity is calculated once and the entities are sorted on the path of
+                 * quadrants leading to the node they belong to, which is the Morton order of these nodes.
+                 * The tree is then build top down in a single pass over the sorted list, without the split and
+                 * re-distribute cycles of insert. The bounds of the root are fitted to the entities during the rebuild.
+                 * When only a few entities are added to a large tree, they are inserted one by one instead.
+                 * If a entity with the same ID already exists, it will be replaced
+                 * @param entities
+                 */
+                void bulkLoad(const std::vector<E>& entities) {
+                    if (entities.size() < _locations.size()) {
+                        for (const auto& entity : entities) {
+                            insert(entity);
+                        }
+
+                        return;
+                    }
+
+                    // Rebuild the whole tree, existing entities that get replaced are not added again
+                    for (const auto& entity : entities) {
+                        _locations.erase(entity->id());
+                    }
+
+                    std::vector<E> all;
+                    all.reserve(_locations.size() + entities.size());
+
+                    for (const auto& location : _locations) {
+                        all.push_back(location.second.entity);
                     }
 
-                    _cadentities.insert(std::make_pair(entity->id(), entity));
+                    all.insert(all.end(), entities.begin(), entities.end());
 
-                    QuadTreeSub<E>::insert(entity);
+                    clear();
+                    build(all);
                 }
 
                 /**
                  * @brief test
-                 * validy of the tree by comparing all nodes with the std::map
+                 * validy of the tree by comparing all nodes with the side table
+                 * @return true when each entity is located where the side table expects it
                  */
-                void test() const {
-                    const auto list = QuadTreeSub<E>::retrieve();
+                bool test() const {
+                    size_t count = 0;
+
+                    for (unsigned int node = 0; node < _nodes.size(); node++) {
+                        const auto& objects = _nodes[node].objects;
+
+                        for (unsigned int slot = 0; slot < objects.size(); slot++) {
+                            auto it = _locations.find(objects[slot]->id());
 
-                    if (list.size() != _cadentities.size()) {
-                        // // LOG4CXX_DEBUG(logger, "Cache size doesn't agree with QuadTreeSub size, this must be fixed ASAP difference : " << list.size() - _cadentities.size())
+                            if (it == _locations.end() || it->second.node != node || it->second.slot != slot) {
+                                return false;
+                            }
+
+                            const auto boundingBox = _nodes[node].objectBoundingBox(slot);
+                            const auto entityBoundingBox = objects[slot]->boundingBox();
+
+                            if (boundingBox.minP().x() != entityBoundingBox.minP().x() ||
+                                boundingBox.minP().y() != entityBoundingBox.minP().y() ||
+                                boundingBox.maxP().x() != entityBoundingBox.maxP().x() ||
+                                boundingBox.maxP().y() != entityBoundingBox.maxP().y()) {
+                                return false;
+                            }
+
+                            // Only the root can hold entities outside of it's bounds
+                            if (node != 0 && !contains(_nodes[node], boundingBox)) {
+                                return false;
+                            }
+                        }
+
+                        count += objects.size();
                     }
+
+                    if (count != _locations.size()) {
+                        return false;
+                    }
+
+                    // Each child of a used node refers back to it
+                    bool linked = true;
+                    _walkQuad(0, [&](const Node& n) {
+                        if (n.firstChild != -1) {
+                            for (int i = 0; i < 4; i++) {
+                                linked = linked && _nodes[n.firstChild + i].parent == &n - _nodes.data();
+                            }
+                        }
+                    });
+
+                    return linked;
                 }
 
                 /**
                  * @brief remove
                  * Remove entity from quad tree
-                 * @param pRect
+                 * The last entity of the node takes the place of the removed entity
                  * @param entity
+                 * @return true if the entity was found
                  */
                 bool erase(const E entity) {
-                    if (_cadentities.count(entity->id()) == 0) {
-                        // // LOG4CXX_DEBUG(logger, "It's bad that we end up here, normally we should call erase on entities we know that don't exists. ")
+                    auto it = _locations.find(entity->id());
+
+                    if (it == _locations.end()) {
                         return false;
                     }
 
-                    E work = _cadentities.at(entity->id());
-                    _cadentities.erase(entity->id());
+                    remove(it->second.node, it->second.slot);
+                    _locations.erase(it);
+                    _changes++;
+
+                    return true;
+                }
 
-                    return QuadTreeSub<E>::erase(work);
+                /**
+                 * @brief retrieve
+                 * all object's that are located within a given area
+                 * @param area
+                 * @param maxLevel
+                 */
+                std::vector<E> retrieve(const geo::Area& area, const short maxLevel = SHRT_MAX) const {
+                    std::vector<E> list;
+                    visit(area, [&list](const E& entity) {
+                        list.push_back(entity);
+                    }, maxLevel);
+                    return list;
                 }
 
-                const E entityByID(ID_DATATYPE id) const {
-                    if (_cadentities.count(id) > 0) {
-                        return _cadentities.at(id);
+                /**
+                 * @brief visit
+                 * Call func for each object located in a node that overlaps with area, without building a list
+                 * func must not modify the tree
+                 * @param area
+                 * @param func
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void visit(const geo::Area& area, T func, const short maxLevel = SHRT_MAX) const {
+                    _visit(0, _level, area, func, maxLevel);
+                }
+
+                /**
+                 * @brief visitOverlapping
+                 * Call func for each entity who's bounding box overlaps with area.
+                 * The bounding boxes stored in the tree are used, so entities that don't overlap are never touched.
+                 * func is called as func(const E& entity, const geo::Area& boundingBox)
+                 * @param area
+                 * @param func
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void visitOverlapping(const geo::Area& area, T func, const short maxLevel = SHRT_MAX) const {
+                    _visitOverlapping(0, _level, area, func, maxLevel);
+                }
+
+                /**
+                 * @brief visitCulled
+                 * Call func for each node just below maxLevel that includes area and holds entities.
+                 * These are the nodes skipped by visit and visitOverlapping with the same maxLevel,
+                 * they can be used to draw a placeholder for the entities which are not visited.
+                 * func is called as func(const E& representative, const geo::Area& nodeBounds),
+                 * the representative is one of the entities within the node
+                 * @param area
+                 * @param func
+                 * @param maxLevel
+                 */
+                template<typename T>
+                void visitCulled(const geo::Area& area, T func, const short maxLevel) const {
+                    _visitCulled(0, _level, area, func, maxLevel);
+                }
+
+                /**
+                 * @brief nearest
+                 * Find the k objects closest to point, using a best-first traversal of the tree.
+                 * Nodes and objects are visited in order of the distance between point and their bounding box,
+                 * the exact distance is only calculated for objects which can still be part of the result.
+                 * distance is called as distance(const E& entity) and returns the distance between point and entity,
+                 * or infinity to ignore the entity. A distance smaller than the distance to the bounding box of the
+                 * entity, for example the distance to the infinite path of a line, is raised to the latter
+                 * @param point
+                 * @param k maximum number of objects to return
+                 * @param maxDistance objects further away are ignored
+                 * @param distance
+                 * @return pairs of object and distance, closest first
+                 */
+                template<typename T>
+                std::vector<std::pair<E, double>> nearest(const geo::Coordinate& point, unsigned int k,
+                                                          double maxDistance, T distance) const {
+                    std::vector<std::pair<E, double>> result;
+
+                    if (k == 0) {
+                        return result;
+                    }
+
+                    std::priority_queue<NearestItem, std::vector<NearestItem>, std::greater<NearestItem>> queue;
+                    const Node& root = _nodes[0];
+                    queue.push({boxDistance(point, root.minX, root.minY, root.maxX, root.maxY), 0, -1, false});
+
+                    while (!queue.empty()) {
+                        const NearestItem item = queue.top();
+                        queue.pop();
+
+                        if (item.distance > maxDistance) {
+                            break;
+                        }
+
+                        const Node& n = _nodes[item.node];
+
+                        if (item.slot == -1) {
+                            if (n.firstChild != -1) {
+                                for (int i = 0; i < 4; i++) {
+                                    const Node& child = _nodes[n.firstChild + i];
+                                    const double d = boxDistance(point, child.minX, child.minY, child.maxX, child.maxY);
+
+                                    if (d <= maxDistance) {
+                                        queue.push({d, (unsigned int) n.firstChild + i, -1, false});
+                                    }
+                                }
+                            }
+
+                            for (unsigned int slot = 0; slot < n.objects.size(); slot++) {
+                                const double d = boxDistance(point, n.objectMinX()[slot], n.objectMinY()[slot],
+                                                             n.objectMaxX()[slot], n.objectMaxY()[slot]);
+
+                                if (d <= maxDistance) {
+                                    queue.push({d, item.node, (int) slot, false});
+                                }
+                            }
+                        }
+                        else if (!item.exact) {
+                            const double d = std::max(distance(n.objects[item.slot]), item.distance);
+
+                            if (d <= maxDistance) {
+                                queue.push({d, item.node, item.slot, true});
+                            }
+                        }
+                        else {
+                            result.emplace_back(n.objects[item.slot], item.distance);
+
+                            if (result.size() == k) {
+                                break;
+                            }
+                        }
+                    }
+
+                    return result;
+                }
+
+                /**
+                 * @brief retrieve
+                 * all object's within this QuadTree up until some level
+                 * @param maxLevel
+                 */
+                std::vector<E> retrieve(const short maxLevel = SHRT_MAX) const {
+                    std::vector<E> list;
+                    list.reserve(_locations.size());
+                    _retrieve(list, 0, _level, maxLevel);
+                    return list;
+                }
+
+                /**
+                 * @brief size
+                 * number of entities stored in the tree
+                 */
+                unsigned int size() const {
+                    return _locations.size();
+                }
+
+                /**
+                 * @brief entityByID
+                 * returns a entity by its ID
+                 * @param id
+                 * @return
+                 */
+                const E entityByID(const ID_DATATYPE id) const {
+                    auto it = _locations.find(id);
+
+                    if (it != _locations.end()) {
+                        return it->second.entity;
                     }
 
                     return E();
                 }
 
+                /**
+                 * @brief bounds
+                 * of the root portion of the tree
+                 * @return
+                 */
+                geo::Area bounds() const {
+                    return _nodes[0].bounds();
+                }
+
+                /**
+                 * @brief level
+                 * returns the level of the root node
+                 * @return
+                 */
+                short level() const {
+                    return _level;
+                }
+
+                /**
+                 * @brief levelForSize
+                 * Deepest level with nodes of at least size, entities stored below this level are smaller than size.
+                 * Used as maxLevel to skip entities too small to be seen
+                 * @param size
+                 * @return
+                 */
+                short levelForSize(double size) const {
+                    const double nodeSize = std::max(_nodes[0].maxX - _nodes[0].minX, _nodes[0].maxY - _nodes[0].minY);
+
+                    if (!(size > 0.) || !std::isfinite(nodeSize / size)) {
+                        return SHRT_MAX;
+                    }
+
+                    if (nodeSize < size) {
+                        return _level;
+                    }
+
+                    const double levels = std::floor(std::log2(nodeSize / size));
+                    return levels >= SHRT_MAX - _level ? SHRT_MAX : (short) (_level + levels);
+                }
+
+                /**
+                 * @brief maxLevels
+                 * Maximum number of level's possible
+                 * @return
+                 */
+                short maxLevels() const {
+                    return _maxLevels;
+                }
+
+                /**
+                 * @brief maxObjects
+                 * Maximum number of objects on a level before it gets split
+                 * @return
+                 */
+                short maxObjects() const {
+                    return _maxObjects;
+                }
+
+                /**
+                 * @brief walk
+                 * Allows to walk over each node within the tree specifying a function that can be called for each node
+                 * QuadTree no longer derives from QuadTreeSub, so the function gets a Node instead of a QuadTreeSub
+                 * @param func
+                 */
+                void walkQuad(const std::function<void(const Node&)>& func) const {
+                    _walkQuad(0, func);
+                }
+
+                /**
+                 * Call a function for each entity within the tree
+                 * Nodes are visited in arena order
+                 */
+                template<typename U, typename T>
+                void each(T func) {
+                    for (auto& node : _nodes) {
+                        std::for_each(node.objects.begin(), node.objects.end(), [&](E item) {
+                            std::shared_ptr<U> b = std::dynamic_pointer_cast<U>(item);
+                            func(b);
+                        });
+                    }
+                }
+
+                /**
+                 * @brief optimise
+                 * Optmise this tree. Empty nodes are removed, starting from the nodes left empty by erase up till
+                 * the root node. Only the branches of these nodes are visited
+                 * @return true if the tree doesn't contain any entities
+                 */
+                bool optimise() {
+                    for (unsigned int node : _dirtyNodes) {
+                        _nodes[node].dirty = false;
+                        collapse(node);
+                    }
+
+                    _dirtyNodes.clear();
+
+                    return _locations.empty();
+                }
+
+                /**
+                 * @brief dirty
+                 * @return true when optimise has empty nodes to remove
+                 */
+                bool dirty() const {
+                    return !_dirtyNodes.empty();
+                }
+
+                /**
+                 * @brief needsRebalance
+                 * @return true when at least 1 / REBALANCE_RATIO of the entities were inserted or erased since
+                 * the tree was build
+                 */
+                bool needsRebalance() const {
+                    return _changes > 0 && _changes * REBALANCE_RATIO >= _locations.size();
+                }
+
+                /**
+                 * @brief rebalance
+                 * Rebuild the tree as bulkLoad does, which removes all empty nodes and fits the root to the entities.
+                 * Nothing is done when needsRebalance is false. This visits the whole tree, so it should be called
+                 * when the application is idle
+                 * @return true if the tree was rebuild
+                 */
+                bool rebalance() {
+                    if (!needsRebalance()) {
+                        return false;
+                    }
+
+                    auto all = retrieve();
+                    clear();
+                    build(all);
+
+                    return true;
+                }
+
+                /**
+                 * Part of the entities that must have changed before rebalance rebuilds the tree
+                 */
+                static const unsigned int REBALANCE_RATIO = 8;
+
+            private:
+                /**
+                 * Entry of the queue used by nearest, either a node (slot -1) or an object of a node.
+                 * distance is the distance to the bounding box until the exact distance of an object is known
+                 */
+                struct NearestItem {
+                    double distance;
+                    unsigned int node;
+                    int slot;
+                    bool exact;
+
+                    bool operator>(const NearestItem& other) const {
+                        return distance > other.distance || (distance == other.distance && !exact && other.exact);
+                    }
+                };
+
+                struct Location {
+                    E entity;
+                    unsigned int node;
+                    unsigned int slot;
+                };
+
+                /**
+                 * Entity waiting to be placed during bulkLoad
+                 * key contains 3 bits for each level, 0 when the entity stays at that level or quadrant + 1
+                 */
+                struct BulkItem {
+                    uint64_t key;
+                    unsigned int index;
+
+                    bool operator<(const BulkItem& other) const {
+                        return key < other.key;
+                    }
+                };
+
+                // Number of levels that fit in the key of a BulkItem
+                static const short BULK_DEPTH = 21;
+
+                // Number of bounding boxes tested at once by overlapBatch
+                static const unsigned int OVERLAP_BATCH = 64;
+
+                /**
+                 * Remove a entity from a node, the location of the entity taking it's slot is updated
+                 * The location of the removed entity itself is left to the caller
+                 */
+                void remove(unsigned int node, unsigned int slot) {
+                    Node& n = _nodes[node];
+
+                    n.remove(slot);
+
+                    if (slot < n.objects.size()) {
+                        _locations[n.objects[slot]->id()].slot = slot;
+                    }
+
+                    if (n.objects.empty() && !n.dirty) {
+                        n.dirty = true;
+                        _dirtyNodes.push_back(node);
+                    }
+                }
+
+                /**
+                 * @brief build
+                 * Build the tree top down from a sorted list, used by bulkLoad on a empty tree
+                 */
+                void build(const std::vector<E>& entities) {
+                    if (entities.empty()) {
+                        return;
+                    }
+
+                    std::vector<geo::Area> boundingBoxes;
+                    boundingBoxes.reserve(entities.size());
+
+                    double minX = std::numeric_limits<double>::max();
+                    double minY = std::numeric_limits<double>::max();
+                    double maxX = std::numeric_limits<double>::lowest();
+                    double maxY = std::numeric_limits<double>::lowest();
+
+                    for (const auto& entity : entities) {
+                        boundingBoxes.push_back(entity->boundingBox());
+                        const auto& boundingBox = boundingBoxes.back();
+
+                        if (isFinite(boundingBox)) {
+                            minX = std::min(minX, boundingBox.minP().x());
+                            minY = std::min(minY, boundingBox.minP().y());
+                            maxX = std::max(maxX, boundingBox.maxP().x());
+                            maxY = std::max(maxY, boundingBox.maxP().y());
+                        }
+                    }
+
+                    if (minX <= maxX) {
+                        fit(geo::Area(geo::Coordinate(minX, minY), geo::Coordinate(maxX, maxY)));
+                    }
+
+                    std::vector<BulkItem> items;
+                    items.reserve(entities.size());
+
+                    for (unsigned int i = 0; i < entities.size(); i++) {
+                        items.push_back(BulkItem{bulkKey(boundingBoxes[i]), i});
+                    }
+
+                    std::sort(items.begin(), items.end());
+
+                    std::vector<Location> locations(entities.size());
+                    _build(0, _level, 0, items.begin(), items.end(), entities, boundingBoxes, locations);
+
+                    // Fill the side table in the original order, the ID's are mostly sequential which keeps
+                    // the hash table access local
+                    _locations.reserve(entities.size());
+
+                    for (unsigned int i = 0; i < entities.size(); i++) {
+                        locations[i].entity = entities[i];
+                        _locations.emplace(entities[i]->id(), locations[i]);
+                    }
+
+                    // The same ID was found more than once, let insert decide which one is kept
+                    if (_locations.size() != entities.size()) {
+                        clear();
+
+                        for (const auto& entity : entities) {
+                            insert(entity);
+                        }
+                    }
+
+                    _changes = 0;
+                }
+
+                void _build(unsigned int node, short level, short depth,
+                            typename std::vector<BulkItem>::const_iterator first,
+                            typename std::vector<BulkItem>::const_iterator last,
+                            const std::vector<E>& entities, const std::vector<geo::Area>& boundingBoxes,
+                            std::vector<Location>& locations) {
+                    if (last - first >= _maxObjects && level < _maxLevels && depth < BULK_DEPTH) {
+                        // Entities that stay in this node are sorted before the entities of the quadrants
+                        auto begin = first;
+                        while (begin != last && bulkDigit(begin->key, depth) == 0) {
+                            begin++;
+                        }
+
+                        if (begin != last) {
+                            const int firstChild = allocateChildren(node);
+                            const auto staying = begin;
+
+                            for (int i = 0; i < 4; i++) {
+                                auto end = begin;
+                                while (end != last && bulkDigit(end->key, depth) == i + 1) {
+                                    end++;
+                                }
+
+                                _build(firstChild + i, level + 1, depth + 1, begin, end, entities, boundingBoxes, locations);
+                                begin = end;
+                            }
+
+                            last = staying;
+                        }
+                    }
+
+                    auto& n = _nodes[node];
+                    n.reserve(last - first);
+
+                    for (auto it = first; it != last; it++) {
+                        locations[it->index].node = node;
+                        locations[it->index].slot = n.objects.size();
+                        n.add(entities[it->index], boundingBoxes[it->index]);
+                    }
+                }
+
+                /**
+                 * Calculate the path of quadrants leading to the deepest node a bounding box fits in
+                 */
+                uint64_t bulkKey(const geo::Area& boundingBox) const {
+                    uint64_t key = 0;
+                    double minX = _nodes[0].minX;
+                    double minY = _nodes[0].minY;
+                    double maxX = _nodes[0].maxX;
+                    double maxY = _nodes[0].maxY;
+
+                    for (short depth = 0; depth < BULK_DEPTH && _level + depth < _maxLevels; depth++) {
+                        const Node cell(minX, minY, maxX, maxY);
+                        const short index = quadrantIndex(cell, boundingBox);
+
+                        if (index == -1) {
+                            break;
+                        }
+
+                        key |= ((uint64_t) index + 1) << (3 * (BULK_DEPTH - 1 - depth));
+                        childBounds(index, cell.verticalMidpoint, cell.horizontalMidpoint, minX, minY, maxX, maxY);
+                    }
+
+                    return key;
+                }
+
+                static int bulkDigit(uint64_t key, short depth) {
+                    return (key >> (3 * (BULK_DEPTH - 1 - depth))) & 7;
+                }
+
+                /**
+                 * @brief grow
+                 * Make sure the root contains a given area.
+                 * A root without children simply gets new bounds, otherwise the root gets doubled in the direction
+                 * of the area until it fits, with the old root becoming one of the quadrants of the new root.
+                 * The maximum level is increased at the same time, so the smallest nodes keep their size.
+                 * @param empty true when the tree doesn't contain any other entity
+                 */
+                void grow(const geo::Area& area, bool empty) {
+                    if (!isFinite(area) || (!empty && contains(_nodes[0], area))) {
+                        return;
+                    }
+
+                    if (_nodes[0].firstChild == -1) {
+                        fit(empty ? area : area.merge(_nodes[0].bounds()));
+                        return;
+                    }
+
+                    while (!contains(_nodes[0], area)) {
+                        Node& root = _nodes[0];
+                        const double width = root.maxX - root.minX;
+                        const double height = root.maxY - root.minY;
+                        const bool left = area.minP().x() < root.minX;
+                        const bool down = area.minP().y() < root.minY;
+
+                        // Use the exact bounds of the old root as midpoints, it becomes one of the quadrants
+                        const double verticalMidpoint = left ? root.minX : root.maxX;
+                        const double horizontalMidpoint = down ? root.minY : root.maxY;
+
+                        // Entities of the old root stay in the root
+                        root.setBounds(left ? root.minX - width : root.minX,
+                                       down ? root.minY - height : root.minY,
+                                       left ? root.maxX : root.maxX + width,
+                                       down ? root.maxY : root.maxY + height);
+                        root.verticalMidpoint = verticalMidpoint;
+                        root.horizontalMidpoint = horizontalMidpoint;
+
+                        const int oldChildren = root.firstChild;
+                        const int firstChild = allocateChildren(0);
+                        const int oldRoot = firstChild + (left ? (down ? 0 : 3) : (down ? 1 : 2));
+                        _nodes[oldRoot].firstChild = oldChildren;
+
+                        for (int i = 0; i < 4; i++) {
+                            _nodes[oldChildren + i].parent = oldRoot;
+                        }
+
+                        if (_maxLevels < BULK_DEPTH) {
+                            _maxLevels++;
+                        }
+                    }
+                }
+
+                /**
+                 * @brief fit
+                 * Set the bounds of a root without children to a square around a area.
+                 * A small margin is added so entities on the border of the area can still be moved down.
+                 */
+                void fit(const geo::Area& area) {
+                    double size = std::max(area.width(), area.height());
+
+                    if (size <= 0.) {
+                        size = 1.;
+                    }
+
+                    const double half = size * 0.51;
+                    const double centerX = area.minP().x() + area.width() / 2.;
+                    const double centerY = area.minP().y() + area.height() / 2.;
+
+                    _nodes[0].setBounds(centerX - half, centerY - half, centerX + half, centerY + half);
+                }
+
+                static bool isFinite(const geo::Area& area) {
+                    return std::isfinite(area.minP().x()) && std::isfinite(area.minP().y()) &&
+                           std::isfinite(area.maxP().x()) && std::isfinite(area.maxP().y());
+                }
+
+                /**
+                 * This if a area is completely inside a node
+                 */
+                static bool contains(const Node& node, const geo::Area& area) {
+                    return area.minP().x() >= node.minX &&
+                           area.maxP().x() <= node.maxX &&
+                           area.minP().y() >= node.minY &&
+                           area.maxP().y() <= node.maxY;
+                }
+
+                void _retrieve(std::vector<E>& list, unsigned int node, short level, const short maxLevel) const {
+                    const Node& n = _nodes[node];
+
+                    if (n.firstChild != -1 && maxLevel > level) {
+                        for (int i = 0; i < 4; i++) {
+                            _retrieve(list, n.firstChild + i, level + 1, maxLevel);
+                        }
+                    }
+
+                    list.insert(list.end(), n.objects.begin(), n.objects.end());
+                }
+
+                template<typename T>
+                void _visit(unsigned int node, short level, const geo::Area& area, T& func, const short maxLevel) const {
+                    const Node& n = _nodes[node];
+
+                    if (n.firstChild != -1 && maxLevel > level) {
+                        for (int i = 0; i < 4; i++) {
+                            if (includes(_nodes[n.firstChild + i], area)) {
+                                _visit(n.firstChild + i, level + 1, area, func, maxLevel);
+                            }
+                        }
+                    }
+
+                    for (const E& object : n.objects) {
+                        func(object);
+                    }
+                }
+
+                template<typename T>
+                void _visitOverlapping(unsigned int node, short level, const geo::Area& area, T& func,
+                                       const short maxLevel) const {
+                    const Node& n = _nodes[node];
+
+                    if (n.firstChild != -1 && maxLevel > level) {
+                        for (int i = 0; i < 4; i++) {
+                            if (includes(_nodes[n.firstChild + i], area)) {
+                                _visitOverlapping(n.firstChild + i, level + 1, area, func, maxLevel);
+                            }
+                        }
+                    }
+
+                    unsigned char overlapping[OVERLAP_BATCH];
+
+                    for (unsigned int first = 0; first < n.objects.size(); first += OVERLAP_BATCH) {
+                        const unsigned int remaining = n.objects.size() - first;
+                        const unsigned int count = remaining < OVERLAP_BATCH ? remaining : OVERLAP_BATCH;
+                        overlapBatch(n, first, count, area, overlapping);
+
+                        for (unsigned int i = 0; i < count; i++) {
+                            if (overlapping[i]) {
+                                func(n.objects[first + i], n.objectBoundingBox(first + i));
+                            }
+                        }
+                    }
+                }
+
+                template<typename T>
+                void _visitCulled(unsigned int node, short level, const geo::Area& area, T& func,
+                                  const short maxLevel) const {
+                    const Node& n = _nodes[node];
+
+                    if (level > maxLevel) {
+                        const E* representative = _firstObject(node);
+
+                        if (representative != nullptr) {
+                            func(*representative, n.bounds());
+                        }
+                        return;
+                    }
+
+                    if (n.firstChild != -1) {
+                        for (int i = 0; i < 4; i++) {
+                            if (includes(_nodes[n.firstChild + i], area)) {
+                                _visitCulled(n.firstChild + i, level + 1, area, func, maxLevel);
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * First object found within a node or its children, nullptr when the node is empty
+                 */
+                const E* _firstObject(unsigned int node) const {
+                    const Node& n = _nodes[node];
+
+                    if (!n.objects.empty()) {
+                        return &n.objects.front();
+                    }
+
+                    if (n.firstChild != -1) {
+                        for (int i = 0; i < 4; i++) {
+                            const E* object = _firstObject(n.firstChild + i);
+
+                            if (object != nullptr) {
+                                return object;
+                            }
+                        }
+                    }
+
+                    return nullptr;
+                }
+
+                /**
+                 * Distance between a point and a box, 0 when the point is inside the box
+                 */
+                static double boxDistance(const geo::Coordinate& point, double minX, double minY, double maxX, double maxY) {
+                    const double dx = std::max(std::max(minX - point.x(), point.x() - maxX), 0.);
+                    const double dy = std::max(std::max(minY - point.y(), point.y() - maxY), 0.);
+                    return std::sqrt(dx * dx + dy * dy);
+                }
+
+                /**
+                 * Test a batch of objects of a node for overlap with area
+                 * This is a branch free loop over the bounding box arrays, which allows the compiler to vectorise it
+                 */
+                static void overlapBatch(const Node& node, unsigned int first, unsigned int count,
+                                         const geo::Area& area, unsigned char* result) {
+                    const double minX = area.minP().x();
+                    const double minY = area.minP().y();
+                    const double maxX = area.maxP().x();
+                    const double maxY = area.maxP().y();
+
+                    const double* objectMinX = node.objectMinX() + first;
+                    const double* objectMinY = node.objectMinY() + first;
+                    const double* objectMaxX = node.objectMaxX() + first;
+                    const double* objectMaxY = node.objectMaxY() + first;
+
+                    for (unsigned int i = 0; i < count; i++) {
+                        result[i] = (objectMaxX[i] >= minX) & (objectMinX[i] <= maxX) &
+                                    (objectMaxY[i] >= minY) & (objectMinY[i] <= maxY);
+                    }
+                }
+
+                void _walkQuad(unsigned int node, const std::function<void(const Node&)>& func) const {
+                    func(_nodes[node]);
+
+                    if (_nodes[node].firstChild != -1) {
+                        for (int i = 0; i < 4; i++) {
+                            _walkQuad(_nodes[node].firstChild + i, func);
+                        }
+                    }
+                }
+
+                /**
+                 * @brief collapse
+                 * Remove the children of a node when they are all empty, and repeat for the parent when the node
+                 * itself becomes a empty leaf. Nodes which were already released are ignored
+                 */
+                void collapse(unsigned int node) {
+                    if (!used(node)) {
+                        return;
+                    }
+
+                    while (true) {
+                        Node& n = _nodes[node];
+
+                        if (n.firstChild != -1) {
+                            for (int i = 0; i < 4; i++) {
+                                const Node& child = _nodes[n.firstChild + i];
+
+                                if (child.firstChild != -1 || !child.objects.empty()) {
+                                    return;
+                                }
+                            }
+
+                            _freeBlocks.push_back(n.firstChild);
+                            n.firstChild = -1;
+                        }
+
+                        if (n.parent == -1 || !n.objects.empty()) {
+                            return;
+                        }
+
+                        node = n.parent;
+                    }
+                }
+
+                /**
+                 * Test if a node is part of the tree, and not in a block on the free list
+                 */
+                bool used(unsigned int node) const {
+                    const int parent = _nodes[node].parent;
+
+                    if (parent == -1) {
+                        return node == 0;
+                    }
+
+                    const int firstChild = _nodes[parent].firstChild;
+                    return firstChild != -1 && (int) node >= firstChild && (int) node < firstChild + 4;
+                }
+
+                /**
+                * @brief quadrantIndex
+                * located a possible quadrant index
+                * @param pRect
+                * @return -1 if it doesn't fit in any of the quadrants
+                */
+                static short quadrantIndex(const Node& node, const geo::Area& pRect) {
+                    bool topQuadrant = (pRect.minP().y() >= node.horizontalMidpoint) &&
+                                       (pRect.maxP().y() < node.maxY);
+                    bool bottomQuadrant = (pRect.minP().y() > node.minY) &&
+                                          (pRect.maxP().y() <= node.horizontalMidpoint);
+
+                    if (!(topQuadrant || bottomQuadrant)) {
+                        return -1;
+                    }
+
+                    bool leftQuadrant = (pRect.minP().x() > node.minX) &&
+                                        (pRect.maxP().x() <= node.verticalMidpoint);
+                    bool rightQuandrant = (pRect.minP().x() >= node.verticalMidpoint) &&
+                                          (pRect.maxP().x() < node.maxX);
+
+                    if (!(leftQuadrant || rightQuandrant)) {
+                        return -1;
+                    } else if (topQuadrant && rightQuandrant) {
+                        return 0;
+                    } else if (topQuadrant && leftQuadrant) {
+                        return 1;
+                    } else if (bottomQuadrant && leftQuadrant) {
+                        return 2;
+                    }
+
+                    return 3;
+                }
+
+                /**
+                * This if a node overlaps or includes a given area
+                */
+                static bool includes(const Node& node, const geo::Area& area) {
+                    return !(area.maxP().x() <= node.minX ||
+                             area.minP().x() >= node.maxX ||
+                             area.maxP().y() <= node.minY ||
+                             area.minP().y() >= node.maxY);
+                }
+
+                /**
+                 * Calculate the bounds of a quadrant, given the bounds and midpoints of it's parent
+                 */
+                static void childBounds(int index, double midX, double midY,
+                                        double& minX, double& minY, double& maxX, double& maxY) {
+                    switch (index) {
+                        case 0:
+                            minX = midX;
+                            minY = midY;
+                            break;
+                        case 1:
+                            maxX = midX;
+                            minY = midY;
+                            break;
+                        case 2:
+                            maxX = midX;
+                            maxY = midY;
+                            break;
+                        default:
+                            minX = midX;
+                            maxY = midY;
+                            break;
+                    }
+                }
+
+                /**
+                 * @brief allocateChildren
+                 * Create 4 new empty quads below a node, re-using a free block when possible
+                 * @return index of the first child
+                 */
+                int allocateChildren(unsigned int node) {
+                    int firstChild;
+
+                    if (_freeBlocks.empty()) {
+                        firstChild = _nodes.size();
+                    } else {
+                        firstChild = _freeBlocks.back();
+                        _freeBlocks.pop_back();
+                    }
+
+                    for (int i = 0; i < 4; i++) {
+                        double minX = _nodes[node].minX;
+                        double minY = _nodes[node].minY;
+                        double maxX = _nodes[node].maxX;
+                        double maxY = _nodes[node].maxY;
+                        childBounds(i, _nodes[node].verticalMidpoint, _nodes[node].horizontalMidpoint,
+                                    minX, minY, maxX, maxY);
+
+                        if (firstChild + i < (int) _nodes.size()) {
+                            _nodes[firstChild + i] = Node(minX, minY, maxX, maxY);
+                        } else {
+                            _nodes.emplace_back(minX, minY, maxX, maxY);
+                        }
+
+                        _nodes[firstChild + i].parent = node;
+                    }
+
+                    _nodes[node].firstChild = firstChild;
+                    return firstChild;
+                }
+
+                /**
+                 * @brief split
+                 * Create 4 new quads below a node and move down all entities that fit in one of them
+                 * Children that end up full get split as well
+                 */
+                void split(unsigned int node, short level) {
+                    const int firstChild = allocateChildren(node);
+
+                    // Move each entity that fits in a quadrant one level down
+                    Node& parent = _nodes[node];
+
+                    for (unsigned int slot = 0; slot < parent.objects.size();) {
+                        const auto boundingBox = parent.objectBoundingBox(slot);
+                        short index = quadrantIndex(parent, boundingBox);
+
+                        if (index == -1) {
+                            slot++;
+                            continue;
+                        }
+
+                        // Only the node and slot change, the entity in the side table stays the same
+                        Node& child = _nodes[firstChild + index];
+                        Location& location = _locations[parent.objects[slot]->id()];
+                        location.node = firstChild + index;
+                        location.slot = child.objects.size();
+                        child.add(parent.objects[slot], boundingBox);
+                        parent.remove(slot);
+
+                        if (slot < parent.objects.size()) {
+                            _locations[parent.objects[slot]->id()].slot = slot;
+                        }
+                    }
+
+                    if (level + 1 < _maxLevels) {
+                        for (int i = 0; i < 4; i++) {
+                            if (_nodes[firstChild + i].objects.size() >= _maxObjects) {
+                                split(firstChild + i, level + 1);
+                            }
+                        }
+                    }
+                }
+
             private:
-                // used as a cache on root level
-                // This will allow is to quickly lookup a CAD entity from the root
-                // SHould we consider using https://github.com/attractivechaos/klib I didn't do integer testing but this lib seems faster
-                std::unordered_map<ID_DATATYPE, const E> _cadentities;
+                short _level;
+                unsigned short _maxLevels;
+                unsigned short _maxObjects;
+
+                // Arena containing all nodes, the root node is always located at index 0
+                std::vector<Node> _nodes;
+                // Blocks of 4 nodes that are not used any more and can be re-used during split
+                std::vector<int> _freeBlocks;
+                // Nodes left without objects by erase, optimise starts from these nodes
+                std::vector<unsigned int> _dirtyNodes;
+                // Number of inserted and erased entities since the tree was build
+                size_t _changes;
+
+                // Maps each entity ID to the node and slot where it's stored
+                std::unordered_map<ID_DATATYPE, Location> _locations;
         };
     }
 }
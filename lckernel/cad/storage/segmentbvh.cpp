@@ -0,0 +1,87 @@
+#include "segmentbvh.h"
+
+using namespace lc::storage;
+
+const unsigned int SegmentBVH::MAXIMUM_LEAF_SIZE;
+
+SegmentBVH::SegmentBVH(const std::vector<geo::Area>& boxes) {
+    if (boxes.empty()) {
+        return;
+    }
+
+    _indices.resize(boxes.size());
+    for (unsigned int i = 0; i < _indices.size(); i++) {
+        _indices[i] = i;
+    }
+
+    // A binary tree with leafs of at least MAXIMUM_LEAF_SIZE / 2 segments
+    _nodes.reserve(4 * boxes.size() / MAXIMUM_LEAF_SIZE + 1);
+    _nodes.emplace_back();
+    build(0, 0, (unsigned int) _indices.size(), boxes);
+
+    _minX.reserve(_indices.size());
+    _minY.reserve(_indices.size());
+    _maxX.reserve(_indices.size());
+    _maxY.reserve(_indices.size());
+    for (auto index : _indices) {
+        _minX.push_back(boxes[index].minP().x());
+        _minY.push_back(boxes[index].minP().y());
+        _maxX.push_back(boxes[index].maxP().x());
+        _maxY.push_back(boxes[index].maxP().y());
+    }
+}
+
+void SegmentBVH::build(unsigned int node, unsigned int begin, unsigned int end, const std::vector<geo::Area>& boxes) {
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+
+    // Bounds of the centers, used to choose the axis to split
+    double centerMinX = std::numeric_limits<double>::max();
+    double centerMinY = std::numeric_limits<double>::max();
+    double centerMaxX = std::numeric_limits<double>::lowest();
+    double centerMaxY = std::numeric_limits<double>::lowest();
+
+    for (unsigned int i = begin; i < end; i++) {
+        const auto& box = boxes[_indices[i]];
+        minX = std::min(minX, box.minP().x());
+        minY = std::min(minY, box.minP().y());
+        maxX = std::max(maxX, box.maxP().x());
+        maxY = std::max(maxY, box.maxP().y());
+
+        const double centerX = (box.minP().x() + box.maxP().x()) / 2.;
+        const double centerY = (box.minP().y() + box.maxP().y()) / 2.;
+        centerMinX = std::min(centerMinX, centerX);
+        centerMinY = std::min(centerMinY, centerY);
+        centerMaxX = std::max(centerMaxX, centerX);
+        centerMaxY = std::max(centerMaxY, centerY);
+    }
+
+    _nodes[node] = {minX, minY, maxX, maxY, begin, end - begin};
+
+    if (end - begin <= MAXIMUM_LEAF_SIZE) {
+        return;
+    }
+
+    // Split at the median center along the longest axis
+    const bool splitX = centerMaxX - centerMinX >= centerMaxY - centerMinY;
+    const unsigned int middle = begin + (end - begin) / 2;
+
+    std::nth_element(_indices.begin() + begin, _indices.begin() + middle, _indices.begin() + end,
+                     [&boxes, splitX](unsigned int a, unsigned int b) {
+        if (splitX) {
+            return boxes[a].minP().x() + boxes[a].maxP().x() < boxes[b].minP().x() + boxes[b].maxP().x();
+        }
+        return boxes[a].minP().y() + boxes[a].maxP().y() < boxes[b].minP().y() + boxes[b].maxP().y();
+    });
+
+    const auto children = (unsigned int) _nodes.size();
+    _nodes[node].first = children;
+    _nodes[node].count = 0;
+    _nodes.emplace_back();
+    _nodes.emplace_back();
+
+    build(children, begin, middle, boxes);
+    build(children + 1, middle, end, boxes);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "cad/const.h"
+#include "cad/geometry/geoarea.h"
+#include "cad/geometry/geocoordinate.h"
+
+namespace lc {
+    namespace storage {
+        /**
+         * @brief The SegmentBVH class
+         * Bounding volume hierarchy over the segments of a single entity, for example the segments
+         * of a LWPolyline or the beziers of a Spline.
+         * The hierarchy is built once from the bounding boxes of the segments and never modified,
+         * so entities with the same geometry can share it. Segments are referred to by their index
+         * in the vector of boxes given to the constructor.
+         */
+        class SegmentBVH {
+            public:
+                /**
+                 * @brief Maximum number of segments in a leaf
+                 */
+                static const unsigned int MAXIMUM_LEAF_SIZE = 4;
+
+                /**
+                 * @param boxes bounding box of each segment
+                 */
+                explicit SegmentBVH(const std::vector<geo::Area>& boxes);
+
+                /**
+                 * @return number of segments
+                 */
+                size_t size() const {
+                    return _indices.size();
+                }
+
+                /**
+                 * @brief visitOverlapping
+                 * Call func(size_t index) for each segment with a bounding box overlapping area
+                 */
+                template<typename T>
+                void visitOverlapping(const geo::Area& area, T func) const {
+                    if (_nodes.empty()) {
+                        return;
+                    }
+
+                    const double minX = area.minP().x();
+                    const double minY = area.minP().y();
+                    const double maxX = area.maxP().x();
+                    const double maxY = area.maxP().y();
+
+                    std::vector<unsigned int> stack{0};
+                    while (!stack.empty()) {
+                        const Node& node = _nodes[stack.back()];
+                        stack.pop_back();
+
+                        if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) {
+                            continue;
+                        }
+
+                        if (node.count == 0) {
+                            stack.push_back(node.first);
+                            stack.push_back(node.first + 1);
+                            continue;
+                        }
+
+                        for (unsigned int i = node.first; i < node.first + node.count; i++) {
+                            if (!(_maxX[i] < minX || _minX[i] > maxX || _maxY[i] < minY || _minY[i] > maxY)) {
+                                func((size_t) _indices[i]);
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * @brief nearest
+                 * Find the segment closest to point, using a best-first traversal of the hierarchy.
+                 * distance is called as distance(size_t index) and must return the distance between point and
+                 * the segment, which can't be smaller than the distance to the bounding box of the segment.
+                 * It's only called for segments which can still be closer than the closest segment found so far.
+                 * @return index of the closest segment and its distance, or size() and infinity when empty
+                 */
+                template<typename T>
+                std::pair<size_t, double> nearest(const geo::Coordinate& point, T distance) const {
+                    std::pair<size_t, double> result(size(), std::numeric_limits<double>::infinity());
+
+                    if (_nodes.empty()) {
+                        return result;
+                    }
+
+                    using Item = std::pair<double, unsigned int>;
+                    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+                    queue.emplace(boxDistance(point, _nodes[0].minX, _nodes[0].minY, _nodes[0].maxX, _nodes[0].maxY), 0);
+
+                    while (!queue.empty() && queue.top().first < result.second) {
+                        const Node& node = _nodes[queue.top().second];
+                        queue.pop();
+
+                        if (node.count == 0) {
+                            for (unsigned int child = node.first; child < node.first + 2; child++) {
+                                const Node& c = _nodes[child];
+                                const double d = boxDistance(point, c.minX, c.minY, c.maxX, c.maxY);
+
+                                if (d < result.second) {
+                                    queue.emplace(d, child);
+                                }
+                            }
+                            continue;
+                        }
+
+                        for (unsigned int i = node.first; i < node.first + node.count; i++) {
+                            if (boxDistance(point, _minX[i], _minY[i], _maxX[i], _maxY[i]) >= result.second) {
+                                continue;
+                            }
+
+                            const double d = distance((size_t) _indices[i]);
+                            if (d < result.second) {
+                                result = std::make_pair((size_t) _indices[i], d);
+                            }
+                        }
+                    }
+
+                    return result;
+                }
+
+            private:
+                struct Node {
+                    double minX;
+                    double minY;
+                    double maxX;
+                    double maxY;
+                    // Leaf: range of _indices, other nodes have a count of 0 and their children at first and first + 1
+                    unsigned int first;
+                    unsigned int count;
+                };
+
+                void build(unsigned int node, unsigned int begin, unsigned int end,
+                           const std::vector<geo::Area>& boxes);
+
+                static double boxDistance(const geo::Coordinate& point, double minX, double minY, double maxX, double maxY) {
+                    const double dx = std::max(std::max(minX - point.x(), 0.), point.x() - maxX);
+                    const double dy = std::max(std::max(minY - point.y(), 0.), point.y() - maxY);
+                    return std::sqrt(dx * dx + dy * dy);
+                }
+
+                std::vector<Node> _nodes;
+                std::vector<unsigned int> _indices;
+
+                // Bounding boxes of the segments, in order of _indices
+                std::vector<double> _minX;
+                std::vector<double> _minY;
+                std::vector<double> _maxX;
+                std::vector<double> _maxY;
+        };
+
+        DECLARE_SHORT_SHARED_PTR(SegmentBVH)
+
+        /**
+         * @brief The LazySegmentBVH class
+         * SegmentBVH of an entity, built on first use.
+         * Copies share the hierarchy, also when it's built after the copy was made, so an entity copied
+         * with the same geometry, for example by modify(), builds it only once.
+         * Building is thread safe.
+         */
+        class LazySegmentBVH {
+            public:
+                LazySegmentBVH() :
+                        _state(std::make_shared<State>()) {
+                }
+
+                /**
+                 * @brief Return the hierarchy, building it from boxes() when it doesn't exist yet
+                 * @param boxes function returning the bounding box of each segment as std::vector<geo::Area>
+                 */
+                template<typename T>
+                const SegmentBVH& get(T boxes) const {
+                    std::call_once(_state->built, [this, &boxes]() {
+                        _state->bvh.reset(new SegmentBVH(boxes()));
+                    });
+
+                    return *_state->bvh;
+                }
+
+            private:
+                struct State {
+                    std::once_flag built;
+                    std::unique_ptr<const SegmentBVH> bvh;
+                };
+
+                std::shared_ptr<State> _state;
+        };
+    }
+}
@@ -17,6 +17,8 @@ namespace lc {
             public:
                 virtual void insertEntity(entity::CADEntity_CSPtr) = 0;
 
+                virtual void insertEntities(const std::vector<entity::CADEntity_CSPtr>&) = 0;
+
                 virtual void insertEntityContainer(const EntityContainer <entity::CADEntity_CSPtr>&) = 0;
 
                 virtual void removeEntity(entity::CADEntity_CSPtr) = 0;
@@ -79,9 +81,17 @@ namespace lc {
                 /**
                  * @brief optimise
                  * the underlaying data store. Run this at a regular base, for example after each task
+                 * Only the parts changed since the last call are optimised
                  */
                 virtual void optimise() = 0;
 
+                /**
+                 * @brief rebalance
+                 * the underlaying data store when a large part of it changed.
+                 * This can visit all entities, run it when the application is idle
+                 */
+                virtual void rebalance() = 0;
+
 
                 template<typename T>
                 const std::shared_ptr<const T> metaDataTypeByName(const std::string& name) const {
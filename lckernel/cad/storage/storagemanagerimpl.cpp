@@ -28,6 +28,22 @@ void StorageManagerImpl::insertEntity(entity::CADEntity_CSPtr entity) {
     }
 }
 
+void StorageManagerImpl::insertEntities(const std::vector<entity::CADEntity_CSPtr>& entities) {
+    std::vector<entity::CADEntity_CSPtr> documentEntities;
+    documentEntities.reserve(entities.size());
+
+    for (const auto& entity : entities) {
+        if (entity->block() != nullptr) {
+            insertEntity(entity);
+        }
+        else {
+            documentEntities.push_back(entity);
+        }
+    }
+
+    _entities.insert(documentEntities);
+}
+
 void StorageManagerImpl::removeEntity(entity::CADEntity_CSPtr entity) {
     _entities.remove(entity);
 }
@@ -71,11 +87,18 @@ EntityContainer<entity::CADEntity_CSPtr> & StorageManagerImpl::entityContainer()
 
 void StorageManagerImpl::optimise() {
     _entities.optimise();
-    for (auto ec : _blocksEntities) {
+    for (auto& ec : _blocksEntities) {
         ec.second.optimise();
     }
 }
 
+void StorageManagerImpl::rebalance() {
+    _entities.rebalance();
+    for (auto& ec : _blocksEntities) {
+        ec.second.rebalance();
+    }
+}
+
 
 void StorageManagerImpl::addDocumentMetaType(meta::DocumentMetaType_CSPtr dmt) {
     _documentMetaData.emplace(std::make_pair(dmt->id(), dmt));
@@ -42,6 +42,13 @@ namespace lc {
                  */
                 void insertEntity(entity::CADEntity_CSPtr) override;
 
+                /**
+                 * @brief insertEntities
+                 * Insert a large number of entities, the spatial index is build in a single pass
+                 * \param entities
+                 */
+                void insertEntities(const std::vector<entity::CADEntity_CSPtr>& entities) override;
+
                 /**
                  * @brief remove Entity from the container
                  * \param entity::CADEntity_CSPtr
@@ -121,6 +128,11 @@ namespace lc {
                  */
                 void optimise() override;
 
+                /**
+                 * @brief rebalance the quadtree
+                 */
+                void rebalance() override;
+
             private:
                 meta::DocumentMetaType_CSPtr _metaDataTypeByName(const std::string& id) const override;
 
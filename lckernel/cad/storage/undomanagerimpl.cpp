@@ -6,8 +6,12 @@
 
 using namespace lc::storage;
 
-UndoManagerImpl::UndoManagerImpl(unsigned int maximumUndoLevels) :
-        _maximumUndoLevels(maximumUndoLevels) {
+const size_t UndoManagerImpl::DEFAULT_MAXIMUM_UNDO_SIZE = 512 * 1024 * 1024;
+
+UndoManagerImpl::UndoManagerImpl(unsigned int maximumUndoLevels, size_t maximumUndoSize) :
+        _maximumUndoLevels(maximumUndoLevels),
+        _maximumUndoSize(maximumUndoSize),
+        _memorySize(0) {
 
 }
 
@@ -18,24 +22,30 @@ void UndoManagerImpl::on_CommitProcessEvent(const event::CommitProcessEvent& eve
     if (undoable != nullptr) {
         // // LOG4CXX_DEBUG(logger, "Process: " + undoable->text());
 
-        // Check if Redo is possible, if so we might need to purge objects from memory
-        // as long as we can redo, purge these objects
-        while (canRedo()) {
-            operation::Undoable_SPtr undoable = _reDoables.top();
-            _reDoables.pop();
-            // Need to get a list of absolute entities, they are all entities that are created in the _reDoables list
-            // document()->absolueteEntity(entity);
-        }
+        // The operations which were undone can't be redone anymore
+        clearRedo();
 
         // Add undoable to stack
         _unDoables.push_back(undoable);
+        _memorySize += undoable->memorySize();
 
         // Remove old undoables
-        if (_unDoables.size() > this->_maximumUndoLevels) {
-            // Need to get a list of absolute entities, they are all entities that are deleted in the _unDoables list
-            // document()->absolueteEntity(entity);
-            _unDoables.erase(_unDoables.begin(), _unDoables.begin() + 1);
-        }
+        trim();
+    }
+}
+
+void UndoManagerImpl::trim() {
+    while (!_unDoables.empty() &&
+           (_unDoables.size() > _maximumUndoLevels || (_memorySize > _maximumUndoSize && _unDoables.size() > 1))) {
+        _memorySize -= _unDoables.front()->memorySize();
+        _unDoables.pop_front();
+    }
+}
+
+void UndoManagerImpl::clearRedo() {
+    while (!_reDoables.empty()) {
+        _memorySize -= _reDoables.top()->memorySize();
+        _reDoables.pop();
     }
 }
 
@@ -70,4 +80,10 @@ void UndoManagerImpl::removeUndoables() {
     while (!_reDoables.empty()) {
         _reDoables.pop();
     }
+
+    _memorySize = 0;
+}
+
+size_t UndoManagerImpl::memorySize() const {
+    return _memorySize;
 }
@@ -1,7 +1,7 @@
 #pragma once
 
+#include <deque>
 #include <stack>
-#include <vector>
 
 #include "cad/const.h"
 
@@ -15,11 +15,19 @@ namespace lc {
         /**
          * UndoManagerImpl manages a stack of operations and allows for
          * undo or re-do operations that where done on a canvas
+         * The oldest operations are dropped when there are more than maximumUndoLevels operations, or when the
+         * operations use more than maximumUndoSize bytes. The last operation is always kept.
          * @param maximumUndoLevels
+         * @param maximumUndoSize
          */
         class UndoManagerImpl : public UndoManager {
             public:
-                UndoManagerImpl(unsigned int maximumUndoLevels);
+                /**
+                 * @brief Default maximum memory used by the undo and redo operations, in bytes
+                 */
+                static const size_t DEFAULT_MAXIMUM_UNDO_SIZE;
+
+                UndoManagerImpl(unsigned int maximumUndoLevels, size_t maximumUndoSize = DEFAULT_MAXIMUM_UNDO_SIZE);
 
                 virtual ~UndoManagerImpl() = default;
 
@@ -66,10 +74,26 @@ namespace lc {
                  */
                 virtual void removeUndoables();
 
+                /*!
+                 * \brief Estimated memory used by the undo and redo operations
+                 * \sa lc::operation::Undoable::memorySize
+                 * \return number of bytes
+                 */
+                size_t memorySize() const;
+
             private:
-                std::vector<operation::Undoable_SPtr> _unDoables; /*!< Undo list */
+                /*!
+                 * \brief Drop the oldest operations until the limits are respected
+                 */
+                void trim();
+
+                void clearRedo();
+
+                std::deque<operation::Undoable_SPtr> _unDoables; /*!< Undo list */
                 std::stack<operation::Undoable_SPtr> _reDoables; /*!< Redo stack */
                 const unsigned int _maximumUndoLevels; /*!< Maximum undo level */
+                const size_t _maximumUndoSize; /*!< Maximum memory used by the operations */
+                size_t _memorySize; /*!< Memory used by the undo and redo operations */
 
             public:
                 void on_CommitProcessEvent(const lc::event::CommitProcessEvent& event);
@@ -0,0 +1,83 @@
+#include "blockdrawlist.h"
+#include "documentcanvas.h"
+#include "drawitems/lcvinsert.h"
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/meta/dxflinepattern.h>
+#include <algorithm>
+
+using namespace lc::viewer;
+
+namespace {
+    bool isByBlock(const lc::entity::CADEntity_CSPtr& entity) {
+        return std::dynamic_pointer_cast<const lc::meta::MetaColorByBlock>(
+                       entity->metaInfo<lc::meta::MetaColor>(lc::meta::MetaColor::LCMETANAME())) != nullptr ||
+               std::dynamic_pointer_cast<const lc::meta::MetaLineWidthByBlock>(
+                       entity->metaInfo<lc::meta::MetaLineWidth>(lc::meta::MetaLineWidth::LCMETANAME())) != nullptr ||
+               std::dynamic_pointer_cast<const lc::meta::DxfLinePatternByBlock>(
+                       entity->metaInfo<lc::meta::DxfLinePattern>(lc::meta::DxfLinePattern::LCMETANAME())) != nullptr;
+    }
+}
+
+BlockDrawList::BlockDrawList(const lc::storage::Document_SPtr& document, lc::meta::Block_CSPtr block) :
+        _block(std::move(block)),
+        _styleGeneration(0) {
+
+    for (const auto& entity : document->entitiesByBlock(_block).asVector()) {
+        add(entity);
+    }
+}
+
+std::vector<BlockDrawItem>::iterator BlockDrawList::find(ID_DATATYPE id) {
+    return std::lower_bound(_items.begin(), _items.end(), id, [](const BlockDrawItem& item, ID_DATATYPE id) {
+        return item.drawable->entity()->id() < id;
+    });
+}
+
+void BlockDrawList::add(const lc::entity::CADEntity_CSPtr& entity) {
+    auto drawable = DocumentCanvas::asDrawable(entity);
+
+    if (drawable == nullptr) {
+        remove(entity);
+        return;
+    }
+
+    BlockDrawItem item{drawable, dynamic_cast<const LCVInsert*>(drawable.get()), isByBlock(entity)};
+
+    auto it = find(entity->id());
+    if (it != _items.end() && it->drawable->entity()->id() == entity->id()) {
+        *it = std::move(item);
+    }
+    else {
+        _items.insert(it, std::move(item));
+    }
+
+    _styleGeneration = 0;
+}
+
+bool BlockDrawList::remove(const lc::entity::CADEntity_CSPtr& entity) {
+    auto it = find(entity->id());
+
+    if (it == _items.end() || it->drawable->entity()->id() != entity->id()) {
+        return false;
+    }
+
+    _items.erase(it);
+    return true;
+}
+
+const std::vector<BlockDrawItem>& BlockDrawList::items() const {
+    return _items;
+}
+
+const lc::meta::Block_CSPtr& BlockDrawList::block() const {
+    return _block;
+}
+
+unsigned int BlockDrawList::styleGeneration() const {
+    return _styleGeneration;
+}
+
+void BlockDrawList::styleGeneration(unsigned int generation) {
+    _styleGeneration = generation;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cad/meta/block.h>
+#include <cad/storage/document.h>
+#include "drawitems/lcvdrawitem.h"
+
+namespace lc {
+    namespace viewer {
+        class LCVInsert;
+
+        /**
+         * @brief Drawable of an entity of a block
+         */
+        struct BlockDrawItem {
+            LCVDrawItem_SPtr drawable;
+            // Set when the drawable is an insert of another block
+            const LCVInsert* insert;
+            // Set when the style depends on the insert, because the color, line width or line pattern is ByBlock
+            bool byBlock;
+        };
+
+        /**
+         * @brief BlockDrawList
+         * Drawables of the entities of a block, shared by all inserts of the block.
+         * The drawables are created at the position of the entities in the block,
+         * each insert draws them translated to its own position.
+         */
+        class BlockDrawList {
+            public:
+                /**
+                 * @brief Create the drawables of the entities of block in document
+                 */
+                BlockDrawList(const lc::storage::Document_SPtr& document, lc::meta::Block_CSPtr block);
+
+                /**
+                 * @brief Add the drawable of an entity of the block, replacing the drawable with the same ID
+                 */
+                void add(const lc::entity::CADEntity_CSPtr& entity);
+
+                /**
+                 * @brief Remove the drawable with the ID of entity
+                 * @return true when a drawable was removed
+                 */
+                bool remove(const lc::entity::CADEntity_CSPtr& entity);
+
+                /**
+                 * @return Drawables of the block, in order of entity ID
+                 */
+                const std::vector<BlockDrawItem>& items() const;
+
+                const lc::meta::Block_CSPtr& block() const;
+
+                /**
+                 * @brief Style generation of the DocumentCanvas when the styles of the drawables were resolved
+                 * 0 when the styles need to be resolved
+                 */
+                unsigned int styleGeneration() const;
+
+                void styleGeneration(unsigned int generation);
+
+            private:
+                std::vector<BlockDrawItem>::iterator find(ID_DATATYPE id);
+
+                lc::meta::Block_CSPtr _block;
+                std::vector<BlockDrawItem> _items;
+                unsigned int _styleGeneration;
+        };
+
+        DECLARE_SHORT_SHARED_PTR(BlockDrawList)
+    }
+}
@@ -0,0 +1,37 @@
+#include "displaylist.h"
+
+using namespace lc::viewer;
+
+void DisplayList::reset(unsigned int chunks) {
+    if (_chunks.size() < chunks) {
+        _chunks.resize(chunks);
+        _sizes.resize(chunks);
+    }
+
+    for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+        _sizes[chunk] = 0;
+    }
+
+    _chunkCount = chunks;
+}
+
+DisplayItem& DisplayList::append(unsigned int chunk) {
+    auto& items = _chunks[chunk];
+    auto& size = _sizes[chunk];
+
+    if (size == items.size()) {
+        items.emplace_back();
+    }
+
+    return items[size++];
+}
+
+size_t DisplayList::size() const {
+    size_t size = 0;
+
+    for (unsigned int chunk = 0; chunk < _chunkCount; chunk++) {
+        size += _sizes[chunk];
+    }
+
+    return size;
+}
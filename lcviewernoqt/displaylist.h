@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include "drawitems/lcvdrawitem.h"
+
+namespace lc {
+    namespace viewer {
+        /**
+         * @brief Drawable with a resolved style, ready to be replayed into a painter
+         * The drawable and style are not owned, they must stay alive until the list is replayed
+         */
+        struct DisplayItem {
+            const LCVDrawItem* drawable;
+            const DrawStyle* style;
+            bool selected;
+            // Translation applied to the drawable, used to draw the entities of a block at the position of a insert
+            lc::geo::Coordinate offset;
+        };
+
+        /**
+         * @brief DisplayList
+         * Flat list of drawables with a resolved style, build in chunks.
+         * Each chunk can be filled by a different thread, the list is replayed in chunk order.
+         * Items are kept between frames so no allocation is needed once the list is large enough.
+         */
+        class DisplayList {
+            public:
+                DisplayList() = default;
+
+                /**
+                 * @brief Remove all items and prepare a number of chunks
+                 * @param chunks
+                 */
+                void reset(unsigned int chunks);
+
+                /**
+                 * @brief Add a item to the end of a chunk
+                 * Only one thread can append to the same chunk
+                 * @param chunk
+                 * @return item to fill, it may contain the values of a previous frame
+                 */
+                DisplayItem& append(unsigned int chunk);
+
+                /**
+                 * @brief Call func for each item, in order
+                 */
+                template<typename T>
+                void each(T func) const {
+                    for (unsigned int chunk = 0; chunk < _chunkCount; chunk++) {
+                        const auto& items = _chunks[chunk];
+
+                        for (unsigned int i = 0; i < _sizes[chunk]; i++) {
+                            func(items[i]);
+                        }
+                    }
+                }
+
+                /**
+                 * @return number of items in the list
+                 */
+                size_t size() const;
+
+            private:
+                std::vector<std::vector<DisplayItem>> _chunks;
+                std::vector<unsigned int> _sizes;
+                unsigned int _chunkCount = 0;
+        };
+    }
+}
@@ -33,26 +33,45 @@
 #include <cad/meta/metalinewidth.h>
 
 #include <cad/const.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <thread>
 
 #include <typeinfo>
 
 using namespace lc::viewer;
 
+// Number of visible drawables from where it's worth to use a additional thread during render
+static const unsigned int MINIMUM_DRAWABLES_PER_THREAD = 5000;
+
+// Line widths of the entities are multiplied by this factor
+static const double LINE_WIDTH_FACTOR = 1.5;
+
+// Added by the painter to the width of the document lines
+static const double LINE_WIDTH_COMPENSATION = 0.5;
+
 DocumentCanvas::DocumentCanvas(const std::shared_ptr<lc::storage::Document>& document, std::function<void(double*, double*)> deviceToUser) :
         _document(document),
+        _blockDrawListsVersion(1),
         _zoomMin(0.005),
         _zoomMax(200.0),
         _deviceWidth(0),
         _deviceHeight(0),
         _selectedArea(nullptr),
         _selectedAreaIntersects(false),
+        _renderWorkers(std::max(1u, std::thread::hardware_concurrency())),
+        _styleGeneration(1),
+        _maximumLineWidth(0.),
         _deviceToUser(std::move(deviceToUser)) {
 
 
     document->addEntityEvent().connect<DocumentCanvas, &DocumentCanvas::on_addEntityEvent>(this);
     document->removeEntityEvent().connect<DocumentCanvas, &DocumentCanvas::on_removeEntityEvent>(this);
-    document->commitProcessEvent().connect<DocumentCanvas, &DocumentCanvas::on_commitProcessEvent>(this);
+    document->addEntitiesEvent().connect<DocumentCanvas, &DocumentCanvas::on_addEntitiesEvent>(this);
+    document->removeEntitiesEvent().connect<DocumentCanvas, &DocumentCanvas::on_removeEntitiesEvent>(this);
+    document->replaceLayerEvent().connect<DocumentCanvas, &DocumentCanvas::on_replaceLayerEvent>(this);
+    document->replaceLinePatternEvent().connect<DocumentCanvas, &DocumentCanvas::on_replaceLinePatternEvent>(this);
 
     // Render code for selected area
     _selectedAreaPainter = [](LcPainter & painter, lc::geo::Area area , bool occupies) {
@@ -90,7 +109,10 @@ DocumentCanvas::DocumentCanvas(const std::shared_ptr<lc::storage::Document>& doc
 DocumentCanvas::~DocumentCanvas() {
     _document->addEntityEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_addEntityEvent>(this);
     _document->removeEntityEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_removeEntityEvent>(this);
-    _document->commitProcessEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_commitProcessEvent>(this);
+    _document->addEntitiesEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_addEntitiesEvent>(this);
+    _document->removeEntitiesEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_removeEntitiesEvent>(this);
+    _document->replaceLayerEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_replaceLayerEvent>(this);
+    _document->replaceLinePatternEvent().disconnect<DocumentCanvas, &DocumentCanvas::on_replaceLinePatternEvent>(this);
 
     if (_selectedArea != nullptr) {
         delete _selectedArea;
@@ -188,7 +210,11 @@ void DocumentCanvas::render(LcPainter& painter, PainterType type) {
         visibleUserArea = lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
     }
 
-    LcDrawOptions lcDrawOptions;
+    render(painter, type, visibleUserArea);
+}
+
+void DocumentCanvas::render(LcPainter& painter, PainterType type, const lc::geo::Area& visibleUserArea) {
+    const LcDrawOptions& lcDrawOptions = _drawOptions;
     event::DrawEvent drawEvent(painter, lcDrawOptions, visibleUserArea);
 
     switch(type) {
@@ -202,19 +228,109 @@ void DocumentCanvas::render(LcPainter& painter, PainterType type) {
             // Draw Document
             // caller is responsible for clearing    painter.clear(1., 1., 1., 0.);
             painter.source_rgb(1., 1., 1.);
-            painter.lineWidthCompensation(0.5);
+            painter.lineWidthCompensation(LINE_WIDTH_COMPENSATION);
             painter.enable_antialias();
 
-            auto visibleEntities = _document->entityContainer().entitiesWithinAndCrossingAreaFast(visibleUserArea);
-            std::vector<lc::viewer::LCVDrawItem_SPtr> visibleDrawables;
-            visibleEntities.each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-                auto di = _entityDrawItem[entity];
-                visibleDrawables.push_back(di);
-            });
+            // Re-use the list of the previous frame, so no allocation is needed once it's large enough
+            _visibleDrawables.clear();
+            _placeholders.clear();
 
-            for(const auto& di: visibleDrawables) {
-                drawEntity(painter, di);
+            auto addVisible = [&](const lc::entity::CADEntity_CSPtr& entity) {
+                auto di = _entityDrawItem.find(entity);
+                if (di != _entityDrawItem.end()) {
+                    _visibleDrawables.push_back(di->second);
+                }
             };
+
+            if (lcDrawOptions.levelOfDetail() == LOD_NONE) {
+                _document->entityContainer().eachWithinAndCrossingAreaFast(visibleUserArea, addVisible);
+            }
+            else {
+                double minimumSize = lcDrawOptions.levelOfDetailSize();
+                double unused = 0.;
+                painter.device_to_user_distance(&minimumSize, &unused);
+
+                // At most one placeholder per device pixel of the visible area
+                double originX = visibleUserArea.minP().x();
+                double originY = visibleUserArea.minP().y();
+                double cornerX = visibleUserArea.maxP().x();
+                double cornerY = visibleUserArea.maxP().y();
+                painter.user_to_device(&originX, &originY);
+                painter.user_to_device(&cornerX, &cornerY);
+
+                const unsigned int deviceWidth = (unsigned int) std::ceil(std::abs(cornerX - originX));
+                const unsigned int deviceHeight = (unsigned int) std::ceil(std::abs(cornerY - originY));
+                originX = std::min(originX, cornerX);
+                originY = std::min(originY, cornerY);
+
+                if (lcDrawOptions.levelOfDetail() == LOD_PLACEHOLDER) {
+                    _placeholderPixels.assign(deviceWidth * deviceHeight, false);
+                }
+
+                _document->entityContainer().eachWithinAndCrossingAreaDetail(visibleUserArea, minimumSize, addVisible,
+                        [&](const lc::entity::CADEntity_CSPtr& entity, const lc::geo::Area& area) {
+                    if (lcDrawOptions.levelOfDetail() != LOD_PLACEHOLDER) {
+                        return;
+                    }
+
+                    auto center = area.minP().mid(area.maxP());
+                    double x = center.x();
+                    double y = center.y();
+                    painter.user_to_device(&x, &y);
+                    x -= originX;
+                    y -= originY;
+
+                    if (x < 0. || y < 0. || x >= deviceWidth || y >= deviceHeight) {
+                        return;
+                    }
+
+                    const size_t pixel = (size_t) y * deviceWidth + (size_t) x;
+                    if (_placeholderPixels[pixel]) {
+                        return;
+                    }
+
+                    auto di = _entityDrawItem.find(entity);
+                    if (di != _entityDrawItem.end()) {
+                        _placeholderPixels[pixel] = true;
+                        _placeholders.emplace_back(di->second, center);
+                    }
+                });
+            }
+
+            resolveBlockStyles();
+
+            // Resolve the style of all drawables, using multiple threads for large drawings
+            const unsigned int threads = std::max(1u, std::min(_renderWorkers.threads(),
+                    (unsigned int) (_visibleDrawables.size() / MINIMUM_DRAWABLES_PER_THREAD)));
+            _displayList.reset(threads);
+
+            auto resolveChunk = [&](unsigned int chunk) {
+                const size_t begin = _visibleDrawables.size() * chunk / threads;
+                const size_t end = _visibleDrawables.size() * (chunk + 1) / threads;
+
+                for (size_t i = begin; i < end; i++) {
+                    resolve(_displayList, chunk, _visibleDrawables[i].get());
+                }
+            };
+
+            _renderWorkers.run(threads, resolveChunk);
+
+            // Replay in order on this thread
+            _displayList.each([&](const DisplayItem& item) {
+                replay(painter, item, lcDrawOptions, visibleUserArea);
+            });
+
+            // A single point, in the color of one of the culled entities, replaces the entities culled within a pixel
+            for (const auto& placeholder : _placeholders) {
+                const auto& color = placeholder.first->selected() ?
+                                    lcDrawOptions.selectedColor() : resolveStyle(placeholder.first.get(), nullptr).color;
+
+                painter.source_rgba(color.red(), color.green(), color.blue(), color.alpha());
+                painter.point(placeholder.second.x(), placeholder.second.y(), lcDrawOptions.levelOfDetailSize() / 2., true);
+            }
+
+            _visibleDrawables.clear();
+            _placeholders.clear();
             painter.line_width(1.);
             painter.source_rgb(1., 1., 1.);
             painter.lineWidthCompensation(0.);
@@ -268,10 +384,15 @@ std::vector<double> DocumentCanvas::drawLinePattern(
     auto linePatternByValue = std::dynamic_pointer_cast<const lc::meta::DxfLinePatternByValue>(entityLinePattern);
     auto linePatternByBlock = std::dynamic_pointer_cast<const lc::meta::DxfLinePatternByBlock>(entityLinePattern);
 
-    if (linePatternByValue != nullptr && !(linePatternByValue->lcPattern(width).empty())) {
-        return linePatternByValue->lcPattern(width);
+    if (linePatternByValue != nullptr) {
+        auto pattern = linePatternByValue->lcPattern(width);
+
+        if (!pattern.empty()) {
+            return pattern;
+        }
     }
-    else if(linePatternByBlock != nullptr && insert != nullptr) {
+
+    if(linePatternByBlock != nullptr && insert != nullptr) {
         auto insertLP = insert->metaInfo<lc::meta::DxfLinePatternByValue>(lc::meta::DxfLinePattern::LCMETANAME());
 
         if(insertLP != nullptr) {
@@ -281,7 +402,7 @@ std::vector<double> DocumentCanvas::drawLinePattern(
             return insert->layer()->linePattern()->lcPattern(width);
         }
     }
-    else if(layer->linePattern() != nullptr && !(layer->linePattern()->lcPattern(width).empty())) {
+    else if(layer->linePattern() != nullptr) {
         return layer->linePattern()->lcPattern(width);
     }
 
@@ -290,13 +411,11 @@ std::vector<double> DocumentCanvas::drawLinePattern(
 
 lc::Color DocumentCanvas::drawColor(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert,
                                     bool selected) {
-    LcDrawOptions lcDrawOptions;
-
     lc::meta::MetaColor_CSPtr entityColor = entity->metaInfo<lc::meta::MetaColor>(lc::meta::MetaColor::LCMETANAME());
     lc::meta::MetaColorByValue_CSPtr colorByValue = std::dynamic_pointer_cast<const lc::meta::MetaColorByValue>(entityColor);
 
     if (selected) {
-        return lcDrawOptions.selectedColor();
+        return _drawOptions.selectedColor();
     }
     else if (colorByValue != nullptr) {
         return colorByValue->color();
@@ -319,7 +438,7 @@ lc::Color DocumentCanvas::drawColor(const lc::entity::CADEntity_CSPtr& entity, c
 
 void DocumentCanvas::drawEntity(LcPainter& painter, const LCVDrawItem_CSPtr& drawable,
                                 const lc::entity::Insert_CSPtr& insert) {
-    LcDrawOptions lcDrawOptions;
+    const LcDrawOptions& lcDrawOptions = _drawOptions;
 
     double x = 0.;
     double y = 0.;
@@ -329,34 +448,155 @@ void DocumentCanvas::drawEntity(LcPainter& painter, const LCVDrawItem_CSPtr& dra
     painter.device_to_user_distance(&w, &h);
     lc::geo::Area visibleUserArea = lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
 
-    auto asInsert = std::dynamic_pointer_cast<const LCVInsert>(drawable);
-    if(asInsert != nullptr) {
-        asInsert->draw(shared_from_this(), painter);
+    // Temporary inserts can use a block which isn't inserted in the document
+    auto asInsert = dynamic_cast<const LCVInsert*>(drawable.get());
+    if (asInsert != nullptr) {
+        blockDrawList(asInsert->insert()->displayBlock());
+    }
+    resolveBlockStyles();
+
+    DisplayList displayList;
+    displayList.reset(1);
+
+    if (insert == nullptr) {
+        resolve(displayList, 0, drawable.get());
+    }
+    else {
+        auto& item = displayList.append(0);
+        item.drawable = drawable.get();
+        item.style = &resolveStyle(drawable.get(), insert);
+        item.selected = drawable->selected();
+        item.offset = lc::geo::Coordinate();
+    }
+
+    displayList.each([&](const DisplayItem& item) {
+        replay(painter, item, lcDrawOptions, visibleUserArea);
+    });
+}
+
+void DocumentCanvas::resolve(DisplayList& displayList, unsigned int chunk, const LCVDrawItem* drawable) {
+    auto asInsert = dynamic_cast<const LCVInsert*>(drawable);
+    if (asInsert != nullptr) {
+        resolveInsert(displayList, chunk, *asInsert, *asInsert, asInsert->offset());
         return;
     }
 
-    painter.save();
+    auto& item = displayList.append(chunk);
+    item.drawable = drawable;
+    item.style = &resolveStyle(drawable, nullptr);
+    item.selected = drawable->selected();
+    item.offset = lc::geo::Coordinate();
+}
+
+void DocumentCanvas::resolveInsert(DisplayList& displayList, unsigned int chunk, const LCVInsert& topInsert,
+                                   const LCVInsert& insert, const lc::geo::Coordinate& offset) {
+    auto blockDrawList = _blockDrawLists.find(insert.insert()->displayBlock());
+    if (blockDrawList == _blockDrawLists.end()) {
+        return;
+    }
+
+    for (const auto& blockItem : blockDrawList->second->items()) {
+        if (blockItem.insert != nullptr) {
+            resolveInsert(displayList, chunk, topInsert, *blockItem.insert, offset + blockItem.insert->offset());
+            continue;
+        }
+
+        const LCVDrawItem* drawable = blockItem.drawable.get();
+        auto& item = displayList.append(chunk);
+        item.drawable = drawable;
+        item.selected = topInsert.selected();
+        item.offset = offset;
+
+        if (blockItem.byBlock) {
+            // Each insert is resolved by a single thread, so its cache can be modified here
+            auto& style = topInsert.blockStyle(drawable, insert.insert()->id(), _blockDrawListsVersion);
+            resolveStyle(style, drawable->entity(), insert.insert());
+            item.style = &style;
+        }
+        else {
+            // Resolved by resolveBlockStyles
+            item.style = &drawable->style();
+        }
+    }
+}
+
+const DrawStyle& DocumentCanvas::resolveStyle(const LCVDrawItem* drawable, const lc::entity::Insert_CSPtr& insert) {
+    auto& style = drawable->style();
+    resolveStyle(style, drawable->entity(), insert);
+    return style;
+}
+
+void DocumentCanvas::resolveStyle(DrawStyle& style, const lc::entity::CADEntity_CSPtr& entity,
+                                  const lc::entity::Insert_CSPtr& insert) {
+    const ID_DATATYPE insertID = insert == nullptr ? 0 : insert->id();
+
+    if (style.generation != _styleGeneration || style.insert != insertID) {
+        // Decide on line width
+        // We multiply for now by 3 to ensure that 1mm lines will still appear thicker on screen
+        // TODO: Find a better algo
+        style.width = drawWidth(entity, insert) * LINE_WIDTH_FACTOR;
+        style.dashes = drawLinePattern(entity, insert, style.width);
+
+        // Decide what color to render the entity into, the selection color is applied during replay
+        style.color = drawColor(entity, insert, false);
+
+        style.insert = insertID;
+        style.generation = _styleGeneration;
+    }
+}
+
+const BlockDrawList_SPtr& DocumentCanvas::blockDrawList(const lc::meta::Block_CSPtr& block) {
+    auto it = _blockDrawLists.find(block);
+    if (it != _blockDrawLists.end()) {
+        return it->second;
+    }
+
+    // Added before the lists of nested blocks are created, so a block inserting itself doesn't recurse
+    auto list = std::make_shared<BlockDrawList>(_document, block);
+    _blockDrawLists[block] = list;
+    _blockDrawListsVersion++;
+
+    for (const auto& item : list->items()) {
+        if (item.insert != nullptr) {
+            blockDrawList(item.insert->insert()->displayBlock());
+        }
+    }
 
-    lc::entity::CADEntity_CSPtr ci = drawable->entity();
+    return _blockDrawLists[block];
+}
+
+void DocumentCanvas::resolveBlockStyles() {
+    for (const auto& blockDrawList : _blockDrawLists) {
+        auto& list = *blockDrawList.second;
 
+        if (list.styleGeneration() == _styleGeneration) {
+            continue;
+        }
 
+        for (const auto& item : list.items()) {
+            if (item.insert == nullptr && !item.byBlock) {
+                resolveStyle(item.drawable.get(), nullptr);
+            }
+        }
+
+        list.styleGeneration(_styleGeneration);
+    }
+}
+
+void DocumentCanvas::replay(LcPainter& painter, const DisplayItem& item, const LcDrawOptions& options,
+                            const lc::geo::Area& visibleUserArea) const {
 	// Used to give the illusation from slightly thinner lines. Not sure yet what to d with it and if I will keep it
 	double alpha_compensation = 0.9;
 
-    // Decide on line width
-    // We multiply for now by 3 to ensure that 1mm lines will still appear thicker on screen
-    // TODO: Find a better algo
-    double width = drawWidth(ci, insert) * 1.5;
+    painter.save();
 
     // Is this correct? May be we should decide on a different minimum width then 0.1, because may be on some devices 0.11 isn't visible?
-    painter.line_width(std::max(width, MINIMUM_READER_LINEWIDTH));
+    const auto& style = *item.style;
+    const auto& color = item.selected ? options.selectedColor() : style.color;
 
-    auto path = drawLinePattern(ci, insert, width);
-    painter.set_dash(&path[0], path.size(), 0., true);
+    painter.line_width(std::max(style.width, MINIMUM_READER_LINEWIDTH));
+    painter.set_dash(style.dashes.data(), style.dashes.size(), 0., true);
 
-	// Decide what color to render the entity into
-
-    auto color = drawColor(ci, insert, drawable->selected());
     painter.source_rgba(
             color.red(),
             color.green(),
@@ -364,24 +604,108 @@ void DocumentCanvas::drawEntity(LcPainter& painter, const LCVDrawItem_CSPtr& dra
             color.alpha() * alpha_compensation
     );
 
-    drawable->draw(painter, lcDrawOptions, visibleUserArea);
+    // Drawables of a block are drawn at the position of the insert
+    if (item.offset.x() != 0. || item.offset.y() != 0.) {
+        painter.translate(item.offset.x(), -item.offset.y());
+        item.drawable->draw(painter, options, lc::geo::Area(visibleUserArea.minP() - item.offset,
+                                                            visibleUserArea.maxP() - item.offset));
+    }
+    else {
+        item.drawable->draw(painter, options, visibleUserArea);
+    }
 
-	painter.restore();	
+	painter.restore();
 }
 
-void DocumentCanvas::on_commitProcessEvent(const lc::event::CommitProcessEvent& event) {
-    _document->entityContainer().optimise();
+void DocumentCanvas::setRenderThreads(unsigned int threads) {
+    threads = std::max(1u, threads);
+
+    if (threads != _renderWorkers.threads()) {
+        _renderWorkers.resize(threads);
+    }
+}
+
+const LcDrawOptions& DocumentCanvas::drawOptions() const {
+    return _drawOptions;
+}
+
+void DocumentCanvas::setDrawOptions(const LcDrawOptions& drawOptions) {
+    _drawOptions = drawOptions;
+    _drawOptionsChanged();
+}
+
+Nano::Signal<void()>& DocumentCanvas::drawOptionsChanged() {
+    return _drawOptionsChanged;
+}
+
+double DocumentCanvas::maximumStrokeWidth() const {
+    return std::max(_maximumLineWidth * LINE_WIDTH_FACTOR, MINIMUM_READER_LINEWIDTH) + LINE_WIDTH_COMPENSATION;
+}
+
+void DocumentCanvas::on_replaceLayerEvent(const lc::event::ReplaceLayerEvent& event) {
+    _maximumLineWidth = std::max(_maximumLineWidth, event.newLayer()->lineWidth().width());
+    invalidateStyles();
+}
+
+void DocumentCanvas::on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent& event) {
+    invalidateStyles();
+}
+
+void DocumentCanvas::invalidateStyles() {
+    _styleGeneration++;
+
+    // Generation 0 is used for drawables which were never resolved
+    if (_styleGeneration == 0) {
+        _styleGeneration = 1;
+    }
 }
 
-// This assumes that the entity has already been added to _document->entityContainer()
 void DocumentCanvas::on_addEntityEvent(const lc::event::AddEntityEvent& event) {
-    auto entity = event.entity();
+    addEntity(event.entity());
+}
+
+void DocumentCanvas::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
+    removeEntity(event.entity());
+}
+
+void DocumentCanvas::on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+    for (const auto& entity : event.entities()) {
+        addEntity(entity);
+    }
+}
+
+void DocumentCanvas::on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent& event) {
+    for (const auto& entity : event.entities()) {
+        removeEntity(entity);
+    }
+}
+
+// This assumes that the entity has already been added to _document->entityContainer()
+void DocumentCanvas::addEntity(const lc::entity::CADEntity_CSPtr& entity) {
+    // Entities of a block using the width of the insert are covered by the width of the insert
+    _maximumLineWidth = std::max(_maximumLineWidth, drawWidth(entity, nullptr));
+
+    auto insert = std::dynamic_pointer_cast<const lc::entity::Insert>(entity);
+    if (insert != nullptr) {
+        blockDrawList(insert->displayBlock());
+    }
 
     if(entity->block() != nullptr) {
+        // The entity may have been moved to another block
+        for (const auto& blockDrawList : _blockDrawLists) {
+            blockDrawList.second->remove(entity);
+        }
+
+        auto it = _blockDrawLists.find(entity->block());
+        if (it != _blockDrawLists.end()) {
+            it->second->add(entity);
+        }
+
+        _blockDrawListsVersion++;
         return;
     }
 
-    auto drawable = asDrawable(event.entity());
+    auto drawable = asDrawable(entity);
 
     if (drawable != nullptr) {
         auto drawableEntity = std::dynamic_pointer_cast<lc::viewer::LCVDrawItem>(drawable);
@@ -389,9 +713,16 @@ void DocumentCanvas::on_addEntityEvent(const lc::event::AddEntityEvent& event) {
     }
 }
 
-void DocumentCanvas::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
-    _document->entityContainer().remove(event.entity());
-    _entityDrawItem.erase(event.entity());
+// The entity was already removed from _document->entityContainer()
+void DocumentCanvas::removeEntity(const lc::entity::CADEntity_CSPtr& entity) {
+    if (entity->block() != nullptr) {
+        auto it = _blockDrawLists.find(entity->block());
+        if (it != _blockDrawLists.end() && it->second->remove(entity)) {
+            _blockDrawListsVersion++;
+        }
+    }
+
+    _entityDrawItem.erase(entity);
 }
 
 std::shared_ptr<lc::storage::Document> DocumentCanvas::document() const {
@@ -417,29 +748,41 @@ void DocumentCanvas::makeSelection(double x, double y, double w, double h, bool
     _selectedAreaIntersects = occupies;
 
 
-    for(const auto& di: _newSelection) {
-        di->selected(false);
-    }
+    // Find the drawables within the area first, so drawables which stay within the area keep their state
+    std::vector<lc::viewer::LCVDrawItem_SPtr> newSelection;
+    auto select = [&](const lc::entity::CADEntity_CSPtr& entity) {
+        auto di = _entityDrawItem.find(entity);
+        if (di != _entityDrawItem.end()) {
+            newSelection.push_back(di->second);
+        }
+    };
 
-    for(const auto& di: _selectedDrawables) {
-        di->selected(true);
+    if (occupies) {
+        _document->entityContainer().eachFullWithinArea(*_selectedArea, select);
+    }
+    else {
+        _document->entityContainer().eachWithinAndCrossingArea(*_selectedArea, select);
     }
 
-    lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> entitiesInSelection;
+    std::sort(newSelection.begin(), newSelection.end());
 
-    if (occupies) {
-        entitiesInSelection = _document->entityContainer().entitiesFullWithinArea(*_selectedArea);
+    auto isSelected = [&](const lc::viewer::LCVDrawItem_SPtr& drawable) {
+        return std::find(_selectedDrawables.begin(), _selectedDrawables.end(), drawable) != _selectedDrawables.end();
+    };
+
+    // Drawables which left the area get the state of the current selection back
+    for(const auto& di: _newSelection) {
+        if (!std::binary_search(newSelection.begin(), newSelection.end(), di)) {
+            setSelected(di, isSelected(di));
+        }
     }
-    else {
-        entitiesInSelection = _document->entityContainer().entitiesWithinAndCrossingArea(*_selectedArea);
+
+    // Drawables within the area toggle their state
+    for(const auto& di: newSelection) {
+        setSelected(di, !isSelected(di));
     }
-    _newSelection.clear();
-    entitiesInSelection.each< const lc::entity::CADEntity >([&](lc::entity::CADEntity_CSPtr entity) {
-        auto di = _entityDrawItem[entity];
-        auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), di);
-        _newSelection.push_back(di);
-        di->selected(!entity || iter == _selectedDrawables.end());
-    });
+
+    _newSelection = std::move(newSelection);
 }
 
 lc::viewer::LCVDrawItem_SPtr DocumentCanvas::getDrawable(const lc::entity::CADEntity_CSPtr& entity) {
@@ -465,11 +808,11 @@ void DocumentCanvas::closeSelection() {
     for(const auto& drawable: _newSelection) {
         auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), drawable);
         if(iter != _selectedDrawables.end()) {
-            drawable->selected(false);
+            setSelected(drawable, false);
             _selectedDrawables.erase(iter);
         }
         else {
-            drawable->selected(true);
+            setSelected(drawable, true);
             _selectedDrawables.push_back(drawable);
         }
     };
@@ -486,12 +829,25 @@ void DocumentCanvas::removeSelectionArea() {
 
 void DocumentCanvas::removeSelection() {
     for(const auto& di: _selectedDrawables) {
-        di->selected(false);
+        setSelected(di, false);
     };
 
     _selectedDrawables.clear();
 }
 
+void DocumentCanvas::setSelected(const LCVDrawItem_SPtr& drawable, bool selected) {
+    if (drawable->selected() == selected) {
+        return;
+    }
+
+    drawable->selected(selected);
+    _selectionChanged(drawable->entity()->boundingBox());
+}
+
+Nano::Signal<void(const lc::geo::Area&)>& DocumentCanvas::selectionChanged() {
+    return _selectionChanged;
+}
+
 Nano::Signal<void(event::DrawEvent const & event)> & DocumentCanvas::background ()  {
     return _background;
 }
@@ -636,8 +992,20 @@ void DocumentCanvas::selectPoint(double x, double y) {
     w = w - zeroX;
 
     lc::geo::Area selectionArea(lc::geo::Coordinate(x - w, y - w), w * 2, w * 2);
-    auto entities = _document->entityContainer().entitiesWithinAndCrossingAreaFast(selectionArea);
-    entities.each< const lc::entity::CADEntity >([=](lc::entity::CADEntity_CSPtr entity) {
-        _entityDrawItem[entity]->selected(!_entityDrawItem[entity]->selected());
+    _document->entityContainer().eachWithinAndCrossingAreaFast(selectionArea, [&](const lc::entity::CADEntity_CSPtr& entity) {
+        auto di = _entityDrawItem.find(entity);
+        if (di == _entityDrawItem.end()) {
+            return;
+        }
+
+        auto iter = std::find(_selectedDrawables.begin(), _selectedDrawables.end(), di->second);
+        if (iter != _selectedDrawables.end()) {
+            setSelected(di->second, false);
+            _selectedDrawables.erase(iter);
+        }
+        else {
+            setSelected(di->second, true);
+            _selectedDrawables.push_back(di->second);
+        }
     });
 }
@@ -1,17 +1,25 @@
 #pragma once
 
 #include <functional>
+#include <unordered_map>
 
 #include "painters/lcpainter.h"
 
 #include "cad/storage/entitycontainer.h"
 #include "drawitems/lcvdrawitem.h"
 #include "events/drawevent.h"
+#include "displaylist.h"
+#include "renderworkers.h"
+#include "blockdrawlist.h"
+#include "lcdrawoptions.h"
 #include <cad/base/cadentity.h>
 
 #include <cad/events/addentityevent.h>
-#include <cad/events/commitprocessevent.h>
+#include <cad/events/addentitiesevent.h>
 #include <cad/events/removeentityevent.h>
+#include <cad/events/removeentitiesevent.h>
+#include <cad/events/replacelayerevent.h>
+#include <cad/events/replacelinepatternevent.h>
 #include <nano-signal-slot/nano_signal_slot.hpp>
 
 #include <cad/storage/document.h>
@@ -43,6 +51,14 @@ namespace lc {
                  */
                 void render(LcPainter& painter, PainterType type);
 
+                /**
+                 * @brief render a part of the document
+                 * @param painter Target
+                 * @param type Painter type
+                 * @param visibleUserArea Area to render, in user coordinates
+                 */
+                void render(LcPainter& painter, PainterType type, const lc::geo::Area& visibleUserArea);
+
                 /**
                  * @brief drawEntity
                  * Draw entity without adding it to the current document
@@ -158,6 +174,11 @@ namespace lc {
                 Nano::Signal<void(event::DrawEvent const& drawEvent)>& background();
                 Nano::Signal<void(event::DrawEvent const& drawEvent)>& foreground();
 
+                /**
+                 * @brief Signal called with the bounding box of each entity which got selected or deselected
+                 */
+                Nano::Signal<void(const lc::geo::Area&)>& selectionChanged();
+
                 /**
                  * Return the underlaying document
                  */
@@ -190,12 +211,113 @@ namespace lc {
 
                 lc::viewer::LCVDrawItem_SPtr getDrawable(const lc::entity::CADEntity_CSPtr& entity);
 
+                /**
+                 * @brief Set the number of threads used to resolve the style of the visible entities
+                 * Painting itself is always done by the thread calling render
+                 * @param threads
+                 */
+                void setRenderThreads(unsigned int threads);
+
+                /**
+                 * @brief Options used to render the document, like the level of detail
+                 */
+                const LcDrawOptions& drawOptions() const;
+
+                /**
+                 * @brief Change the options used to render the document, calls drawOptionsChanged
+                 * @param drawOptions
+                 */
+                void setDrawOptions(const LcDrawOptions& drawOptions);
+
+                /**
+                 * @brief Signal called when the options used to render the document changed
+                 */
+                Nano::Signal<void()>& drawOptionsChanged();
+
+                /**
+                 * @brief Largest width, in device units, of the lines of the entities added to the document
+                 * Lines can draw outside the bounding box of their entity up to half this width
+                 */
+                double maximumStrokeWidth() const;
+
             private:
                 void on_addEntityEvent(const lc::event::AddEntityEvent&);
 
                 void on_removeEntityEvent(const lc::event::RemoveEntityEvent&);
 
-                void on_commitProcessEvent(const lc::event::CommitProcessEvent&);
+                void on_addEntitiesEvent(const lc::event::AddEntitiesEvent&);
+
+                void on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent&);
+
+                /**
+                 * @brief Create the drawable of a entity added to the document
+                 */
+                void addEntity(const lc::entity::CADEntity_CSPtr& entity);
+
+                /**
+                 * @brief Remove the drawable of a entity removed from the document
+                 */
+                void removeEntity(const lc::entity::CADEntity_CSPtr& entity);
+
+                void on_replaceLayerEvent(const lc::event::ReplaceLayerEvent&);
+
+                void on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent&);
+
+                /**
+                 * @brief Invalidate the cached style of all drawables
+                 */
+                void invalidateStyles();
+
+                /**
+                 * @brief Change the selection state of a drawable, calls selectionChanged when it changes
+                 */
+                void setSelected(const LCVDrawItem_SPtr& drawable, bool selected);
+
+                /**
+                 * @brief Return the cached style of a drawable, resolving it when outdated
+                 */
+                const DrawStyle& resolveStyle(const LCVDrawItem* drawable, const lc::entity::Insert_CSPtr& insert);
+
+                /**
+                 * @brief Resolve style, when outdated, for entity drawn in insert
+                 */
+                void resolveStyle(DrawStyle& style, const lc::entity::CADEntity_CSPtr& entity,
+                                  const lc::entity::Insert_CSPtr& insert);
+
+                /**
+                 * @brief Return the drawables of a block, creating them when needed
+                 * Drawables of blocks inserted in the block are created too
+                 */
+                const BlockDrawList_SPtr& blockDrawList(const lc::meta::Block_CSPtr& block);
+
+                /**
+                 * @brief Resolve the style of the block drawables which don't depend on the insert
+                 * Must be called before resolve, which only reads these styles
+                 */
+                void resolveBlockStyles();
+
+                /**
+                 * @brief Add a drawable with it's resolved style to a chunk of the display list
+                 * Inserts are replaced by the drawables of their block
+                 * The style is only resolved when the cached style of the drawable is outdated
+                 * This is called from multiple threads and must not modify the canvas
+                 */
+                void resolve(DisplayList& displayList, unsigned int chunk, const LCVDrawItem* drawable);
+
+                /**
+                 * @brief Add the drawables of the block of insert to a chunk of the display list
+                 * @param topInsert Insert of the document, which caches the styles depending on the insert
+                 * @param insert topInsert or a insert nested in its block
+                 * @param offset Translation of the drawables of the block of insert
+                 */
+                void resolveInsert(DisplayList& displayList, unsigned int chunk, const LCVInsert& topInsert,
+                                   const LCVInsert& insert, const lc::geo::Coordinate& offset);
+
+                /**
+                 * @brief Draw a item of the display list
+                 */
+                void replay(LcPainter& painter, const DisplayItem& item, const LcDrawOptions& options,
+                            const lc::geo::Area& visibleUserArea) const;
 
                 double drawWidth(const lc::entity::CADEntity_CSPtr& entity, const lc::entity::Insert_CSPtr& insert);
 
@@ -215,8 +337,15 @@ namespace lc {
                 // Map of cad entity to drawitem
                 std::map<lc::entity::CADEntity_CSPtr, lc::viewer::LCVDrawItem_SPtr> _entityDrawItem;
 
+                // Drawables of the blocks, shared by all inserts of a block
+                std::unordered_map<lc::meta::Block_CSPtr, BlockDrawList_SPtr> _blockDrawLists;
+                // Changed each time a drawable of a block is added or removed
+                unsigned int _blockDrawListsVersion;
+
                 Nano::Signal<void(event::DrawEvent const& event)> _background;
                 Nano::Signal<void(event::DrawEvent const& event)> _foreground;
+                Nano::Signal<void(const lc::geo::Area&)> _selectionChanged;
+                Nano::Signal<void()> _drawOptionsChanged;
 
                 // Maximum and minimum allowed scale factors
                 double _zoomMin;
@@ -236,6 +365,27 @@ namespace lc {
                 // Functor to draw a selected area, that's the green or read area...
                 std::function<void(lc::viewer::LcPainter& , lc::geo::Area, bool)> _selectedAreaPainter;
 
+                // Drawables found during render, kept between frames to prevent allocations
+                std::vector<lc::viewer::LCVDrawItem_SPtr> _visibleDrawables;
+
+                // Drawables representing entities culled by the level of detail, with the center of the culled area
+                std::vector<std::pair<lc::viewer::LCVDrawItem_SPtr, lc::geo::Coordinate>> _placeholders;
+                // Device pixels which already have a placeholder
+                std::vector<bool> _placeholderPixels;
+
+                // Visible drawables with resolved style, replayed into the painter
+                DisplayList _displayList;
+                // Threads resolving the style of the visible drawables, kept between frames
+                RenderWorkers _renderWorkers;
+
+                // Drawables with a different style generation need to resolve their style again
+                unsigned int _styleGeneration;
+
+                LcDrawOptions _drawOptions;
+
+                // Largest line width of the added entities and replaced layers, only grows
+                double _maximumLineWidth;
+
                 std::vector<lc::viewer::LCVDrawItem_SPtr> _selectedDrawables;
                 std::vector<lc::viewer::LCVDrawItem_SPtr> _newSelection;
 
@@ -0,0 +1,114 @@
+#include "flattencache.h"
+#include <algorithm>
+
+using namespace lc::viewer;
+
+const double FlattenCache::TOLERANCE = 0.25;
+const unsigned int FlattenCache::MAXIMUM_POINTS = 8192;
+
+// Subdivision depth of a bezier, 2^16 segments is more than MAXIMUM_POINTS
+static const unsigned int MAXIMUM_BEZIER_DEPTH = 16;
+
+FlattenCache::FlattenCache() :
+        _bucket(0),
+        _valid(false),
+        _complete(false) {
+}
+
+size_t FlattenCache::size() const {
+    return _points.size();
+}
+
+bool FlattenCache::flattenArc(const lc::geo::Coordinate& center, double majorRadius, double minorRadius,
+                              double rotation, double start, double span, double tolerance,
+                              std::vector<lc::geo::Coordinate>& points) {
+    if (span == 0.) {
+        return true;
+    }
+
+    const double radius = std::max(std::abs(majorRadius), std::abs(minorRadius));
+
+    // Largest angle for which the chord stays within tolerance of the curve
+    double step = M_PI / 2.;
+    if (tolerance < radius) {
+        step = std::min(step, 2. * std::acos(1. - tolerance / radius));
+    }
+
+    const double segments = std::ceil(std::abs(span) / step);
+    if (segments + points.size() > MAXIMUM_POINTS) {
+        return false;
+    }
+
+    const unsigned int count = std::max(1u, (unsigned int) segments);
+    const double cosRotation = std::cos(rotation);
+    const double sinRotation = std::sin(rotation);
+
+    for (unsigned int i = points.empty() ? 0 : 1; i <= count; i++) {
+        const double angle = start + span * i / count;
+        const double x = majorRadius * std::cos(angle);
+        const double y = minorRadius * std::sin(angle);
+
+        points.emplace_back(center.x() + x * cosRotation - y * sinRotation,
+                            center.y() + x * sinRotation + y * cosRotation);
+    }
+
+    return true;
+}
+
+namespace {
+    bool flattenBezier(const lc::geo::Coordinate* cp, size_t size, double tolerance, unsigned int depth,
+                       std::vector<lc::geo::Coordinate>& points) {
+        const auto& first = cp[0];
+        const auto& last = cp[size - 1];
+        const auto chord = last - first;
+        const double chordLength = chord.magnitude();
+
+        double deviation = 0.;
+        for (size_t i = 1; i + 1 < size; i++) {
+            const auto offset = cp[i] - first;
+            deviation = std::max(deviation, chordLength > 0. ?
+                                            std::abs(chord.x() * offset.y() - chord.y() * offset.x()) / chordLength :
+                                            offset.magnitude());
+        }
+
+        if (deviation <= tolerance || depth >= MAXIMUM_BEZIER_DEPTH) {
+            if (points.size() >= lc::viewer::FlattenCache::MAXIMUM_POINTS) {
+                return false;
+            }
+
+            points.push_back(last);
+            return true;
+        }
+
+        // Split at t = 0.5 with de Casteljau
+        lc::geo::Coordinate left[4];
+        lc::geo::Coordinate right[4];
+        lc::geo::Coordinate work[4];
+        std::copy(cp, cp + size, work);
+
+        for (size_t level = 0; level < size; level++) {
+            left[level] = work[0];
+            right[size - 1 - level] = work[size - 1 - level];
+
+            for (size_t i = 0; i + 1 < size - level; i++) {
+                work[i] = work[i].mid(work[i + 1]);
+            }
+        }
+
+        return flattenBezier(left, size, tolerance, depth + 1, points) &&
+               flattenBezier(right, size, tolerance, depth + 1, points);
+    }
+}
+
+bool FlattenCache::flattenBezier(const std::vector<lc::geo::Coordinate>& controlPoints, double tolerance,
+                                 std::vector<lc::geo::Coordinate>& points) {
+    if (controlPoints.size() < 2 || controlPoints.size() > 4) {
+        return true;
+    }
+
+    if (points.empty()) {
+        points.push_back(controlPoints.front());
+    }
+
+    return ::flattenBezier(controlPoints.data(), controlPoints.size(), tolerance, 0, points);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include "cad/geometry/geocoordinate.h"
+#include "../painters/lcpainter.h"
+
+namespace lc {
+    namespace viewer {
+        /**
+         * @brief FlattenCache
+         * Curve of a drawable flattened into a polyline, for the scale of the painter.
+         * The polyline is kept while the scale stays within the same power of two, so zooming in
+         * or out only flattens the curve again when the deviation could become visible.
+         * Only used by the thread painting the drawables.
+         */
+        class FlattenCache {
+            public:
+                /**
+                 * @brief Maximum distance between the curve and the polyline, in device units
+                 */
+                static const double TOLERANCE;
+
+                /**
+                 * @brief Curves needing more points than this should be drawn as analytic curves
+                 */
+                static const unsigned int MAXIMUM_POINTS;
+
+                FlattenCache();
+
+                /**
+                 * @brief Draw the polyline of the curve for the scale of painter
+                 * flatten is called as bool flatten(double tolerance, std::vector<geo::Coordinate>& points) when
+                 * the polyline needs to be created, tolerance is in user units.
+                 * It returns false when the curve needs more than MAXIMUM_POINTS points.
+                 * @return false when nothing was drawn because the curve has too many points
+                 */
+                template<typename T>
+                bool draw(LcPainter& painter, T flatten) const {
+                    const double scale = painter.scale();
+                    if (!(scale > 0.)) {
+                        return false;
+                    }
+
+                    const int bucket = (int) std::floor(std::log2(scale));
+
+                    if (!_valid || bucket != _bucket) {
+                        // Tolerance of the largest scale of the bucket
+                        _points.clear();
+                        _complete = flatten(TOLERANCE / std::pow(2., bucket + 1), _points);
+                        _bucket = bucket;
+                        _valid = true;
+                    }
+
+                    if (!_complete) {
+                        return false;
+                    }
+
+                    if (!_points.empty()) {
+                        painter.move_to(_points.front().x(), _points.front().y());
+
+                        for (size_t i = 1; i < _points.size(); i++) {
+                            painter.line_to(_points[i].x(), _points[i].y());
+                        }
+                    }
+
+                    return true;
+                }
+
+                /**
+                 * @brief Number of points in the polyline
+                 */
+                size_t size() const;
+
+                /**
+                 * @brief Add the points of a elliptic arc, which starts at angle start and turns by angle span
+                 * The first point is only added when points is empty
+                 * @param rotation angle of the major axis
+                 * @return false when more than MAXIMUM_POINTS points are needed
+                 */
+                static bool flattenArc(const lc::geo::Coordinate& center, double majorRadius, double minorRadius,
+                                       double rotation, double start, double span, double tolerance,
+                                       std::vector<lc::geo::Coordinate>& points);
+
+                /**
+                 * @brief Add the points of a quadratic or cubic bezier by subdividing it until it's flat
+                 * The first point is only added when points is empty
+                 * @param controlPoints 3 or 4 control points, or 2 for a line
+                 * @return false when more than MAXIMUM_POINTS points are needed
+                 */
+                static bool flattenBezier(const std::vector<lc::geo::Coordinate>& controlPoints, double tolerance,
+                                          std::vector<lc::geo::Coordinate>& points);
+
+            private:
+                mutable std::vector<lc::geo::Coordinate> _points;
+                mutable int _bucket;
+                mutable bool _valid;
+                mutable bool _complete;
+        };
+    }
+}
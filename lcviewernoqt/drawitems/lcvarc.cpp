@@ -11,6 +11,23 @@ LCVArc::LCVArc(const lc::entity::Arc_CSPtr& arc) :
 
 void LCVArc::draw(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
     if (_arc->radius() != 0) {
+        bool flattened = _flattened.draw(painter, [this](double tolerance, std::vector<lc::geo::Coordinate>& points) {
+            // Same direction and length as drawn by the painter
+            double span = _arc->CCW() ? _arc->endAngle() - _arc->startAngle() : _arc->startAngle() - _arc->endAngle();
+            span = std::fmod(span, 2. * M_PI);
+            if (span < 0.) {
+                span += 2. * M_PI;
+            }
+
+            return FlattenCache::flattenArc(_arc->center(), _arc->radius(), _arc->radius(), 0., _arc->startAngle(),
+                                            _arc->CCW() ? span : -span, tolerance, points);
+        });
+
+        if (flattened) {
+            painter.stroke();
+            return;
+        }
+
         if (_arc->CCW()) {
             painter.arcNegative(_arc->center().x(), _arc->center().y(), _arc->radius(), _arc->startAngle(), _arc->endAngle());
         } else {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lcvdrawitem.h"
+#include "flattencache.h"
 #include <cad/primitive/arc.h>
 
 namespace lc {
@@ -23,6 +24,7 @@ namespace lc {
 
             private:
                 lc::entity::Arc_CSPtr _arc;
+                FlattenCache _flattened;
         };
     }
 }
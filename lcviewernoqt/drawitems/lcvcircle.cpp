@@ -11,7 +11,14 @@ LCVCircle::LCVCircle(const lc::entity::Circle_CSPtr& circle) :
 
 void LCVCircle::draw(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
     if (_circle->radius() != 0) {
-        painter.circle(_circle->center().x(), _circle->center().y(), _circle->radius());
+        bool flattened = _flattened.draw(painter, [this](double tolerance, std::vector<lc::geo::Coordinate>& points) {
+            return FlattenCache::flattenArc(_circle->center(), _circle->radius(), _circle->radius(), 0., 0., 2. * M_PI,
+                                            tolerance, points);
+        });
+
+        if (!flattened) {
+            painter.circle(_circle->center().x(), _circle->center().y(), _circle->radius());
+        }
         painter.stroke();
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lcvdrawitem.h"
+#include "flattencache.h"
 #include "cad/primitive/circle.h"
 
 namespace lc {
@@ -26,6 +27,7 @@ namespace lc {
 
             private:
                 lc::entity::Circle_CSPtr _circle;
+                FlattenCache _flattened;
         };
     }
 }
@@ -19,3 +19,7 @@ bool LCVDrawItem::selected() const {
 void LCVDrawItem::selected(bool selected) {
     _selected = selected;
 }
+
+DrawStyle& LCVDrawItem::style() const {
+    return _style;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <cad/const.h>
 #include <cad/base/cadentity.h>
+#include <cad/base/id.h>
+#include <cad/meta/color.h>
 
 namespace lc {
     namespace geo {
@@ -14,6 +17,20 @@ namespace lc {
         class LcDrawOptions;
         class LcPainter;
 
+        /**
+         * @brief Line width, color and line pattern of a drawable, resolved from its meta info and layer
+         * The color does not include the selection color
+         */
+        struct DrawStyle {
+            // Style generation of the DocumentCanvas when resolved, 0 when never resolved
+            unsigned int generation = 0;
+            // ID of the insert the drawable was resolved for, 0 when drawn outside a block
+            ID_DATATYPE insert = 0;
+            double width = 0.;
+            lc::Color color;
+            std::vector<double> dashes;
+        };
+
         /**
     * LCVDrawItem is a abstract class that any class needs to implement if it wants to draw an entity on backgrounds or foregrounds
     * For other objects (Cursor, ...) see files in drawables folder
@@ -43,9 +60,16 @@ namespace lc {
                  */
                 virtual lc::entity::CADEntity_CSPtr entity() const = 0;
 
+                /**
+                 * @brief Style cached by the DocumentCanvas between frames
+                 * The entity of a drawable never changes, a replaced entity gets a new drawable
+                 */
+                DrawStyle& style() const;
+
             private:
                 bool _selectable;
                 bool _selected;
+                mutable DrawStyle _style;
         };
 
         DECLARE_SHORT_SHARED_PTR(LCVDrawItem)
@@ -11,6 +11,25 @@ LCVEllipse::LCVEllipse(const lc::entity::Ellipse_CSPtr& ellipse) :
 
 void LCVEllipse::draw(LcPainter& painter, const LcDrawOptions &options, const lc::geo::Area& rect) const {
     if (_ellipse->minorRadius() != 0) {
+        bool flattened = _flattened.draw(painter, [this](double tolerance, std::vector<lc::geo::Coordinate>& points) {
+            // Same part of the ellipse as drawn by the painter, a full ellipse when both angles are equal
+            double span = 2. * M_PI;
+            if (_ellipse->startAngle() != _ellipse->endAngle()) {
+                span = std::fmod(_ellipse->endAngle() - _ellipse->startAngle(), 2. * M_PI);
+                if (span <= 0.) {
+                    span += 2. * M_PI;
+                }
+            }
+
+            return FlattenCache::flattenArc(_ellipse->center(), _ellipse->majorRadius(), _ellipse->minorRadius(),
+                                            _ellipse->getAngle(), _ellipse->startAngle(), span, tolerance, points);
+        });
+
+        if (flattened) {
+            painter.stroke();
+            return;
+        }
+
         painter.ellipse(
                 _ellipse->center().x(), _ellipse->center().y(),
                 _ellipse->majorRadius(), _ellipse->minorRadius(),
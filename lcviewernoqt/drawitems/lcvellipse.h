@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lcvdrawitem.h"
+#include "flattencache.h"
 #include "cad/primitive/ellipse.h"
 
 namespace lc {
@@ -31,6 +32,7 @@ namespace lc {
 
             private:
                 lc::entity::Ellipse_CSPtr _ellipse;
+                FlattenCache _flattened;
         };
     }
 }
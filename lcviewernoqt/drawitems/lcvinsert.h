@@ -1,39 +1,48 @@
 #pragma once
 
 #include <cad/primitive/insert.h>
-#include <cad/storage/entitycontainer.h>
-#include <cad/storage/document.h>
-#include <unordered_set>
+#include <map>
 #include "lcvdrawitem.h"
-#include "../documentcanvas.h"
 
 namespace lc {
     namespace viewer {
+        /**
+         * @brief Drawable of an Insert
+         * The drawables of the block are shared by all inserts of the block, see BlockDrawList.
+         * They are drawn by the DocumentCanvas, translated to the position of the insert.
+         */
         class LCVInsert : public LCVDrawItem {
             public:
                 LCVInsert(lc::entity::Insert_CSPtr& insert);
 
-                virtual ~LCVInsert();
-
-                void selected(bool selected) override;
-
-                void draw(LcPainter& _painter, const LcDrawOptions& options, const lc::geo::Area& updateRect) const override;
-
-                void draw(const DocumentCanvas_SPtr& docCanvas, LcPainter& painter) const;
-
                 lc::entity::CADEntity_CSPtr entity() const override;
 
-            private:
-                void append(const lc::entity::CADEntity_CSPtr& entity);
-
-                void on_addEntityEvent(const lc::event::AddEntityEvent&);
-
-                void on_removeEntityEvent(const lc::event::RemoveEntityEvent&);
+                /**
+                 * @return Insert entity
+                 */
+                const lc::entity::Insert_CSPtr& insert() const;
+
+                /**
+                 * @return Translation from the block to the position of the insert
+                 */
+                const lc::geo::Coordinate& offset() const;
+
+                /**
+                 * @brief Cached style of a drawable of the block which depends on the insert
+                 * Used for entities with a color, line width or line pattern ByBlock
+                 * The cache is cleared when version changes, a new style has generation 0
+                 * @param drawable drawable of the block, or of a nested block
+                 * @param insert ID of the insert the style is resolved with
+                 * @param version version of the block drawables
+                 */
+                DrawStyle& blockStyle(const LCVDrawItem* drawable, ID_DATATYPE insert, unsigned int version) const;
 
             private:
                 lc::entity::Insert_CSPtr _insert;
                 lc::geo::Coordinate _offset;
-                std::map<ID_DATATYPE, LCVDrawItem_SPtr> _entities;
+
+                mutable unsigned int _blockStylesVersion;
+                mutable std::map<std::pair<const LCVDrawItem*, ID_DATATYPE>, DrawStyle> _blockStyles;
         };
     }
-}
\ No newline at end of file
+}
@@ -10,8 +10,21 @@ LCVSpline::LCVSpline(const lc::entity::Spline_CSPtr& spline) :
 }
 
 void LCVSpline::draw(LcPainter &painter, const LcDrawOptions &options, const lc::geo::Area &rect) const {
+    const auto& bezlist = _spline->beziers();
 
-    auto bezlist = _spline->beziers();
+    bool flattened = _flattened.draw(painter, [&bezlist](double tolerance, std::vector<lc::geo::Coordinate>& points) {
+        for(const auto &bezier: bezlist) {
+            if (!FlattenCache::flattenBezier(bezier->getCP(), tolerance, points)) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    if (flattened) {
+        painter.stroke();
+        return;
+    }
 
     for(const auto &bezier: bezlist) {
         auto bez = bezier->getCP();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lcvdrawitem.h"
+#include "flattencache.h"
 #include "cad/primitive/spline.h"
 
 namespace lc {
@@ -27,6 +28,7 @@ namespace lc {
 
             private:
                 lc::entity::Spline_CSPtr _spline;
+                FlattenCache _flattened;
         };
     }
 }
@@ -10,6 +10,8 @@ LcDrawOptions::LcDrawOptions() :
     _alignedFormat("%.2f"),
     _angleFormat("%.2f°"),
     _imageOutline(true),
-    _imageOutlineColor(lc::Color(1., 1., 1., 0.5))
+    _imageOutlineColor(lc::Color(1., 1., 1., 0.5)),
+    _levelOfDetail(LOD_PLACEHOLDER),
+    _levelOfDetailSize(1.)
 {
 }
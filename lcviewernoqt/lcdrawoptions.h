@@ -5,6 +5,18 @@
 
 namespace lc {
     namespace viewer {
+        /**
+         * How entities smaller than the level of detail size are rendered
+         */
+        enum LevelOfDetail {
+            // Draw every entity
+            LOD_NONE,
+            // Skip entities smaller than the level of detail size
+            LOD_SKIP,
+            // Draw a point for each area with skipped entities
+            LOD_PLACEHOLDER
+        };
+
         class LcDrawOptions {
             public:
                 LcDrawOptions();
@@ -48,6 +60,25 @@ namespace lc {
                     return _imageOutlineColor;
                 }
 
+                LevelOfDetail levelOfDetail() const {
+                    return _levelOfDetail;
+                }
+
+                void setLevelOfDetail(LevelOfDetail levelOfDetail) {
+                    _levelOfDetail = levelOfDetail;
+                }
+
+                /**
+                 * @brief Size in device units below which entities are skipped
+                 */
+                double levelOfDetailSize() const {
+                    return _levelOfDetailSize;
+                }
+
+                void setLevelOfDetailSize(double levelOfDetailSize) {
+                    _levelOfDetailSize = levelOfDetailSize;
+                }
+
             private:
                 lc::Color _selectedColor;
                 double _dimTextHeight;
@@ -58,6 +89,8 @@ namespace lc {
                 std::string _angleFormat;
                 bool _imageOutline;
                 lc::Color _imageOutlineColor;
+                LevelOfDetail _levelOfDetail;
+                double _levelOfDetailSize;
         };
     }
 }
@@ -4,6 +4,7 @@
 #include <cad/base/visitor.h>
 #include <cad/base/cadentity.h>
 #include <cad/math/intersect.h>
+#include <algorithm>
 
 using namespace lc::viewer::manager;
 
@@ -13,7 +14,19 @@ SnapManagerImpl::SnapManagerImpl(DocumentCanvas_SPtr view, lc::entity::Snapable_
         _snapIntersections(false),
         _distanceToSnap(distanceToSnap),
         _view(std::move(view)) {
+    auto document = _view->document();
+    document->addEntityEvent().connect<SnapManagerImpl, &SnapManagerImpl::on_addEntityEvent>(this);
+    document->removeEntityEvent().connect<SnapManagerImpl, &SnapManagerImpl::on_removeEntityEvent>(this);
+    document->addEntitiesEvent().connect<SnapManagerImpl, &SnapManagerImpl::on_addEntitiesEvent>(this);
+    document->removeEntitiesEvent().connect<SnapManagerImpl, &SnapManagerImpl::on_removeEntitiesEvent>(this);
+}
 
+SnapManagerImpl::~SnapManagerImpl() {
+    auto document = _view->document();
+    document->addEntityEvent().disconnect<SnapManagerImpl, &SnapManagerImpl::on_addEntityEvent>(this);
+    document->removeEntityEvent().disconnect<SnapManagerImpl, &SnapManagerImpl::on_removeEntityEvent>(this);
+    document->addEntitiesEvent().disconnect<SnapManagerImpl, &SnapManagerImpl::on_addEntitiesEvent>(this);
+    document->removeEntitiesEvent().disconnect<SnapManagerImpl, &SnapManagerImpl::on_removeEntitiesEvent>(this);
 }
 
 /**
@@ -48,26 +61,20 @@ void SnapManagerImpl::setDeviceLocation(int x, int y) {
     // this way we can get more efficiently snap to entities outside the cursor's 'range' so the
     // person can 'pick' a entity onceand then it would stay in the list of entities to
     // consider for snapping. THis will mostly lickly be lines only
-    std::vector<lc::EntityDistance> entities = _view->entityContainer().getEntityPathsNearCoordinate(location,
-                                                                                                  realDistanceForPixels);
-    std::sort(entities.begin(), entities.end(), lc::EntityDistanceSorter(location));
+    auto& entities = _entitiesNearCursor;
+    entities.clear();
+    _view->entityContainer().nearestEntityPaths(location, MAXIMUM_SNAP_ENTITIES, realDistanceForPixels, entities);
 
     // Emit Snappoint event if a entity intersects with a other entity
     if (entities.size() > 1 && _snapIntersections) {
 
         for (size_t a = 0; a < entities.size(); a++) {
             for (size_t b = a + 1; b < entities.size(); b++) {
-                lc::entity::CADEntity_CSPtr i1 = entities.at(a).entity();
-                lc::entity::CADEntity_CSPtr i2 = entities.at(b).entity();
-
-                lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
-                visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *i1.get(), *i2.get());
-
-                if (!intersect.result().empty()) {
-                    std::vector<lc::geo::Coordinate> coords = intersect.result();
-                    std::sort(coords.begin(), coords.end(), lc::geo::CoordinateDistanceSort(location));
+                const auto& coords = intersections(entities.at(a).entity(), entities.at(b).entity());
 
-                    lc::geo::Coordinate sp = coords.at(0);
+                if (!coords.empty()) {
+                    lc::geo::Coordinate sp = *std::min_element(coords.begin(), coords.end(),
+                                                               lc::geo::CoordinateDistanceSort(location));
                     if ((location - sp).magnitude() < realDistanceForPixels) {
                         auto event = event::SnapPointEvent(sp);
                         _snapPointEvent(event);
@@ -131,6 +138,38 @@ void SnapManagerImpl::setDeviceLocation(int x, int y) {
 }
 
 
+const std::vector<lc::geo::Coordinate>& SnapManagerImpl::intersections(const lc::entity::CADEntity_CSPtr& e1,
+                                                                        const lc::entity::CADEntity_CSPtr& e2) {
+    const IntersectionKey key = e1->id() < e2->id() ? IntersectionKey{e1->id(), e2->id()} : IntersectionKey{e2->id(), e1->id()};
+    auto it = _intersections.find(key);
+
+    if (it != _intersections.end()) {
+        return it->second;
+    }
+
+    lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
+    visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *e1.get(), *e2.get());
+
+    return _intersections.emplace(key, intersect.result()).first->second;
+}
+
+// Modified entities keep their ID, so the cache is cleared on any change, including undo and redo
+void SnapManagerImpl::on_addEntityEvent(const lc::event::AddEntityEvent& event) {
+    _intersections.clear();
+}
+
+void SnapManagerImpl::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
+    _intersections.clear();
+}
+
+void SnapManagerImpl::on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+    _intersections.clear();
+}
+
+void SnapManagerImpl::on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent& event) {
+    _intersections.clear();
+}
+
 void SnapManagerImpl::setGridSnappable(bool enabled) {
     _gridSnappable = enabled;
 }
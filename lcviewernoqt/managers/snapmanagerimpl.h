@@ -4,6 +4,11 @@
 #include "../documentcanvas.h"
 #include "../events/LocationEvent.h"
 #include <cad/interface/snapconstrain.h>
+#include <cad/events/addentityevent.h>
+#include <cad/events/removeentityevent.h>
+#include <cad/events/addentitiesevent.h>
+#include <cad/events/removeentitiesevent.h>
+#include <unordered_map>
 
 /*!
  * \brief Implements the SnapManager interface
@@ -31,7 +36,7 @@ namespace lc {
                      */
                     SnapManagerImpl(DocumentCanvas_SPtr view, lc::entity::Snapable_CSPtr grid, double distanceToSnap);
 
-                    virtual ~SnapManagerImpl() = default;
+                    virtual ~SnapManagerImpl();
 
                     virtual void setGridSnappable(bool enabled);
 
@@ -51,6 +56,37 @@ namespace lc {
                     virtual Nano::Signal<void(const event::SnapPointEvent&)>& snapPointEvents();
 
                 private:
+                    // Maximum number of entities near the cursor considered for snapping
+                    static const unsigned int MAXIMUM_SNAP_ENTITIES = 16;
+
+                    struct IntersectionKey {
+                        ID_DATATYPE first;
+                        ID_DATATYPE second;
+
+                        bool operator==(const IntersectionKey& other) const {
+                            return first == other.first && second == other.second;
+                        }
+                    };
+
+                    struct IntersectionKeyHash {
+                        size_t operator()(const IntersectionKey& key) const {
+                            return std::hash<ID_DATATYPE>()(key.first) * 31 + std::hash<ID_DATATYPE>()(key.second);
+                        }
+                    };
+
+                    /*!
+                     * \brief Intersections of two entities, calculated once until entities are added or removed
+                     */
+                    const std::vector<lc::geo::Coordinate>& intersections(const lc::entity::CADEntity_CSPtr& e1,
+                                                                          const lc::entity::CADEntity_CSPtr& e2);
+
+                    void on_addEntityEvent(const lc::event::AddEntityEvent&);
+
+                    void on_removeEntityEvent(const lc::event::RemoveEntityEvent&);
+
+                    void on_addEntitiesEvent(const lc::event::AddEntitiesEvent&);
+
+                    void on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent&);
 
                     // Grid is snapable
                     lc::entity::Snapable_CSPtr _grid;
@@ -63,6 +99,12 @@ namespace lc {
                     // List of entities that are potential for snapping
                     std::vector<lc::entity::Snapable_CSPtr> _snapableEntities;
 
+                    // Entities found near the cursor, kept between mouse moves to prevent allocations
+                    std::vector<lc::EntityDistance> _entitiesNearCursor;
+
+                    // Intersections between pairs of entities, cleared when entities are added or removed
+                    std::unordered_map<IntersectionKey, std::vector<lc::geo::Coordinate>, IntersectionKeyHash> _intersections;
+
                     // List of additional points a user can pick, to be implementedx
                     std::vector<lc::geo::Coordinate> _smartCoordinates;
 
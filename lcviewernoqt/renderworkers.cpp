@@ -0,0 +1,108 @@
+#include "renderworkers.h"
+#include <algorithm>
+
+using namespace lc::viewer;
+
+RenderWorkers::RenderWorkers(unsigned int threads) :
+        _context(nullptr),
+        _call(nullptr),
+        _chunks(0),
+        _generation(0),
+        _pending(0),
+        _stop(false) {
+    resize(threads);
+}
+
+RenderWorkers::~RenderWorkers() {
+    stop();
+}
+
+void RenderWorkers::resize(unsigned int threads) {
+    stop();
+
+    _stop = false;
+
+    // Chunk 0 is always done by the calling thread
+    for (unsigned int chunk = 1; chunk < threads; chunk++) {
+        _workers.emplace_back(&RenderWorkers::work, this, chunk, _generation);
+    }
+}
+
+unsigned int RenderWorkers::threads() const {
+    return _workers.size() + 1;
+}
+
+void RenderWorkers::start(unsigned int chunks, void* context, void (*call)(void*, unsigned int)) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _context = context;
+        _call = call;
+        _chunks = std::min(chunks, threads());
+        _pending = _chunks - 1;
+        _generation++;
+    }
+
+    _started.notify_all();
+}
+
+void RenderWorkers::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [this]() {
+        return _pending == 0;
+    });
+}
+
+void RenderWorkers::work(unsigned int chunk, unsigned long generation) {
+    while (true) {
+        void* context;
+        void (*call)(void*, unsigned int);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _started.wait(lock, [&]() {
+                return _stop || _generation != generation;
+            });
+
+            if (_stop) {
+                return;
+            }
+
+            generation = _generation;
+
+            // Not needed for this run
+            if (chunk >= _chunks) {
+                continue;
+            }
+
+            context = _context;
+            call = _call;
+        }
+
+        call(context, chunk);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            last = --_pending == 0;
+        }
+
+        if (last) {
+            _finished.notify_one();
+        }
+    }
+}
+
+void RenderWorkers::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+
+    _started.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+
+    _workers.clear();
+}
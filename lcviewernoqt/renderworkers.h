@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lc {
+    namespace viewer {
+        /**
+         * @brief RenderWorkers
+         * Threads kept alive between frames, so render doesn't have to start new threads for each frame.
+         * The work of a frame is split in chunks, the first chunk is done by the thread calling run and each
+         * other chunk by one of the workers.
+         */
+        class RenderWorkers {
+            public:
+                /**
+                 * @param threads number of chunks which can run at the same time, including the calling thread
+                 */
+                explicit RenderWorkers(unsigned int threads);
+
+                RenderWorkers(const RenderWorkers&) = delete;
+                RenderWorkers& operator=(const RenderWorkers&) = delete;
+
+                ~RenderWorkers();
+
+                /**
+                 * @brief Change the number of chunks which can run at the same time
+                 * Stops the current workers and starts new ones, it must not be called during run
+                 */
+                void resize(unsigned int threads);
+
+                /**
+                 * @return number of chunks which can run at the same time, including the calling thread
+                 */
+                unsigned int threads() const;
+
+                /**
+                 * @brief Call task(chunk) for each chunk and wait until all of them are done
+                 * @param chunks number of chunks, at most threads()
+                 * @param task function called with the index of the chunk, from multiple threads
+                 */
+                template<typename T>
+                void run(unsigned int chunks, T& task) {
+                    if (chunks <= 1 || _workers.empty()) {
+                        for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+                            task(chunk);
+                        }
+
+                        return;
+                    }
+
+                    start(chunks, &task, [](void* context, unsigned int chunk) {
+                        (*static_cast<T*>(context))(chunk);
+                    });
+
+                    task(0);
+
+                    wait();
+                }
+
+            private:
+                void start(unsigned int chunks, void* context, void (*call)(void*, unsigned int));
+                void wait();
+                void work(unsigned int chunk, unsigned long generation);
+                void stop();
+
+                std::vector<std::thread> _workers;
+
+                std::mutex _mutex;
+                std::condition_variable _started;
+                std::condition_variable _finished;
+
+                // Task of the current frame, the task is not copied so this doesn't allocate
+                void* _context;
+                void (*_call)(void*, unsigned int);
+                unsigned int _chunks;
+                // Incremented for each run, workers compare it to the last one they have seen
+                unsigned long _generation;
+                // Number of chunks of the current run still being done by a worker
+                unsigned int _pending;
+                bool _stop;
+        };
+    }
+}
@@ -0,0 +1,240 @@
+#include "tilecache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace lc::viewer;
+
+// Lines of entities outside a tile can still draw into it, the margin is at least this number of device units
+static const double MINIMUM_TILE_MARGIN = 8.;
+
+// Larger sets of changed entities invalidate the area containing all of them instead of the area of each entity
+static const size_t MAXIMUM_INVALIDATED_ENTITIES = 64;
+
+TileCache::TileCache(DocumentCanvas_SPtr documentCanvas, PainterFactory createPainter,
+                     size_t maximumBytes, unsigned int tileSize) :
+        _documentCanvas(std::move(documentCanvas)),
+        _createPainter(std::move(createPainter)),
+        _maximumBytes(maximumBytes),
+        _tileSize(tileSize),
+        _margin(MINIMUM_TILE_MARGIN),
+        _renderedTiles(0) {
+
+    auto document = _documentCanvas->document();
+    document->addEntityEvent().connect<TileCache, &TileCache::on_addEntityEvent>(this);
+    document->removeEntityEvent().connect<TileCache, &TileCache::on_removeEntityEvent>(this);
+    document->addEntitiesEvent().connect<TileCache, &TileCache::on_addEntitiesEvent>(this);
+    document->removeEntitiesEvent().connect<TileCache, &TileCache::on_removeEntitiesEvent>(this);
+    document->replaceEntityEvent().connect<TileCache, &TileCache::on_replaceEntityEvent>(this);
+    document->replaceLayerEvent().connect<TileCache, &TileCache::on_replaceLayerEvent>(this);
+    document->replaceLinePatternEvent().connect<TileCache, &TileCache::on_replaceLinePatternEvent>(this);
+    _documentCanvas->selectionChanged().connect<TileCache, &TileCache::on_selectionChanged>(this);
+    _documentCanvas->drawOptionsChanged().connect<TileCache, &TileCache::clear>(this);
+}
+
+TileCache::~TileCache() {
+    auto document = _documentCanvas->document();
+    document->addEntityEvent().disconnect<TileCache, &TileCache::on_addEntityEvent>(this);
+    document->removeEntityEvent().disconnect<TileCache, &TileCache::on_removeEntityEvent>(this);
+    document->addEntitiesEvent().disconnect<TileCache, &TileCache::on_addEntitiesEvent>(this);
+    document->removeEntitiesEvent().disconnect<TileCache, &TileCache::on_removeEntitiesEvent>(this);
+    document->replaceEntityEvent().disconnect<TileCache, &TileCache::on_replaceEntityEvent>(this);
+    document->replaceLayerEvent().disconnect<TileCache, &TileCache::on_replaceLayerEvent>(this);
+    document->replaceLinePatternEvent().disconnect<TileCache, &TileCache::on_replaceLinePatternEvent>(this);
+    _documentCanvas->selectionChanged().disconnect<TileCache, &TileCache::on_selectionChanged>(this);
+    _documentCanvas->drawOptionsChanged().disconnect<TileCache, &TileCache::clear>(this);
+}
+
+void TileCache::render(LcPainter& painter, unsigned char* data, unsigned int width, unsigned int height) {
+    const double scale = painter.scale();
+
+    // The half of a line sticking out of its entity must fit in the margin,
+    // tiles rendered with a smaller margin can miss a part of the wider lines added since
+    const double margin = std::max(MINIMUM_TILE_MARGIN, _documentCanvas->maximumStrokeWidth());
+    if (margin > _margin) {
+        clear();
+        _margin = margin;
+    }
+
+    // Tiles are aligned on the device location of the user origin, so they can be reused while panning
+    double originX = 0.;
+    double originY = 0.;
+    painter.user_to_device(&originX, &originY);
+    const long offsetX = std::lround(originX);
+    const long offsetY = std::lround(originY);
+
+    const double size = _tileSize;
+    const long firstX = (long) std::floor(-offsetX / size);
+    const long lastX = (long) std::floor(((long) width - 1 - offsetX) / size);
+    const long firstY = (long) std::floor(-offsetY / size);
+    const long lastY = (long) std::floor(((long) height - 1 - offsetY) / size);
+
+    for (long y = firstY; y <= lastY; y++) {
+        for (long x = firstX; x <= lastX; x++) {
+            blit(tile({scale, x, y}), x * _tileSize + offsetX, y * _tileSize + offsetY, data, width, height);
+            evict();
+        }
+    }
+}
+
+const TileCache::Tile& TileCache::tile(const TileKey& key) {
+    auto it = _tiles.find(key);
+
+    if (it != _tiles.end()) {
+        _lru.splice(_lru.begin(), _lru, it->second.lru);
+        return it->second;
+    }
+
+    _lru.push_front(key);
+
+    Tile& tile = _tiles[key];
+    tile.lru = _lru.begin();
+    renderTile(key, tile);
+
+    return tile;
+}
+
+void TileCache::renderTile(const TileKey& key, Tile& tile) {
+    tile.pixels.assign(tileBytes(), 0);
+
+    std::unique_ptr<LcPainter> painter(_createPainter(tile.pixels.data(), _tileSize, _tileSize));
+    painter->reset_transformations();
+    painter->scale(key.scale);
+    painter->translate(-(double) key.x * _tileSize / key.scale, -(double) key.y * _tileSize / key.scale);
+
+    double minX = 0.;
+    double minY = 0.;
+    double maxX = _tileSize;
+    double maxY = _tileSize;
+    painter->device_to_user(&minX, &minY);
+    painter->device_to_user(&maxX, &maxY);
+    tile.area = lc::geo::Area(lc::geo::Coordinate(minX, minY), lc::geo::Coordinate(maxX, maxY));
+
+    _documentCanvas->render(*painter, VIEWER_DOCUMENT, tile.area.increaseBy(_margin / key.scale));
+    _renderedTiles++;
+}
+
+void TileCache::blit(const Tile& tile, long x, long y, unsigned char* data, unsigned int width, unsigned int height) const {
+    const long left = std::max(0L, x);
+    const long right = std::min((long) width, x + (long) _tileSize);
+    const long top = std::max(0L, y);
+    const long bottom = std::min((long) height, y + (long) _tileSize);
+
+    if (left >= right || data == nullptr) {
+        return;
+    }
+
+    for (long row = top; row < bottom; row++) {
+        std::memcpy(data + (row * width + left) * 4,
+                    tile.pixels.data() + ((row - y) * _tileSize + (left - x)) * 4,
+                    (right - left) * 4);
+    }
+}
+
+void TileCache::evict() {
+    while (bytes() > _maximumBytes && _lru.size() > 1) {
+        _tiles.erase(_lru.back());
+        _lru.pop_back();
+    }
+}
+
+void TileCache::invalidate(const lc::geo::Area& area) {
+    for (auto it = _tiles.begin(); it != _tiles.end();) {
+        if (it->second.area.increaseBy(_margin / it->first.scale).overlaps(area)) {
+            _lru.erase(it->second.lru);
+            it = _tiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void TileCache::clear() {
+    _tiles.clear();
+    _lru.clear();
+}
+
+size_t TileCache::size() const {
+    return _tiles.size();
+}
+
+size_t TileCache::bytes() const {
+    return _tiles.size() * tileBytes();
+}
+
+size_t TileCache::tileBytes() const {
+    return (size_t) _tileSize * _tileSize * 4;
+}
+
+unsigned long TileCache::renderedTiles() const {
+    return _renderedTiles;
+}
+
+void TileCache::invalidateEntity(const lc::entity::CADEntity_CSPtr& entity) {
+    // Entities of a block are shown by each insert of the block
+    if (entity->block() != nullptr) {
+        clear();
+        return;
+    }
+
+    invalidate(entity->boundingBox());
+}
+
+void TileCache::invalidateEntities(const std::vector<lc::entity::CADEntity_CSPtr>& entities,
+                                   const std::vector<lc::meta::Block_CSPtr>& blocks) {
+    if (!blocks.empty()) {
+        clear();
+        return;
+    }
+
+    if (_tiles.empty() || entities.empty()) {
+        return;
+    }
+
+    if (entities.size() <= MAXIMUM_INVALIDATED_ENTITIES) {
+        for (const auto& entity : entities) {
+            invalidate(entity->boundingBox());
+        }
+        return;
+    }
+
+    auto area = entities.front()->boundingBox();
+    for (const auto& entity : entities) {
+        area = area.merge(entity->boundingBox());
+    }
+    invalidate(area);
+}
+
+void TileCache::on_addEntityEvent(const lc::event::AddEntityEvent& event) {
+    invalidateEntity(event.entity());
+}
+
+void TileCache::on_removeEntityEvent(const lc::event::RemoveEntityEvent& event) {
+    invalidateEntity(event.entity());
+}
+
+void TileCache::on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+    invalidateEntities(event.entities(), event.blocks());
+}
+
+void TileCache::on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent& event) {
+    invalidateEntities(event.entities(), event.blocks());
+}
+
+void TileCache::on_replaceEntityEvent(const lc::event::ReplaceEntityEvent& event) {
+    invalidateEntity(event.entity());
+}
+
+void TileCache::on_replaceLayerEvent(const lc::event::ReplaceLayerEvent& event) {
+    clear();
+}
+
+void TileCache::on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent& event) {
+    clear();
+}
+
+void TileCache::on_selectionChanged(const lc::geo::Area& area) {
+    invalidate(area);
+}
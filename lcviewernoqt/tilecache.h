@@ -0,0 +1,180 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <cad/geometry/geoarea.h>
+#include <cad/events/addentityevent.h>
+#include <cad/events/addentitiesevent.h>
+#include <cad/events/removeentityevent.h>
+#include <cad/events/removeentitiesevent.h>
+#include <cad/events/replaceentityevent.h>
+#include <cad/events/replacelayerevent.h>
+#include <cad/events/replacelinepatternevent.h>
+
+#include "documentcanvas.h"
+#include "painters/lcpainter.h"
+
+namespace lc {
+    namespace viewer {
+        /**
+         * @brief TileCache
+         * Cache of the rendered document, split in tiles of a fixed device size for each scale.
+         * Rendering copies the tiles into the target image, only tiles which are missing or touched
+         * by a change of the document are rendered again. Panning therefore only renders the tiles
+         * which scrolled into view.
+         * Tiles are evicted in least recently used order when the cache uses more memory than allowed.
+         * Changing the draw options of the canvas removes all tiles.
+         */
+        class TileCache {
+            public:
+                /**
+                 * @brief Function creating a painter which draws into an ARGB32 image of width x height
+                 */
+                using PainterFactory = std::function<LcPainter*(unsigned char* data, unsigned int width, unsigned int height)>;
+
+                static const size_t DEFAULT_MAXIMUM_BYTES = 64 * 1024 * 1024;
+                static const unsigned int DEFAULT_TILE_SIZE = 256;
+
+                /**
+                 * @param documentCanvas Canvas used to render the tiles
+                 * @param createPainter Factory for the painters of the tiles
+                 * @param maximumBytes Maximum memory used by the tiles
+                 * @param tileSize Width and height of a tile in device units
+                 */
+                TileCache(DocumentCanvas_SPtr documentCanvas,
+                          PainterFactory createPainter,
+                          size_t maximumBytes = DEFAULT_MAXIMUM_BYTES,
+                          unsigned int tileSize = DEFAULT_TILE_SIZE);
+
+                ~TileCache();
+
+                TileCache(const TileCache&) = delete;
+                TileCache& operator=(const TileCache&) = delete;
+
+                /**
+                 * @brief Draw the document into an ARGB32 image
+                 * The scale and translation of painter are used, the painter itself doesn't draw anything
+                 * @param painter Painter of the image
+                 * @param data Image data, 4 bytes per pixel without padding
+                 * @param width Width of the image
+                 * @param height Height of the image
+                 */
+                void render(LcPainter& painter, unsigned char* data, unsigned int width, unsigned int height);
+
+                /**
+                 * @brief Remove the tiles of all scales showing a part of area
+                 * @param area Area in user coordinates
+                 */
+                void invalidate(const lc::geo::Area& area);
+
+                /**
+                 * @brief Remove all tiles
+                 */
+                void clear();
+
+                /**
+                 * @return number of cached tiles
+                 */
+                size_t size() const;
+
+                /**
+                 * @return memory used by the cached tiles
+                 */
+                size_t bytes() const;
+
+                /**
+                 * @return number of tiles rendered since creation
+                 */
+                unsigned long renderedTiles() const;
+
+            private:
+                struct TileKey {
+                    double scale;
+                    long x;
+                    long y;
+
+                    bool operator==(const TileKey& other) const {
+                        return scale == other.scale && x == other.x && y == other.y;
+                    }
+                };
+
+                struct TileKeyHash {
+                    size_t operator()(const TileKey& key) const {
+                        size_t hash = std::hash<double>()(key.scale);
+                        hash = hash * 31 + std::hash<long>()(key.x);
+                        return hash * 31 + std::hash<long>()(key.y);
+                    }
+                };
+
+                struct Tile {
+                    std::vector<unsigned char> pixels;
+                    // Area shown by the tile, in user coordinates
+                    lc::geo::Area area;
+                    std::list<TileKey>::iterator lru;
+                };
+
+                /**
+                 * @brief Return a tile, rendering it when it's not cached
+                 */
+                const Tile& tile(const TileKey& key);
+
+                void renderTile(const TileKey& key, Tile& tile);
+
+                /**
+                 * @brief Copy a tile into the image, with its top left corner at x, y
+                 */
+                void blit(const Tile& tile, long x, long y, unsigned char* data, unsigned int width, unsigned int height) const;
+
+                /**
+                 * @brief Remove the least recently used tiles until the memory limit is respected
+                 */
+                void evict();
+
+                size_t tileBytes() const;
+
+                void on_addEntityEvent(const lc::event::AddEntityEvent&);
+
+                void on_removeEntityEvent(const lc::event::RemoveEntityEvent&);
+
+                void on_addEntitiesEvent(const lc::event::AddEntitiesEvent&);
+
+                void on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent&);
+
+                void on_replaceEntityEvent(const lc::event::ReplaceEntityEvent&);
+
+                void on_replaceLayerEvent(const lc::event::ReplaceLayerEvent&);
+
+                void on_replaceLinePatternEvent(const lc::event::ReplaceLinePatternEvent&);
+
+                void on_selectionChanged(const lc::geo::Area&);
+
+                void invalidateEntity(const lc::entity::CADEntity_CSPtr& entity);
+
+                /**
+                 * @brief Remove the tiles showing a set of entities
+                 * @param blocks Blocks of the entities, all tiles are removed when entities of a block changed
+                 */
+                void invalidateEntities(const std::vector<lc::entity::CADEntity_CSPtr>& entities,
+                                        const std::vector<lc::meta::Block_CSPtr>& blocks);
+
+                DocumentCanvas_SPtr _documentCanvas;
+                PainterFactory _createPainter;
+                size_t _maximumBytes;
+                unsigned int _tileSize;
+                // Device units around a tile from where entities are rendered into it
+                double _margin;
+
+                std::unordered_map<TileKey, Tile, TileKeyHash> _tiles;
+                // Most recently used tile first
+                std::list<TileKey> _lru;
+
+                unsigned long _renderedTiles;
+        };
+
+        DECLARE_SHORT_SHARED_PTR(TileCache)
+    }
+}
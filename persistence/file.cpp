@@ -12,6 +12,7 @@ void File::open(lc::storage::Document_SPtr document, const std::string& path, Fi
             DXFimpl F(document, builder);
             dxfRW R(path.c_str());
             R.read(&F, true);
+            F.finishImport();
             break;
         }
 
@@ -27,8 +28,8 @@ void File::open(lc::storage::Document_SPtr document, const std::string& path, Fi
 
 void File::save(lc::storage::Document_SPtr document, const std::string& path, File::Type type) {
     if(type >= LIBDXFRW_DXF_R12 && type <= LIBDXFRW_DXB_R2013) {
-        DXFimpl* F = new DXFimpl(std::move(document));
-        F->writeDXF(path, type);
+        DXFimpl F(std::move(document));
+        F.writeDXF(path, type);
     }
 }
 
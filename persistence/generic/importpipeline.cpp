@@ -0,0 +1,183 @@
+#include "importpipeline.h"
+
+using namespace lc::persistence;
+
+const size_t ImportPipeline::BATCH_SIZE;
+const size_t ImportPipeline::MAXIMUM_QUEUED_BATCHES;
+
+ImportPipeline::ImportPipeline(operation::EntityBuilder_SPtr entityBuilder, unsigned int workers) :
+        _entityBuilder(std::move(entityBuilder)),
+        _workerCount(workers),
+        _done(false) {
+    // One core is kept for the parser
+    if (_workerCount == 0) {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        _workerCount = cores > 1 ? cores - 1 : 0;
+    }
+
+    _records.reserve(BATCH_SIZE);
+}
+
+ImportPipeline::~ImportPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.clear();
+    }
+
+    stop();
+}
+
+void ImportPipeline::push(Record record) {
+    if (_workerCount == 0) {
+        if (_results.empty()) {
+            _results.emplace_back();
+        }
+
+        auto entity = record();
+        if (entity != nullptr) {
+            _results.back().push_back(std::move(entity));
+        }
+
+        return;
+    }
+
+    _records.push_back(std::move(record));
+
+    if (_records.size() >= BATCH_SIZE) {
+        submit();
+    }
+}
+
+size_t ImportPipeline::finish() {
+    if (_workers.empty()) {
+        // Nothing was queued, building the few entities here is faster than starting the workers
+        if (!_records.empty()) {
+            _results.emplace_back();
+            Batch batch{std::move(_records), &_results.back()};
+            _records.clear();
+            build(batch);
+        }
+    }
+    else {
+        submit();
+        stop();
+    }
+
+    if (_error) {
+        auto error = _error;
+        _error = nullptr;
+        _results.clear();
+        std::rethrow_exception(error);
+    }
+
+    size_t count = 0;
+    for (const auto& entities : _results) {
+        count += entities.size();
+    }
+
+    // The workers took IDs in the order they built the entities, give a range of IDs in the order of the file instead.
+    // The entities aren't shared with the document yet, so they can still be changed.
+    ID_DATATYPE id = entity::ID::__idCounter.fetch_add(count) + 1;
+
+    for (auto& entities : _results) {
+        for (auto& entity : entities) {
+            std::const_pointer_cast<entity::CADEntity>(entity)->setID(id++);
+            _entityBuilder->appendEntity(std::move(entity));
+        }
+    }
+    _results.clear();
+
+    return count;
+}
+
+void ImportPipeline::submit() {
+    if (_records.empty()) {
+        return;
+    }
+
+    // The workers only access their own slot, so adding slots doesn't need the lock
+    _results.emplace_back();
+    Batch batch{std::move(_records), &_results.back()};
+    _records.clear();
+    _records.reserve(BATCH_SIZE);
+
+    if (_workers.empty()) {
+        _workers.reserve(_workerCount);
+        for (unsigned int i = 0; i < _workerCount; i++) {
+            _workers.emplace_back(&ImportPipeline::work, this);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() {
+            return _queue.size() < MAXIMUM_QUEUED_BATCHES;
+        });
+        _queue.push_back(std::move(batch));
+    }
+
+    _notEmpty.notify_one();
+}
+
+void ImportPipeline::work() {
+    while (true) {
+        Batch batch;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _notEmpty.wait(lock, [this]() {
+                return !_queue.empty() || _done;
+            });
+
+            if (_queue.empty()) {
+                return;
+            }
+
+            batch = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        _notFull.notify_one();
+
+        try {
+            build(batch);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+    }
+}
+
+void ImportPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+
+    _notEmpty.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+
+    _workers.clear();
+    _done = false;
+}
+
+void ImportPipeline::build(Batch& batch) {
+    batch.entities->reserve(batch.records.size());
+
+    for (const auto& record : batch.records) {
+        auto entity = record();
+
+        if (entity != nullptr) {
+            batch.entities->push_back(std::move(entity));
+        }
+    }
+
+    // Release the values captured by the records on the worker
+    batch.records.clear();
+}
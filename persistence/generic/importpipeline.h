@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cad/base/cadentity.h>
+#include <cad/operations/entitybuilder.h>
+
+namespace lc {
+    namespace persistence {
+        /**
+         * @brief The ImportPipeline class
+         * Build the entities of a file on worker threads while the file is being parsed.
+         * The parser pushes records, functions creating one entity from the values read from the file, which are
+         * grouped in batches and put in a bounded queue. Workers take the batches and build the entities, including
+         * the geometry the entities compute when they are created, like their bounding box.
+         * finish() appends the entities to the EntityBuilder in the order of the file, so they get inserted in
+         * the document as a single bulk insert. The IDs of the entities are given by finish() in the same order, so
+         * they don't depend on the order the workers finished.
+         * The workers are started when the first batch is full, small files are built by finish() instead.
+         */
+        class ImportPipeline {
+            public:
+                /**
+                 * @brief Function building a entity, returning nullptr skips the entity
+                 * Records are called on a worker thread, so they should not access the document.
+                 * The ID of the entity is replaced by finish().
+                 */
+                using Record = std::function<entity::CADEntity_CSPtr()>;
+
+                /**
+                 * @brief Number of records given to a worker at once
+                 */
+                static const size_t BATCH_SIZE = 256;
+
+                /**
+                 * @brief Maximum number of batches waiting for a worker, the parser waits when the queue is full
+                 */
+                static const size_t MAXIMUM_QUEUED_BATCHES = 64;
+
+                /**
+                 * @param entityBuilder receiving the entities
+                 * @param workers number of worker threads, 0 to use all cores except the one of the parser
+                 */
+                explicit ImportPipeline(operation::EntityBuilder_SPtr entityBuilder, unsigned int workers = 0);
+
+                ImportPipeline(const ImportPipeline&) = delete;
+                ImportPipeline& operator=(const ImportPipeline&) = delete;
+
+                /**
+                 * @brief Stop the workers, entities which are not finished are dropped
+                 */
+                ~ImportPipeline();
+
+                /**
+                 * @brief Add a entity to build
+                 * Must be called from a single thread. Without workers the record is called immediately,
+                 * so a exception is thrown here instead of by finish().
+                 */
+                void push(Record record);
+
+                /**
+                 * @brief Wait until all entities are built and append them to the EntityBuilder
+                 * The entities get new consecutive IDs in the order of the file.
+                 * A exception thrown by a record is thrown again here.
+                 * @return number of entities appended
+                 */
+                size_t finish();
+
+            private:
+                struct Batch {
+                    std::vector<Record> records;
+                    // Slot in _results, which keeps the order of the file
+                    std::vector<entity::CADEntity_CSPtr>* entities = nullptr;
+                };
+
+                void submit();
+                void work();
+                void stop();
+
+                static void build(Batch& batch);
+
+                operation::EntityBuilder_SPtr _entityBuilder;
+                unsigned int _workerCount;
+                std::vector<std::thread> _workers;
+
+                std::vector<Record> _records;
+                std::deque<std::vector<entity::CADEntity_CSPtr>> _results;
+
+                std::mutex _mutex;
+                std::condition_variable _notEmpty;
+                std::condition_variable _notFull;
+                std::deque<Batch> _queue;
+                bool _done;
+                std::exception_ptr _error;
+        };
+    }
+}
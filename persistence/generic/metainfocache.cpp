@@ -0,0 +1,35 @@
+#include "metainfocache.h"
+
+using namespace lc::persistence;
+
+lc::meta::MetaInfo_CSPtr MetaInfoCache::metaInfo(const meta::MetaColor_CSPtr& color,
+                                                 const meta::MetaLineWidth_CSPtr& lineWidth,
+                                                 const meta::DxfLinePattern_CSPtr& linePattern) {
+    if (color == nullptr && lineWidth == nullptr && linePattern == nullptr) {
+        return nullptr;
+    }
+
+    Key key{color.get(), lineWidth.get(), linePattern.get()};
+
+    auto it = _metaInfos.find(key);
+    if (it != _metaInfos.end()) {
+        return it->second;
+    }
+
+    auto metaInfo = meta::MetaInfo::create();
+
+    if (lineWidth != nullptr) {
+        metaInfo->add(lineWidth);
+    }
+
+    if (color != nullptr) {
+        metaInfo->add(color);
+    }
+
+    if (linePattern != nullptr) {
+        metaInfo->add(linePattern);
+    }
+
+    _metaInfos.emplace(key, metaInfo);
+    return metaInfo;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <unordered_map>
+#include <cad/base/metainfo.h>
+#include <cad/meta/metacolor.h>
+#include <cad/meta/metalinewidth.h>
+#include <cad/meta/dxflinepattern.h>
+
+namespace lc {
+    namespace persistence {
+        /**
+         * @brief The MetaInfoCache class
+         * Share the MetaInfo of entities during a import.
+         * Most drawings only use a few combinations of color, line width and line pattern, so one MetaInfo
+         * is created for each combination instead of one for each entity.
+         * The meta types are compared by pointer, so they should be shared as well.
+         */
+        class MetaInfoCache {
+            public:
+                /**
+                 * @brief Return the MetaInfo containing the meta types which are not nullptr
+                 * @return shared MetaInfo, or nullptr when all meta types are nullptr
+                 */
+                meta::MetaInfo_CSPtr metaInfo(const meta::MetaColor_CSPtr& color,
+                                              const meta::MetaLineWidth_CSPtr& lineWidth,
+                                              const meta::DxfLinePattern_CSPtr& linePattern);
+
+                /**
+                 * @return number of distinct MetaInfo
+                 */
+                size_t size() const {
+                    return _metaInfos.size();
+                }
+
+            private:
+                struct Key {
+                    const void* color;
+                    const void* lineWidth;
+                    const void* linePattern;
+
+                    bool operator==(const Key& other) const {
+                        return color == other.color && lineWidth == other.lineWidth && linePattern == other.linePattern;
+                    }
+                };
+
+                struct KeyHash {
+                    size_t operator()(const Key& key) const {
+                        size_t hash = std::hash<const void*>()(key.color);
+                        hash = hash * 31 + std::hash<const void*>()(key.lineWidth);
+                        return hash * 31 + std::hash<const void*>()(key.linePattern);
+                    }
+                };
+
+                // The MetaInfo keeps the meta types alive, so the pointers of a key can't be reused
+                std::unordered_map<Key, meta::MetaInfo_CSPtr, KeyHash> _metaInfos;
+        };
+    }
+}
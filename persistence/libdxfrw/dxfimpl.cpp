@@ -36,7 +36,8 @@ DXFimpl::DXFimpl(std::shared_ptr<lc::storage::Document> document, lc::operation:
         _builder(std::move(builder)),
         _entityBuilder(std::make_shared<lc::operation::EntityBuilder>(document)),
         _currentBlock(nullptr),
-        dxfW(nullptr) {
+        dxfW(nullptr),
+        _pipeline(_entityBuilder) {
     _builder->append(_entityBuilder);
 }
 
@@ -117,61 +118,94 @@ void DXFimpl::endBlock() {
 }
 
 void DXFimpl::addLine(const DRW_Line& data) {
-    lc::builder::LineBuilder builder;
-
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setBlock(_currentBlock);
-    builder.setLayer(_document->layerByName(data.layer));
-    builder.setStart(coord(data.basePoint));
-    builder.setEnd(coord(data.secPoint));
-
-    _entityBuilder->appendEntity(builder.build());
+    auto metaInfo = getMetaInfo(data);
+    auto layer = getLayer(data.layer);
+    auto block = _currentBlock;
+    auto start = coord(data.basePoint);
+    auto end = coord(data.secPoint);
+
+    _pipeline.push([metaInfo, layer, block, start, end]() {
+        lc::builder::LineBuilder builder;
+
+        builder.setMetaInfo(metaInfo);
+        builder.setBlock(block);
+        builder.setLayer(layer);
+        builder.setStart(start);
+        builder.setEnd(end);
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addCircle(const DRW_Circle& data) {
-    lc::builder::CircleBuilder builder;
-
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setLayer(_document->layerByName(data.layer));
-    builder.setCenter(coord(data.basePoint));
-    builder.setRadius(data.radious);
-    builder.setBlock(_currentBlock);
-
-    _entityBuilder->appendEntity(builder.build());
+    auto metaInfo = getMetaInfo(data);
+    auto layer = getLayer(data.layer);
+    auto block = _currentBlock;
+    auto center = coord(data.basePoint);
+    auto radius = data.radious;
+
+    _pipeline.push([metaInfo, layer, block, center, radius]() {
+        lc::builder::CircleBuilder builder;
+
+        builder.setMetaInfo(metaInfo);
+        builder.setLayer(layer);
+        builder.setCenter(center);
+        builder.setRadius(radius);
+        builder.setBlock(block);
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addArc(const DRW_Arc& data) {
-    lc::builder::ArcBuilder builder;
-
-    builder.setMetaInfo(getMetaInfo(data));
-    builder.setLayer(_document->layerByName(data.layer));
-    builder.setBlock(_currentBlock);
-    builder.setCenter(coord(data.basePoint));
-    builder.setRadius(data.radious);
-    builder.setStartAngle(data.staangle);
-    builder.setEndAngle(data.endangle);
-    builder.setIsCCW((bool) data.isccw);
-
-    _entityBuilder->appendEntity(builder.build());
+    auto metaInfo = getMetaInfo(data);
+    auto layer = getLayer(data.layer);
+    auto block = _currentBlock;
+    auto center = coord(data.basePoint);
+    auto radius = data.radious;
+    auto startAngle = data.staangle;
+    auto endAngle = data.endangle;
+    auto isCCW = (bool) data.isccw;
+
+    _pipeline.push([metaInfo, layer, block, center, radius, startAngle, endAngle, isCCW]() {
+        lc::builder::ArcBuilder builder;
+
+        builder.setMetaInfo(metaInfo);
+        builder.setLayer(layer);
+        builder.setBlock(block);
+        builder.setCenter(center);
+        builder.setRadius(radius);
+        builder.setStartAngle(startAngle);
+        builder.setEndAngle(endAngle);
+        builder.setIsCCW(isCCW);
+
+        return builder.build();
+    });
 }
 
 void DXFimpl::addEllipse(const DRW_Ellipse& data) {
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    auto layer = _document->layerByName(data.layer);
-
+    auto metaInfo = getMetaInfo(data);
+    auto layer = getLayer(data.layer);
+    auto block = _currentBlock;
+    auto center = coord(data.basePoint);
     auto secPoint = coord(data.secPoint);
-    auto lcEllipse = std::make_shared<lc::entity::Ellipse>(coord(data.basePoint),
-                                                           secPoint,
-                                                           secPoint.magnitude() * data.ratio,
-                                                           data.staparam,
-                                                           data.endparam,
-                                                           data.isccw,
-                                                           layer,
-                                                           mf,
-                                                           _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcEllipse);
+    auto ratio = data.ratio;
+    auto startAngle = data.staparam;
+    auto endAngle = data.endparam;
+    auto isCCW = (bool) data.isccw;
+
+    _pipeline.push([metaInfo, layer, block, center, secPoint, ratio, startAngle, endAngle, isCCW]() {
+        return std::make_shared<lc::entity::Ellipse>(center,
+                                                     secPoint,
+                                                     secPoint.magnitude() * ratio,
+                                                     startAngle,
+                                                     endAngle,
+                                                     isCCW,
+                                                     layer,
+                                                     metaInfo,
+                                                     block
+        );
+    });
 }
 
 void DXFimpl::addLayer(const DRW_Layer& data) {
@@ -200,14 +234,21 @@ void DXFimpl::addLayer(const DRW_Layer& data) {
         auto al = std::make_shared<lc::operation::AddLayer>(_document, layer);
         _builder->append(al);
     }
+    else {
+        return;
+    }
+
+    _layers[data.name] = layer;
+    _layerByName.clear();
 }
 
 void DXFimpl::addSpline(const DRW_Spline* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
 
     // http://discourse.mcneel.com/t/creating-on-nurbscurve-from-control-points-and-knot-vector/12928/3
     auto knotList = data->knotslist;
@@ -215,181 +256,263 @@ void DXFimpl::addSpline(const DRW_Spline* data) {
         knotList.erase(knotList.begin());
         knotList.pop_back();
     }
-    auto lcSpline = std::make_shared<lc::entity::Spline>(coords(data->controllist),
-                                                         knotList,
-                                                         coords(data->fitlist),
-                                                         data->degree,
-                                                         false,
-                                                         data->tolfit,
-                                                         data->tgStart.x, data->tgStart.y, data->tgStart.z,
-                                                         data->tgEnd.x, data->tgEnd.y, data->tgEnd.z,
-                                                         data->normalVec.x, data->normalVec.y, data->normalVec.z,
-                                                         static_cast<lc::geo::Spline::splineflag>(data->flags),
-                                                         layer,
-                                                         mf,
-                                                         _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcSpline);
+
+    // The control and fit points are owned by data, copy them before it's deleted
+    _pipeline.push([metaInfo, layer, block, knotList,
+                    controlPoints = coords(data->controllist),
+                    fitPoints = coords(data->fitlist),
+                    degree = data->degree,
+                    tolfit = data->tolfit,
+                    tgStart = coord(data->tgStart),
+                    tgEnd = coord(data->tgEnd),
+                    normal = coord(data->normalVec),
+                    flags = static_cast<lc::geo::Spline::splineflag>(data->flags)]() {
+        return std::make_shared<lc::entity::Spline>(controlPoints,
+                                                    knotList,
+                                                    fitPoints,
+                                                    degree,
+                                                    false,
+                                                    tolfit,
+                                                    tgStart.x(), tgStart.y(), tgStart.z(),
+                                                    tgEnd.x(), tgEnd.y(), tgEnd.z(),
+                                                    normal.x(), normal.y(), normal.z(),
+                                                    flags,
+                                                    layer,
+                                                    metaInfo,
+                                                    block
+        );
+    });
 }
 
 void DXFimpl::addText(const DRW_Text& data) {
-    auto layer = _document->layerByName(data.layer);
+    auto layer = getLayer(data.layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    auto lcText = std::make_shared<lc::entity::Text>(coord(data.basePoint),
-                                                     data.text, data.height,
-                                                     data.angle, data.style,
-                                                     lc::TextConst::DrawingDirection(data.textgen),
-                                                     lc::TextConst::HAlign(data.alignH),
-                                                     lc::TextConst::VAlign(data.alignV),
-                                                     layer,
-                                                     mf,
-                                                     _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcText);
+    auto metaInfo = getMetaInfo(data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    insertionPoint = coord(data.basePoint),
+                    text = data.text,
+                    height = data.height,
+                    angle = data.angle,
+                    style = data.style,
+                    textgen = data.textgen,
+                    alignH = data.alignH,
+                    alignV = data.alignV]() {
+        return std::make_shared<lc::entity::Text>(insertionPoint,
+                                                  text, height,
+                                                  angle, style,
+                                                  lc::TextConst::DrawingDirection(textgen),
+                                                  lc::TextConst::HAlign(alignH),
+                                                  lc::TextConst::VAlign(alignV),
+                                                  layer,
+                                                  metaInfo,
+                                                  block
+        );
+    });
 }
 
 void DXFimpl::addPoint(const DRW_Point& data) {
-    auto layer = _document->layerByName(data.layer);
+    auto layer = getLayer(data.layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
-    auto lcPoint = std::make_shared<lc::entity::Point>(coord(data.basePoint),
-                                                       layer,
-                                                       mf,
-                                                       _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcPoint);
+    auto metaInfo = getMetaInfo(data);
+    auto block = _currentBlock;
+    auto position = coord(data.basePoint);
+
+    _pipeline.push([metaInfo, layer, block, position]() {
+        return std::make_shared<lc::entity::Point>(position,
+                                                   layer,
+                                                   metaInfo,
+                                                   block
+        );
+    });
 }
 
 void DXFimpl::addDimAlign(const DRW_DimAligned* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimAligned = std::make_shared<lc::entity::DimAligned>(
-            coord(data->getDefPoint()),
-            coord(data->getTextPoint()),
-            static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-            data->getDir(),
-            data->getTextLineFactor(),
-            static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-            data->getText(),
-            coord(data->getDef1Point()),
-            coord(data->getDef2Point()),
-            layer,
-            mf,
-            _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcDimAligned);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    definitionPoint = coord(data->getDefPoint()),
+                    middleOfText = coord(data->getTextPoint()),
+                    attachmentPoint = static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                    textAngle = data->getDir(),
+                    lineSpacingFactor = data->getTextLineFactor(),
+                    lineSpacingStyle = static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                    explicitValue = data->getText(),
+                    definitionPoint2 = coord(data->getDef1Point()),
+                    definitionPoint3 = coord(data->getDef2Point())]() {
+        return std::make_shared<lc::entity::DimAligned>(
+                definitionPoint,
+                middleOfText,
+                attachmentPoint,
+                textAngle,
+                lineSpacingFactor,
+                lineSpacingStyle,
+                explicitValue,
+                definitionPoint2,
+                definitionPoint3,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addDimLinear(const DRW_DimLinear* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimLinear = std::make_shared<lc::entity::DimLinear>(
-            coord(data->getDefPoint()),
-            coord(data->getTextPoint()),
-            static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-            data->getDir(),
-            data->getTextLineFactor(),
-            static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-            data->getText(),
-            coord(data->getDef1Point()),
-            coord(data->getDef2Point()),
-            data->getAngle(),
-            data->getOblique(),
-            layer,
-            mf,
-            _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcDimLinear);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    definitionPoint = coord(data->getDefPoint()),
+                    middleOfText = coord(data->getTextPoint()),
+                    attachmentPoint = static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                    textAngle = data->getDir(),
+                    lineSpacingFactor = data->getTextLineFactor(),
+                    lineSpacingStyle = static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                    explicitValue = data->getText(),
+                    definitionPoint2 = coord(data->getDef1Point()),
+                    definitionPoint3 = coord(data->getDef2Point()),
+                    angle = data->getAngle(),
+                    oblique = data->getOblique()]() {
+        return std::make_shared<lc::entity::DimLinear>(
+                definitionPoint,
+                middleOfText,
+                attachmentPoint,
+                textAngle,
+                lineSpacingFactor,
+                lineSpacingStyle,
+                explicitValue,
+                definitionPoint2,
+                definitionPoint3,
+                angle,
+                oblique,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addDimRadial(const DRW_DimRadial* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto  lcDimRadial = std::make_shared<lc::entity::DimRadial>(
-             coord(data->getCenterPoint()),
-             coord(data->getTextPoint()),
-             static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-             data->getDir(),
-             data->getTextLineFactor(),
-             static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-             data->getText(),
-             coord(data->getDiameterPoint()),
-             data->getLeaderLength(),
-             layer,
-             mf,
-             _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcDimRadial);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    definitionPoint = coord(data->getCenterPoint()),
+                    middleOfText = coord(data->getTextPoint()),
+                    attachmentPoint = static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                    textAngle = data->getDir(),
+                    lineSpacingFactor = data->getTextLineFactor(),
+                    lineSpacingStyle = static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                    explicitValue = data->getText(),
+                    definitionPoint2 = coord(data->getDiameterPoint()),
+                    leader = data->getLeaderLength()]() {
+        return std::make_shared<lc::entity::DimRadial>(
+                definitionPoint,
+                middleOfText,
+                attachmentPoint,
+                textAngle,
+                lineSpacingFactor,
+                lineSpacingStyle,
+                explicitValue,
+                definitionPoint2,
+                leader,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addDimDiametric(const DRW_DimDiametric* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimDiametric = std::make_shared<lc::entity::DimDiametric>(
-             coord(data->getDiameter1Point()),
-             coord(data->getTextPoint()),
-             static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-             data->getDir(),
-             data->getTextLineFactor(),
-             static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-             data->getText(),
-             coord(data->getDiameter2Point()),
-             data->getLeaderLength(),
-             layer,
-             mf,
-             _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcDimDiametric);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    definitionPoint = coord(data->getDiameter1Point()),
+                    middleOfText = coord(data->getTextPoint()),
+                    attachmentPoint = static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                    textAngle = data->getDir(),
+                    lineSpacingFactor = data->getTextLineFactor(),
+                    lineSpacingStyle = static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                    explicitValue = data->getText(),
+                    definitionPoint2 = coord(data->getDiameter2Point()),
+                    leader = data->getLeaderLength()]() {
+        return std::make_shared<lc::entity::DimDiametric>(
+                definitionPoint,
+                middleOfText,
+                attachmentPoint,
+                textAngle,
+                lineSpacingFactor,
+                lineSpacingStyle,
+                explicitValue,
+                definitionPoint2,
+                leader,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addDimAngular(const DRW_DimAngular* data) {
-    auto layer = _document->layerByName(data->layer);
+    auto layer = getLayer(data->layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*data);
-    auto lcDimAngular = std::make_shared<lc::entity::DimAngular>(
-             coord(data->getDefPoint()),
-             coord(data->getTextPoint()),
-             static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
-             data->getDir(),
-             data->getTextLineFactor(),
-             static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
-             data->getText(),
-             coord(data->getFirstLine1()),
-             coord(data->getFirstLine2()),
-             coord(data->getSecondLine1()),
-             coord(data->getSecondLine2()),
-             layer,
-             mf,
-             _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcDimAngular);
+    auto metaInfo = getMetaInfo(*data);
+    auto block = _currentBlock;
+
+    _pipeline.push([metaInfo, layer, block,
+                    definitionPoint = coord(data->getDefPoint()),
+                    middleOfText = coord(data->getTextPoint()),
+                    attachmentPoint = static_cast<lc::TextConst::AttachmentPoint>(data->getAlign()),
+                    textAngle = data->getDir(),
+                    lineSpacingFactor = data->getTextLineFactor(),
+                    lineSpacingStyle = static_cast<lc::TextConst::LineSpacingStyle>(data->getTextLineStyle()),
+                    explicitValue = data->getText(),
+                    firstLine1 = coord(data->getFirstLine1()),
+                    firstLine2 = coord(data->getFirstLine2()),
+                    secondLine1 = coord(data->getSecondLine1()),
+                    secondLine2 = coord(data->getSecondLine2())]() {
+        return std::make_shared<lc::entity::DimAngular>(
+                definitionPoint,
+                middleOfText,
+                attachmentPoint,
+                textAngle,
+                lineSpacingFactor,
+                lineSpacingStyle,
+                explicitValue,
+                firstLine1,
+                firstLine2,
+                secondLine1,
+                secondLine2,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addDimAngular3P(const DRW_DimAngular3p* data) {
@@ -403,31 +526,38 @@ void DXFimpl::addDimOrdinate(const DRW_DimOrdinate* data) {
 }
 
 void DXFimpl::addLWPolyline(const DRW_LWPolyline& data) {
-    auto layer = _document->layerByName(data.layer);
+    auto layer = getLayer(data.layer);
     if (layer==nullptr) {
         return;
     }
-    std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(data);
+    auto metaInfo = getMetaInfo(data);
+    auto block = _currentBlock;
 
     std::vector<lc::entity::LWVertex2D> points;
+    points.reserve(data.vertlist.size());
     for (const auto& i : data.vertlist) {
         points.emplace_back(lc::geo::Coordinate(i->x, i->y), i->bulge, i->stawidth, i->endwidth);
     }
 
-    auto isCLosed = (unsigned int) data.flags & 0x01u;
-    auto lcLWPolyline = std::make_shared<lc::entity::LWPolyline>(
-            points,
-            data.width,
-            data.elevation,
-            data.thickness,
-            isCLosed,
-            coord(data.extPoint),
-            layer,
-            mf,
-            _currentBlock
-    );
-
-    _entityBuilder->appendEntity(lcLWPolyline);
+    _pipeline.push([metaInfo, layer, block,
+                    points = std::move(points),
+                    width = data.width,
+                    elevation = data.elevation,
+                    thickness = data.thickness,
+                    isClosed = ((unsigned int) data.flags & 0x01u) != 0,
+                    extrusion = coord(data.extPoint)]() {
+        return std::make_shared<lc::entity::LWPolyline>(
+                points,
+                width,
+                elevation,
+                thickness,
+                isClosed,
+                extrusion,
+                layer,
+                metaInfo,
+                block
+        );
+    });
 }
 
 void DXFimpl::addPolyline(const DRW_Polyline& data) {
@@ -442,56 +572,74 @@ void DXFimpl::addHatch(const DRW_Hatch* data) {
 }
 
 
-lc::meta::MetaInfo_SPtr DXFimpl::getMetaInfo(const DRW_Entity& data) const {
-    std::shared_ptr<lc::meta::MetaInfo> mf = nullptr;
-
-    // Try to find a entities meta line weight
-    auto lw = getLcLineWidth<lc::meta::MetaLineWidth>(data.lWeight);
-    if (lw != nullptr) {
-        if (mf == nullptr) {
-            mf = lc::meta::MetaInfo::create();
+lc::meta::MetaInfo_CSPtr DXFimpl::getMetaInfo(const DRW_Entity& data) {
+    lc::meta::MetaColor_CSPtr color;
+    if(data.color == BYBLOCK_COLOR) {
+        if (_colorByBlock == nullptr) {
+            _colorByBlock = std::make_shared<const lc::meta::MetaColorByBlock>();
         }
 
-        mf->add(lw);
-    }
-
-    // Try to find a entities meta color
-    lc::meta::MetaColor_CSPtr col;
-    if(data.color == BYBLOCK_COLOR) {
-        col = std::make_shared<const lc::meta::MetaColorByBlock>();
+        color = _colorByBlock;
     }
     else {
-        col = icol.intToColor(data.color);
+        color = icol.intToColor(data.color);
     }
 
-    if (col != nullptr) {
-        if (mf == nullptr) {
-            mf = lc::meta::MetaInfo::create();
-        }
+    return _metaInfoCache.metaInfo(color, getLineWidth(data.lWeight), getLinePattern(data.lineType));
+}
 
-        mf->add(col);
+lc::meta::MetaLineWidth_CSPtr DXFimpl::getLineWidth(DRW_LW_Conv::lineWidth lineWidth) {
+    auto it = _lineWidths.find(lineWidth);
+    if (it != _lineWidths.end()) {
+        return it->second;
+    }
+
+    auto metaLineWidth = getLcLineWidth<lc::meta::MetaLineWidth>(lineWidth);
+    _lineWidths.emplace(lineWidth, metaLineWidth);
+
+    return metaLineWidth;
+}
+
+lc::meta::DxfLinePattern_CSPtr DXFimpl::getLinePattern(const std::string& lineType) {
+    auto it = _linePatterns.find(lineType);
+    if (it != _linePatterns.end()) {
+        return it->second;
     }
 
     // Most likely a lot of entities within a drawing will be 'BYLAYER' and with the CONTINUOUS linetype.
     // These are the default's for LibreCAD
     lc::meta::DxfLinePattern_CSPtr linePattern = nullptr;
-    if(data.lineType == LTYPE_BYBLOCK) {
+    if(lineType == LTYPE_BYBLOCK) {
         linePattern = std::make_shared<lc::meta::DxfLinePatternByBlock>();
     }
-    else if (!(lc::tools::StringHelper::cmpCaseInsensetive()(data.lineType, SKIP_BYLAYER) || lc::tools::StringHelper::cmpCaseInsensetive()(data.lineType, SKIP_CONTINUOUS))) {
-        linePattern = _document->linePatternByName(data.lineType);
+    else if (!(lc::tools::StringHelper::cmpCaseInsensetive()(lineType, SKIP_BYLAYER) || lc::tools::StringHelper::cmpCaseInsensetive()(lineType, SKIP_CONTINUOUS))) {
+        linePattern = _document->linePatternByName(lineType);
     }
 
-    if(linePattern != nullptr) {
-        if (mf == nullptr) {
-            mf = lc::meta::MetaInfo::create();
-        }
+    _linePatterns.emplace(lineType, linePattern);
 
-        mf->add(linePattern);
+    return linePattern;
+}
+
+lc::meta::Layer_CSPtr DXFimpl::getLayer(const std::string& name) {
+    auto it = _layerByName.find(name);
+    if (it != _layerByName.end()) {
+        return it->second;
+    }
+
+    // The layers of the file are only added to the document when the builder is executed
+    lc::meta::Layer_CSPtr layer;
+    auto fileLayer = _layers.find(name);
+    if (fileLayer != _layers.end()) {
+        layer = fileLayer->second;
+    }
+    else {
+        layer = _document->layerByName(name);
     }
 
+    _layerByName.emplace(name, layer);
 
-    return mf;
+    return layer;
 }
 
 lc::geo::Coordinate DXFimpl::coord(DRW_Coord const& coord) const {
@@ -509,6 +657,7 @@ std::vector<lc::geo::Coordinate> DXFimpl::coords(std::vector<DRW_Coord *> coordL
 
 void DXFimpl::addLType(const DRW_LType& data) {
     std::make_shared<lc::operation::AddLinePattern>(_document, std::make_shared<lc::meta::DxfLinePatternByValue>(data.name, data.desc, data.path, data.length))->execute();
+    _linePatterns.clear();
 }
 
 /**
@@ -523,26 +672,34 @@ void DXFimpl::addImage(const DRW_Image *data) {
 void DXFimpl::linkImage(const DRW_ImageDef *data) {
     for(auto image = imageMapCache.cbegin(); image != imageMapCache.cend() /* not hoisted */; /* no increment */ ) {
         if (image->ref == data->handle) {
-            auto layer = _document->layerByName(image->layer);
+            auto layer = getLayer(image->layer);
             if (layer == nullptr) {
                 return;
             }
 
-            std::shared_ptr<lc::meta::MetaInfo> mf = getMetaInfo(*image);
-            const lc::geo::Coordinate base(coord(image->basePoint));
-            const lc::geo::Coordinate uv(coord(image->secPoint));
-            const lc::geo::Coordinate vv(coord(image->vVector));
-
-            auto lcImage = std::make_shared<lc::entity::Image>(
-                    data->name,
-                    base, uv, vv,
-                    image->sizeu, image->sizev,
-                    image->brightness, image->contrast, image->fade,
-                    layer,
-                    mf,
-                    _currentBlock
-            );
-            _entityBuilder->appendEntity(lcImage);
+            auto metaInfo = getMetaInfo(*image);
+            auto block = _currentBlock;
+
+            _pipeline.push([metaInfo, layer, block,
+                            name = data->name,
+                            base = coord(image->basePoint),
+                            uv = coord(image->secPoint),
+                            vv = coord(image->vVector),
+                            width = image->sizeu,
+                            height = image->sizev,
+                            brightness = image->brightness,
+                            contrast = image->contrast,
+                            fade = image->fade]() {
+                return std::make_shared<lc::entity::Image>(
+                        name,
+                        base, uv, vv,
+                        width, height,
+                        brightness, contrast, fade,
+                        layer,
+                        metaInfo,
+                        block
+                );
+            });
 
             image = imageMapCache.erase( image ) ; // advances iter
         } else {
@@ -555,12 +712,21 @@ void DXFimpl::addInsert(const DRW_Insert& data) {
     lc::builder::InsertBuilder builder;
     builder.setMetaInfo(getMetaInfo(data));
     builder.setBlock(_currentBlock);
-    builder.setLayer(_document->layerByName(data.layer));
+    builder.setLayer(getLayer(data.layer));
     builder.setCoordinate(coord(data.basePoint));
     builder.setDisplayBlock(_blocks[data.name]);
     builder.setDocument(_document);
 
-    _entityBuilder->appendEntity(builder.build());
+    // A insert connects to the events of the document, so it's build here and only passed through the pipeline
+    // to keep the order of the file
+    auto insert = builder.build();
+    _pipeline.push([insert]() {
+        return insert;
+    });
+}
+
+void DXFimpl::finishImport() {
+    _pipeline.finish();
 }
 
 /*********************************************
@@ -581,11 +747,7 @@ void DXFimpl::writeLayer(const std::shared_ptr<const lc::meta::Layer>& layer) {
     auto col = layer->color();
     lay.name = layer->name();
     lay.color = icol_inst.colorToInt(col);
-    auto wid = layer->lineWidth().width();
-    std::cout << wid;
-//    auto val = widthToInt();
-
-//    lay.lWeight = static_cast<DRW_LW_Conv::lineWidth>();
+    lay.lWeight = static_cast<DRW_LW_Conv::lineWidth>(widthToInt(layer->lineWidth().width()));
     lay.flags = layer->isFrozen() ? 0x01 : 0x00;
 
     dxfW->writeLayer(&lay);
@@ -636,6 +798,9 @@ bool DXFimpl::writeDXF(const std::string& filename, lc::persistence::File::Type
     bool success = dxfW->write(this, exportVersion, isBinary);
     delete dxfW;
 
+    _writeAttributesValid = false;
+    _writeMetaInfo = nullptr;
+
     return success;
 }
 
@@ -740,7 +905,16 @@ void DXFimpl::writeInsert(const lc::entity::Insert_CSPtr& i) {
 }
 
 void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity) {
-    auto layer_  = entity->layer();
+    ent->layer = entity->layer()->name();
+
+    // Most entities share their MetaInfo with the previous one
+    auto metaInfo = entity->metaInfo();
+    if (_writeAttributesValid && metaInfo == _writeMetaInfo) {
+        ent->color = _writeColor;
+        ent->lineType = _writeLineType;
+        ent->lWeight = _writeLineWidth;
+        return;
+    }
 
     auto lpByValue = entity->metaInfo<lc::meta::DxfLinePatternByValue>(lc::meta::DxfLinePattern::LCMETANAME());
     auto lpByBlock = entity->metaInfo<lc::meta::DxfLinePatternByBlock>(lc::meta::DxfLinePattern::LCMETANAME());
@@ -751,8 +925,6 @@ void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_C
     auto metaColorByBlock = entity->metaInfo<lc::meta::MetaColorByBlock>(lc::meta::MetaColor::LCMETANAME());
     auto metaColorByValue = entity->metaInfo<lc::meta::MetaColorByValue>(lc::meta::MetaColor::LCMETANAME());
 
-    ent->layer = layer_->name();
-
     if(metaColorByBlock != nullptr) {
         ent->color = BYBLOCK_COLOR;
     }
@@ -775,6 +947,12 @@ void DXFimpl::getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_C
     else if(metaWidthByBlock != nullptr) {
         ent->lWeight = DRW_LW_Conv::lineWidth::widthByBlock;
     }
+
+    _writeAttributesValid = true;
+    _writeMetaInfo = metaInfo;
+    _writeColor = ent->color;
+    _writeLineType = ent->lineType;
+    _writeLineWidth = ent->lWeight;
 }
 
 void DXFimpl::writeLTypes() {
@@ -1058,80 +1236,182 @@ void DXFimpl::writeAppId(){
     dxfW->writeAppId(&ai);
 }
 
-void DXFimpl::writeDimension(const lc::entity::Dimension_CSPtr& d) {
+void DXFimpl::writeDimension(DRW_Dimension* dimension,
+                             const lc::entity::CADEntity_CSPtr& entity,
+                             const lc::entity::Dimension& d) {
+    getEntityAttributes(dimension, entity);
+
+    dimension->setTextPoint(DRW_Coord(d.middleOfText().x(), d.middleOfText().y(), d.middleOfText().z()));
+    dimension->setAlign(d.attachmentPoint());
+    dimension->setDir(d.textAngle());
+    dimension->setTextLineFactor(d.lineSpacingFactor());
+    dimension->setTextLineStyle(d.lineSpacingStyle());
+    dimension->setText(d.explicitValue());
 
+    dxfW->writeDimension(dimension);
 }
 
 void DXFimpl::writeLWPolyline(const lc::entity::LWPolyline_CSPtr& p) {
+    DRW_LWPolyline lwPolyline;
+    getEntityAttributes(&lwPolyline, p);
+
+    lwPolyline.width = p->width();
+    lwPolyline.elevation = p->elevation();
+    lwPolyline.thickness = p->tickness();
+    lwPolyline.extPoint = DRW_Coord(p->extrusionDirection().x(),
+                                    p->extrusionDirection().y(),
+                                    p->extrusionDirection().z());
+    lwPolyline.flags = p->closed() ? 0x01 : 0x00;
+
+    lwPolyline.vertlist.reserve(p->vertex().size());
+    for(const auto& vertex : p->vertex()) {
+        DRW_Vertex2D drwVertex(vertex.location().x(), vertex.location().y(), vertex.bulge());
+        drwVertex.stawidth = vertex.startWidth();
+        drwVertex.endwidth = vertex.endWidth();
+        lwPolyline.addVertex(drwVertex);
+    }
+    lwPolyline.vertexnum = static_cast<int>(lwPolyline.vertlist.size());
 
+    dxfW->writeLWPolyline(&lwPolyline);
 }
 
 void DXFimpl::writeImage(const lc::entity::Image_CSPtr& i) {
-
+    DRW_Image image;
+    getEntityAttributes(&image, i);
+
+    image.basePoint = DRW_Coord(i->base().x(), i->base().y(), i->base().z());
+    image.secPoint = DRW_Coord(i->uv().x(), i->uv().y(), i->uv().z());
+    image.vVector = DRW_Coord(i->vv().x(), i->vv().y(), i->vv().z());
+    image.sizeu = i->width();
+    image.sizev = i->height();
+    image.brightness = static_cast<int>(i->brightness());
+    image.contrast = static_cast<int>(i->contrast());
+    image.fade = static_cast<int>(i->fade());
+
+    // The definition is owned by the writer and written in the objects section
+    auto imageDef = dxfW->writeImage(&image, i->name());
+    if(imageDef != nullptr) {
+        imageDef->loaded = 1;
+        imageDef->u = i->width();
+        imageDef->v = i->height();
+        imageDef->up = 1;
+        imageDef->vp = 1;
+        imageDef->resolution = 0;
+    }
 }
 
 void DXFimpl::writeText(const lc::entity::Text_CSPtr& t) {
-
+    DRW_Text text;
+    getEntityAttributes(&text, t);
+
+    text.basePoint = DRW_Coord(t->insertion_point().x(), t->insertion_point().y(), t->insertion_point().z());
+    // Aligned text is positioned by the second point
+    text.secPoint = text.basePoint;
+    text.text = t->text_value();
+    text.height = t->height();
+    text.angle = t->angle();
+    text.style = t->style();
+    text.textgen = t->textgeneration();
+    text.alignH = static_cast<DRW_Text::HAlign>(t->halign());
+    text.alignV = static_cast<DRW_Text::VAlign>(t->valign());
+
+    dxfW->writeText(&text);
 }
 
 void DXFimpl::writeEntities(){
-    for(const auto& e :_document->entityContainer().asVector()) {
-        if(e->block() != nullptr) {
-            continue;
+    _document->entityContainer().each<const lc::entity::CADEntity>([this](lc::entity::CADEntity_CSPtr entity) {
+        if(entity->block() == nullptr) {
+            writeEntity(entity);
         }
-
-        writeEntity(e);
-    }
+    });
 }
 
 void DXFimpl::writeEntity(const lc::entity::CADEntity_CSPtr& entity) {
-    auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity);
-    if (line != nullptr) {
-        writeLine(line);
-        return;
-    }
+    entity->dispatch(*this);
+}
 
-    auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entity);
-    if (circle != nullptr) {
-        writeCircle(circle);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Line_CSPtr line) {
+    writeLine(line);
+}
 
-    auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entity);
-    if (arc != nullptr) {
-        writeArc(arc);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Point_CSPtr point) {
+    writePoint(point);
+}
 
-    auto image = std::dynamic_pointer_cast<const lc::entity::Image>(entity);
-    if (image != nullptr) {
-        writeImage(image);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Circle_CSPtr circle) {
+    writeCircle(circle);
+}
 
-    auto lwPolyline = std::dynamic_pointer_cast<const lc::entity::LWPolyline>(entity);
-    if (lwPolyline != nullptr) {
-        writeLWPolyline(lwPolyline);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Arc_CSPtr arc) {
+    writeArc(arc);
+}
 
-    auto text = std::dynamic_pointer_cast<const lc::entity::Text>(entity);
-    if (text != nullptr) {
-        writeText(text);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Ellipse_CSPtr ellipse) {
+    writeEllipse(ellipse);
+}
 
-    auto ellipse = std::dynamic_pointer_cast<const lc::entity::Ellipse>(entity);
-    if (ellipse != nullptr) {
-        writeEllipse(ellipse);
-        return;
-    }
+void DXFimpl::visit(lc::entity::Text_CSPtr text) {
+    writeText(text);
+}
 
-    auto insert = std::dynamic_pointer_cast<const lc::entity::Insert>(entity);
-    if (insert != nullptr) {
-         writeInsert(insert);
-         return;
-    }
+void DXFimpl::visit(lc::entity::Spline_CSPtr spline) {
+    writeSpline(spline);
+}
+
+void DXFimpl::visit(lc::entity::DimAligned_CSPtr dimAligned) {
+    DRW_DimAligned dimension;
+    dimension.setDefPoint(DRW_Coord(dimAligned->definitionPoint().x(), dimAligned->definitionPoint().y(), 0.));
+    dimension.setDef1Point(DRW_Coord(dimAligned->definitionPoint2().x(), dimAligned->definitionPoint2().y(), 0.));
+    dimension.setDef2Point(DRW_Coord(dimAligned->definitionPoint3().x(), dimAligned->definitionPoint3().y(), 0.));
+    writeDimension(&dimension, dimAligned, *dimAligned);
+}
+
+void DXFimpl::visit(lc::entity::DimAngular_CSPtr dimAngular) {
+    DRW_DimAngular dimension;
+    dimension.setFirstLine1(DRW_Coord(dimAngular->defLine11().x(), dimAngular->defLine11().y(), 0.));
+    dimension.setFirstLine2(DRW_Coord(dimAngular->defLine12().x(), dimAngular->defLine12().y(), 0.));
+    dimension.setSecondLine1(DRW_Coord(dimAngular->defLine21().x(), dimAngular->defLine21().y(), 0.));
+    dimension.setSecondLine2(DRW_Coord(dimAngular->defLine22().x(), dimAngular->defLine22().y(), 0.));
+    dimension.setDimPoint(DRW_Coord(dimAngular->middleOfText().x(), dimAngular->middleOfText().y(), 0.));
+    writeDimension(&dimension, dimAngular, *dimAngular);
+}
+
+void DXFimpl::visit(lc::entity::DimDiametric_CSPtr dimDiametric) {
+    DRW_DimDiametric dimension;
+    dimension.setDiameter1Point(DRW_Coord(dimDiametric->definitionPoint().x(), dimDiametric->definitionPoint().y(), 0.));
+    dimension.setDiameter2Point(DRW_Coord(dimDiametric->definitionPoint2().x(), dimDiametric->definitionPoint2().y(), 0.));
+    dimension.setLeaderLength(dimDiametric->leader());
+    writeDimension(&dimension, dimDiametric, *dimDiametric);
+}
+
+void DXFimpl::visit(lc::entity::DimLinear_CSPtr dimLinear) {
+    DRW_DimLinear dimension;
+    dimension.setDefPoint(DRW_Coord(dimLinear->definitionPoint().x(), dimLinear->definitionPoint().y(), 0.));
+    dimension.setDef1Point(DRW_Coord(dimLinear->definitionPoint2().x(), dimLinear->definitionPoint2().y(), 0.));
+    dimension.setDef2Point(DRW_Coord(dimLinear->definitionPoint3().x(), dimLinear->definitionPoint3().y(), 0.));
+    dimension.setAngle(dimLinear->angle());
+    dimension.setOblique(dimLinear->oblique());
+    writeDimension(&dimension, dimLinear, *dimLinear);
+}
+
+void DXFimpl::visit(lc::entity::DimRadial_CSPtr dimRadial) {
+    DRW_DimRadial dimension;
+    dimension.setCenterPoint(DRW_Coord(dimRadial->definitionPoint().x(), dimRadial->definitionPoint().y(), 0.));
+    dimension.setDiameterPoint(DRW_Coord(dimRadial->definitionPoint2().x(), dimRadial->definitionPoint2().y(), 0.));
+    dimension.setLeaderLength(dimRadial->leader());
+    writeDimension(&dimension, dimRadial, *dimRadial);
+}
+
+void DXFimpl::visit(lc::entity::LWPolyline_CSPtr lwPolyline) {
+    writeLWPolyline(lwPolyline);
+}
+
+void DXFimpl::visit(lc::entity::Image_CSPtr image) {
+    writeImage(image);
+}
+
+void DXFimpl::visit(lc::entity::Insert_CSPtr insert) {
+    writeInsert(insert);
 }
 
 void DXFimpl::writeBlockRecords() {
@@ -1172,9 +1452,9 @@ void DXFimpl::writeBlock(const lc::meta::Block_CSPtr& block) {
 
     dxfW->writeBlock(&drwBlock);
 
-    for(const auto& entity : _document->entitiesByBlock(block).asVector()) {
+    _document->entitiesByBlock(block).each<const lc::entity::CADEntity>([this](lc::entity::CADEntity_CSPtr entity) {
         writeEntity(entity);
-    }
+    });
 }
 
 
@@ -6,6 +6,8 @@
 #include <iostream>
 #include "../file.h"
 #include "../generic/helpers.h"
+#include "../generic/importpipeline.h"
+#include "../generic/metainfocache.h"
 
 #include <cad/storage/document.h>
 #include <cad/storage/storagemanager.h>
@@ -13,14 +15,17 @@
 #include <cad/meta/icolor.h>
 #include <cad/operations/entitybuilder.h>
 #include <cad/base/visitor.h>
+#include <cad/interface/entitydispatch.h>
 #include <cad/meta/dxflinepattern.h>
 #include <cad/meta/metalinewidth.h>
 #include <cad/meta/metacolor.h>
 #include <cad/base/metainfo.h>
 #include <cad/meta/icolor.h>
 #include <tuple>
+#include <unordered_map>
 #include <cad/meta/block.h>
 #include <cad/operations/builder.h>
+#include <cad/tools/string_helper.h>
 
 #define BYBLOCK_COLOR 0
 #define LTYPE_BYBLOCK "ByBlock"
@@ -35,12 +40,12 @@ static const char *const SKIP_CONTINUOUS = "CONTINUOUS";
 
 namespace lc {
     namespace persistence {
-        class DXFimpl : public DRW_Interface {
+        class DXFimpl : public DRW_Interface, private lc::EntityDispatch {
             public:
 
                 DXFimpl(std::shared_ptr<lc::storage::Document> document, lc::operation::Builder_SPtr builder);
 
-                DXFimpl(std::shared_ptr<lc::storage::Document> document) : _document(document) {}
+                DXFimpl(std::shared_ptr<lc::storage::Document> document) : _document(document), _pipeline(nullptr) {}
 
                 // READ FUNCTIONALITY
                 virtual void addHeader(const DRW_Header* data) override {}
@@ -123,6 +128,12 @@ namespace lc {
 
                 virtual void endBlock() override;
 
+                /**
+                 * @brief Wait for the entities build on worker threads and add them to the EntityBuilder
+                 * Must be called after reading the file, before the builder is executed
+                 */
+                void finishImport();
+
 
                 // WRITE FUNCTIONALITY
                 bool writeDXF(const std::string& filename, lc::persistence::File::Type type);
@@ -149,6 +160,9 @@ namespace lc {
 
                 void getEntityAttributes(DRW_Entity* ent, const lc::entity::CADEntity_CSPtr& entity);
 
+                /**
+                * Write a entity using the writer of its type, found by EntityDispatch
+                */
                 void writeEntity(const lc::entity::CADEntity_CSPtr& entity);
 
                 void writePoint(const lc::entity::Point_CSPtr& p);
@@ -163,7 +177,12 @@ namespace lc {
 
                 void writeSpline(const lc::entity::Spline_CSPtr& s);
 
-                void writeDimension(const lc::entity::Dimension_CSPtr& d);
+                /**
+                * Write the properties shared by all dimensions, the type specific points must be set before
+                */
+                void writeDimension(DRW_Dimension* dimension,
+                                    const lc::entity::CADEntity_CSPtr& entity,
+                                    const lc::entity::Dimension& d);
 
                 void writeLWPolyline(const lc::entity::LWPolyline_CSPtr& p);
 
@@ -225,7 +244,19 @@ namespace lc {
 
                 dxfRW* dxfW;
 
-                lc::meta::MetaInfo_SPtr getMetaInfo(DRW_Entity const& data) const;
+                lc::meta::MetaInfo_CSPtr getMetaInfo(DRW_Entity const& data);
+
+                /**
+                * Return the shared meta types used by getMetaInfo, the same value returns the same object
+                */
+                lc::meta::MetaLineWidth_CSPtr getLineWidth(DRW_LW_Conv::lineWidth lineWidth);
+
+                lc::meta::DxfLinePattern_CSPtr getLinePattern(const std::string& lineType);
+
+                /**
+                * Return a layer by name, the layers of the file are found before they are added to the document
+                */
+                lc::meta::Layer_CSPtr getLayer(const std::string& name);
 
                 /**
                 * Convert from a DRW_Coord to a geo::Coordinate
@@ -234,11 +265,45 @@ namespace lc {
 
                 std::vector<lc::geo::Coordinate> coords(std::vector<DRW_Coord*> coordList) const;
 
+                // EntityDispatch, used by writeEntity
+                void visit(lc::entity::Line_CSPtr line) override;
+                void visit(lc::entity::Point_CSPtr point) override;
+                void visit(lc::entity::Circle_CSPtr circle) override;
+                void visit(lc::entity::Arc_CSPtr arc) override;
+                void visit(lc::entity::Ellipse_CSPtr ellipse) override;
+                void visit(lc::entity::Text_CSPtr text) override;
+                void visit(lc::entity::Spline_CSPtr spline) override;
+                void visit(lc::entity::DimAligned_CSPtr dimAligned) override;
+                void visit(lc::entity::DimAngular_CSPtr dimAngular) override;
+                void visit(lc::entity::DimDiametric_CSPtr dimDiametric) override;
+                void visit(lc::entity::DimLinear_CSPtr dimLinear) override;
+                void visit(lc::entity::DimRadial_CSPtr dimRadial) override;
+                void visit(lc::entity::LWPolyline_CSPtr lwPolyline) override;
+                void visit(lc::entity::Image_CSPtr image) override;
+                void visit(lc::entity::Insert_CSPtr insert) override;
+
             private:
                 lc::iColor icol;
 
                 std::vector<DRW_Image> imageMapCache;
                 std::map<std::string, lc::meta::Block_CSPtr> _blocks;
+
+                // Caches of the import, entities with the same properties share their MetaInfo
+                MetaInfoCache _metaInfoCache;
+                lc::meta::MetaColor_CSPtr _colorByBlock;
+                std::unordered_map<int, lc::meta::MetaLineWidth_CSPtr> _lineWidths;
+                std::unordered_map<std::string, lc::meta::DxfLinePattern_CSPtr> _linePatterns;
+                std::map<std::string, lc::meta::Layer_CSPtr, lc::tools::StringHelper::cmpCaseInsensetive> _layers;
+                std::unordered_map<std::string, lc::meta::Layer_CSPtr> _layerByName;
+
+                ImportPipeline _pipeline;
+
+                // Attributes of the last written MetaInfo, entities of a drawing share a few MetaInfo
+                bool _writeAttributesValid = false;
+                lc::meta::MetaInfo_CSPtr _writeMetaInfo;
+                int _writeColor;
+                std::string _writeLineType;
+                DRW_LW_Conv::lineWidth _writeLineWidth;
         };
     }
 }
\ No newline at end of file
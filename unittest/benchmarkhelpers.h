@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cad/geometry/geoarea.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/circle.h>
+#include <cad/primitive/line.h>
+
+/*
+ * Helpers shared by the benchmarks, which are build in the lcbenchmark executable
+ */
+namespace lc {
+    namespace test {
+        /**
+         * Time since start, in milliseconds
+         */
+        inline double elapsed(const std::chrono::steady_clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        /**
+         * Lines starting at a random position within area, with each end point at most length away
+         * in both directions
+         */
+        inline std::vector<entity::CADEntity_CSPtr> randomLines(unsigned int count, const geo::Area& area, double length,
+                                                                unsigned int seed = 1) {
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<double> x(area.minP().x(), area.maxP().x());
+            std::uniform_real_distribution<double> y(area.minP().y(), area.maxP().y());
+            std::uniform_real_distribution<double> offset(-length, length);
+            auto layer = std::make_shared<const meta::Layer>();
+
+            std::vector<entity::CADEntity_CSPtr> lines;
+            lines.reserve(count);
+            for (unsigned int i = 0; i < count; i++) {
+                geo::Coordinate start(x(gen), y(gen));
+                lines.push_back(std::make_shared<entity::Line>(start, start + geo::Coordinate(offset(gen), offset(gen)),
+                                                               layer));
+            }
+
+            return lines;
+        }
+
+        /**
+         * Lines, circles and arcs in turn, each at a random position within area and at most size large
+         */
+        inline std::vector<entity::CADEntity_CSPtr> randomEntities(unsigned int count, const geo::Area& area, double size,
+                                                                   unsigned int seed = 1) {
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<double> x(area.minP().x(), area.maxP().x());
+            std::uniform_real_distribution<double> y(area.minP().y(), area.maxP().y());
+            std::uniform_real_distribution<double> offset(-size, size);
+            auto layer = std::make_shared<const meta::Layer>();
+
+            std::vector<entity::CADEntity_CSPtr> entities;
+            entities.reserve(count);
+            for (unsigned int i = 0; i < count; i++) {
+                geo::Coordinate center(x(gen), y(gen));
+
+                switch (i % 3) {
+                    case 0:
+                        entities.push_back(std::make_shared<entity::Line>(
+                                center, center + geo::Coordinate(offset(gen), offset(gen)), layer
+                        ));
+                        break;
+
+                    case 1:
+                        entities.push_back(std::make_shared<entity::Circle>(center, std::abs(offset(gen)) + 1., layer));
+                        break;
+
+                    default:
+                        entities.push_back(std::make_shared<entity::Arc>(
+                                center, std::abs(offset(gen)) + 1., M_PI / 6., M_PI / 1.5, true, layer
+                        ));
+                        break;
+                }
+            }
+
+            return entities;
+        }
+
+        /**
+         * Square areas of a given size with their corner at a random position within area
+         */
+        inline std::vector<geo::Area> randomAreas(unsigned int count, const geo::Area& area, double size,
+                                                  unsigned int seed = 2) {
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<double> x(area.minP().x(), area.maxP().x());
+            std::uniform_real_distribution<double> y(area.minP().y(), area.maxP().y());
+
+            std::vector<geo::Area> areas;
+            areas.reserve(count);
+            for (unsigned int i = 0; i < count; i++) {
+                areas.emplace_back(geo::Coordinate(x(gen), y(gen)), size, size);
+            }
+
+            return areas;
+        }
+    }
+}
@@ -2,10 +2,73 @@
 #include <cad/base/visitor.h>
 #include <cad/math/intersect.h>
 #include <gtest/gtest.h>
+#include <random>
+#include <functional>
+#include <cad/math/lcmath.h>
 
 //
 // Created by R. van Twisk on 5/6/15.
 //
+namespace {
+    std::vector<lc::entity::CADEntity_CSPtr> randomEntities(unsigned int count, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> position(-100, 100);
+        std::uniform_real_distribution<double> offset(-10, 10);
+        std::uniform_real_distribution<double> radius(0.5, 5);
+
+        std::vector<lc::entity::CADEntity_CSPtr> entities;
+        for (unsigned int i = 0; i < count; i++) {
+            lc::geo::Coordinate start(position(gen), position(gen));
+            if (i % 4 == 0) {
+                entities.push_back(std::make_shared<lc::entity::Arc>(start, radius(gen), 0., M_PI * 1.5, true, nullptr));
+            }
+            else {
+                entities.push_back(std::make_shared<lc::entity::Line>(start, start + lc::geo::Coordinate(offset(gen), offset(gen)), nullptr));
+            }
+        }
+        return entities;
+    }
+
+    // Number of points sampled along a path, on a circle with a radius of 15 they are less than 0.4 apart
+    const unsigned int SAMPLES = 250;
+    // Every point of a path is within this distance of a sample
+    const double SAMPLE_DISTANCE = 0.2;
+
+    /**
+     * Test if one of the points sampled along the path of a line, arc, circle or ellipse is within area
+     */
+    bool samples(const lc::entity::CADEntity_CSPtr& entity, const lc::geo::Area& area) {
+        const unsigned int count = SAMPLES;
+        std::function<lc::geo::Coordinate(double)> point;
+
+        if (auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity)) {
+            point = [line](double t) { return line->start() + (line->end() - line->start()) * t; };
+        }
+        else if (auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entity)) {
+            const double sweep = lc::maths::Math::getAngleDifference(arc->startAngle(), arc->endAngle(), arc->CCW());
+            const double direction = arc->CCW() ? 1. : -1.;
+            point = [arc, sweep, direction](double t) {
+                return arc->center() + lc::geo::Coordinate(arc->startAngle() + direction * sweep * t) * arc->radius();
+            };
+        }
+        else if (auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entity)) {
+            point = [circle](double t) { return circle->center() + lc::geo::Coordinate(2 * M_PI * t) * circle->radius(); };
+        }
+        else if (auto ellipse = std::dynamic_pointer_cast<const lc::entity::Ellipse>(entity)) {
+            const double sweep = lc::maths::Math::getAngleDifference(ellipse->startAngle(), ellipse->endAngle(), !ellipse->isReversed());
+            const double direction = ellipse->isReversed() ? -1. : 1.;
+            point = [ellipse, sweep, direction](double t) { return ellipse->getPoint(ellipse->startAngle() + direction * sweep * t); };
+        }
+
+        for (unsigned int i = 0; i <= count; i++) {
+            if (area.inArea(point((double) i / count))) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
 TEST(IntersectTest, LineLine1) {
     lc::entity::CADEntity_CSPtr i1=std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0,0),  lc::geo::Coordinate(10,10), nullptr);
     lc::entity::CADEntity_CSPtr i2=std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0,10), lc::geo::Coordinate(10,0), nullptr);
@@ -43,3 +106,106 @@ TEST(IntersectTest, LineLine2) {
     }
 }
 
+
+TEST(IntersectTest, IntersectMany) {
+    auto entities = randomEntities(300, 1);
+
+    // Only pairs with overlapping bounding boxes are tested, in the same order as when all pairs are tested
+    lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
+    for (size_t a = 0; a < entities.size(); a++) {
+        for (size_t b = a + 1; b < entities.size(); b++) {
+            visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *entities[a].get(), *entities[b].get());
+        }
+    }
+
+    auto result = lc::maths::IntersectMany(entities, lc::maths::Intersect::OnEntity, LCTOLERANCE).result();
+    EXPECT_FALSE(result.empty());
+    EXPECT_EQ(intersect.result(), result);
+
+    // Paths extend beyond the bounding boxes, all pairs are tested
+    std::vector<lc::entity::CADEntity_CSPtr> few;
+    for (size_t i = 0; i < 100; i++) {
+        if (std::dynamic_pointer_cast<const lc::entity::Line>(entities[i])) {
+            few.push_back(entities[i]);
+        }
+    }
+    lc::maths::Intersect intersectPath(lc::maths::Intersect::OnPath, LCTOLERANCE);
+    for (size_t a = 0; a < few.size(); a++) {
+        for (size_t b = a + 1; b < few.size(); b++) {
+            visitorDispatcher<bool, lc::GeoEntityVisitor>(intersectPath, *few[a].get(), *few[b].get());
+        }
+    }
+    EXPECT_EQ(intersectPath.result(), lc::maths::IntersectMany(few, lc::maths::Intersect::OnPath, LCTOLERANCE).result());
+
+    EXPECT_TRUE(lc::maths::IntersectMany({entities[0]}).result().empty());
+}
+
+TEST(IntersectTest, IntersectAgainstOthers) {
+    auto entities = randomEntities(100, 1);
+    auto others = randomEntities(200, 2);
+
+    lc::maths::Intersect intersect(lc::maths::Intersect::OnEntity, LCTOLERANCE);
+    for (const auto& entity : entities) {
+        for (const auto& other : others) {
+            visitorDispatcher<bool, lc::GeoEntityVisitor>(intersect, *entity.get(), *other.get());
+        }
+    }
+
+    auto result = lc::maths::IntersectAgainstOthers(entities, others, lc::maths::Intersect::OnEntity, LCTOLERANCE).result();
+    EXPECT_FALSE(result.empty());
+    EXPECT_EQ(intersect.result(), result);
+
+    EXPECT_TRUE(lc::maths::IntersectAgainstOthers(entities, {}, lc::maths::Intersect::OnEntity, LCTOLERANCE).result().empty());
+}
+
+TEST(IntersectTest, HasIntersectArea) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> position(-20, 20);
+    std::uniform_real_distribution<double> size(0.5, 15);
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+
+    std::vector<lc::entity::CADEntity_CSPtr> entities;
+    for (unsigned int i = 0; i < 500; i++) {
+        lc::geo::Coordinate center(position(gen), position(gen));
+        entities.push_back(std::make_shared<lc::entity::Line>(center, center + lc::geo::Coordinate(angle(gen)) * size(gen), nullptr));
+        entities.push_back(std::make_shared<lc::entity::Arc>(center, size(gen), angle(gen), angle(gen), i % 2 == 0, nullptr));
+        entities.push_back(std::make_shared<lc::entity::Circle>(center, size(gen), nullptr));
+        entities.push_back(std::make_shared<lc::entity::Ellipse>(center, lc::geo::Coordinate(angle(gen)) * size(gen), size(gen) / 3.,
+                                                                 angle(gen), angle(gen), false, nullptr));
+    }
+
+    lc::geo::Area area(lc::geo::Coordinate(-5, -3), lc::geo::Coordinate(7, 4));
+    unsigned int found = 0;
+
+    for (const auto& entity : entities) {
+        lc::maths::HasIntersectArea hasIntersect(area, 10e-4);
+        ASSERT_TRUE((visitorDispatcher<bool, lc::GeoEntityVisitor>(hasIntersect, *entity.get())));
+
+        // Compare with points sampled along the path, away from the edges of the area
+        auto inside = samples(entity, area.increaseBy(SAMPLE_DISTANCE));
+        auto deepInside = samples(entity, area.increaseBy(-0.01));
+
+        EXPECT_TRUE(inside || !hasIntersect.result()) << entity->boundingBox();
+        EXPECT_TRUE(!deepInside || hasIntersect.result()) << entity->boundingBox();
+        found += hasIntersect.result();
+    }
+    EXPECT_GT(found, 0);
+
+    // Polylines are tested segment by segment
+    std::vector<lc::entity::LWVertex2D> vertex{lc::entity::LWVertex2D(lc::geo::Coordinate(-20, 0)),
+                                               lc::entity::LWVertex2D(lc::geo::Coordinate(-10, 0), 1.),
+                                               lc::entity::LWVertex2D(lc::geo::Coordinate(-6, 0))};
+    lc::entity::LWPolyline polyline(vertex, 0., 0., 0., false, lc::geo::Coordinate(0, 0, 1), nullptr);
+    lc::maths::HasIntersectArea outside(area, 10e-4);
+    visitorDispatcher<bool, lc::GeoEntityVisitor>(outside, polyline);
+    EXPECT_FALSE(outside.result());
+
+    lc::entity::LWPolyline closed(vertex, 0., 0., 0., true, lc::geo::Coordinate(0, 0, 1), nullptr);
+    lc::maths::HasIntersectArea crossing(lc::geo::Area(lc::geo::Coordinate(-12, -1), lc::geo::Coordinate(-11, 1)), 10e-4);
+    visitorDispatcher<bool, lc::GeoEntityVisitor>(crossing, closed);
+    EXPECT_TRUE(crossing.result());
+
+    // Other entities aren't tested
+    lc::maths::HasIntersectArea image(area, 10e-4);
+    EXPECT_FALSE((visitorDispatcher<bool, lc::GeoEntityVisitor>(image, area)));
+}
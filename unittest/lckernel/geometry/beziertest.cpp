@@ -5,7 +5,11 @@
 
 #include "cad/math/intersectionhandler.h"
 #include "cad/geometry/geovector.h"
+#include "cad/geometry/geospline.h"
+#include "cad/primitive/spline.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #define PI 3.14159265
 #define TRD PI/180
@@ -193,3 +197,90 @@ TEST(SPLINE, SPLINELINE) {
 
     ASSERT_EQ(result, expectedres);
 }
+
+TEST(BEZIER_CUBIC, BOUNDINGBOX) {
+    // Extremes in y at t = 0.5 and a straight x, the derivative in x is linear
+    auto bezier = lc::geo::CubicBezier({0, 0}, {100, 100}, {200, 100}, {300, 0});
+    auto box = bezier.boundingBox();
+
+    ASSERT_NEAR(0., box.minP().x(), 1e-6);
+    ASSERT_NEAR(0., box.minP().y(), 1e-6);
+    ASSERT_NEAR(300., box.maxP().x(), 1e-6);
+    ASSERT_NEAR(75., box.maxP().y(), 1e-6);
+}
+
+TEST(BEZIER_CUBIC, NEARESTPOINT) {
+    auto bezier = lc::geo::CubicBezier({100, -500}, {300, 1500}, {600, -1500}, {1000, 500});
+
+    for(double x = -200.; x < 1200.; x += 97.) {
+        for(double y = -800.; y < 800.; y += 113.) {
+            lc::geo::Coordinate coord(x, y);
+
+            // Nearest of many points on the curve
+            double expected = std::numeric_limits<double>::max();
+            for(int i = 0; i <= 20000; i++) {
+                expected = std::min(expected, bezier.DirectValueAt(i / 20000.).distanceTo(coord));
+            }
+
+            auto nearest = bezier.nearestPointOnEntity(coord);
+            ASSERT_LE(nearest.distanceTo(coord), expected + 1e-9);
+            ASSERT_NEAR(expected, nearest.distanceTo(coord), 1e-2);
+        }
+    }
+}
+
+TEST(SPLINE, NEARESTPOINT) {
+    using namespace lc;
+
+    std::vector<geo::Coordinate> cp;
+    for(int i = 0; i < 1200; i++) {
+        cp.emplace_back(i * 10., std::sin(i * 0.7) * 40.);
+    }
+
+    auto spline_ = geo::Spline(cp, {}, {}, 3, false, 0, 0,0,0, 0,0,0, 0,0,0, static_cast<geo::Spline::splineflag>(0));
+    ASSERT_GT(spline_.beziers().size(), 1000);
+
+    for(double x = -100.; x < 12100.; x += 471.) {
+        geo::Coordinate coord(x, std::cos(x) * 80.);
+
+        // Solve every bezier
+        double expected = std::numeric_limits<double>::max();
+        for(const auto& bezier : spline_.beziers()) {
+            expected = std::min(expected, bezier->nearestPointOnEntity(coord).distanceTo(coord));
+        }
+
+        ASSERT_NEAR(expected, spline_.nearestPointOnEntity(coord).distanceTo(coord), 1e-9);
+        ASSERT_NEAR(expected, spline_.nearestPointOnPath(coord).distanceTo(coord), 1e-9);
+    }
+}
+
+TEST(SPLINE, SNAPPOINTS) {
+    using namespace lc;
+
+    std::vector<geo::Coordinate> cp;
+    for(int i = 0; i < 100; i++) {
+        cp.emplace_back(i * 20., std::sin(i * 1.3) * 50.);
+    }
+
+    auto spline = std::make_shared<entity::Spline>(cp, std::vector<double>(), std::vector<geo::Coordinate>(),
+                                                   3, false, 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.,
+                                                   geo::Spline::splineflag(0), std::make_shared<const meta::Layer>());
+
+    SimpleSnapConstrain constrain(SimpleSnapConstrain::ON_ENTITY, 0, 0.);
+
+    for(double x = -100.; x < 2100.; x += 113.) {
+        geo::Coordinate coord(x, std::cos(x) * 60.);
+
+        // Solve every bezier
+        double expected = std::numeric_limits<double>::max();
+        for(const auto& bezier : spline->beziers()) {
+            expected = std::min(expected, bezier->nearestPointOnEntity(coord).distanceTo(coord));
+        }
+
+        ASSERT_NEAR(expected, spline->nearestPointOnEntity(coord).distanceTo(coord), 1e-9);
+
+        auto snapPoints = spline->snapPoints(coord, constrain, expected + 1., 10);
+        ASSERT_EQ(1, snapPoints.size());
+        ASSERT_NEAR(expected, snapPoints.front().coordinate().distanceTo(coord), 1e-9);
+    }
+}
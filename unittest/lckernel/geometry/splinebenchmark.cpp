@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <cad/primitive/spline.h>
+#include "benchmarkhelpers.h"
+
+using lc::test::elapsed;
+
+/*
+ * Nearest point and snapping on splines with many control points, pruned with the bezier tree
+ * compared to solving every bezier
+ */
+namespace {
+    const unsigned int BENCHMARK_QUERIES = 200;
+
+    lc::entity::Spline_CSPtr randomSpline(unsigned int controlPoints) {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> offset(-50., 50.);
+
+        std::vector<lc::geo::Coordinate> cp;
+        for (unsigned int i = 0; i < controlPoints; i++) {
+            cp.emplace_back(i * 20., offset(gen));
+        }
+
+        return std::make_shared<lc::entity::Spline>(cp, std::vector<double>(), std::vector<lc::geo::Coordinate>(),
+                                                    3, false, 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.,
+                                                    lc::geo::Spline::splineflag(0),
+                                                    std::make_shared<const lc::meta::Layer>());
+    }
+
+    void benchmark(unsigned int controlPoints) {
+        auto spline = randomSpline(controlPoints);
+
+        std::mt19937 gen(2);
+        std::uniform_real_distribution<double> x(-100., controlPoints * 20. + 100.);
+        std::uniform_real_distribution<double> y(-100., 100.);
+
+        std::vector<lc::geo::Coordinate> queries;
+        for (unsigned int i = 0; i < BENCHMARK_QUERIES; i++) {
+            queries.emplace_back(x(gen), y(gen));
+        }
+
+        // Building the tree is part of the first query
+        auto start = std::chrono::steady_clock::now();
+        double treeDistance = 0.;
+        for (const auto& query : queries) {
+            treeDistance += spline->nearestPointOnEntity(query).distanceTo(query);
+        }
+        double treeTime = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        double allDistance = 0.;
+        for (const auto& query : queries) {
+            double nearest = std::numeric_limits<double>::max();
+            for (const auto& bezier : spline->beziers()) {
+                nearest = std::min(nearest, bezier->nearestPointOnEntity(query).distanceTo(query));
+            }
+            allDistance += nearest;
+        }
+        double allTime = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t snapPoints = 0;
+        lc::SimpleSnapConstrain constrain(lc::SimpleSnapConstrain::LOGICAL | lc::SimpleSnapConstrain::ON_ENTITY, 0, 0.);
+        for (const auto& query : queries) {
+            snapPoints += spline->snapPoints(query, constrain, 10., 10).size();
+        }
+        double snapTime = elapsed(start);
+
+        std::cout << controlPoints << " control points, " << spline->beziers().size() << " beziers: "
+                  << "nearest " << treeTime << "ms, "
+                  << "every bezier " << allTime << "ms, "
+                  << "snap " << snapTime << "ms (" << snapPoints << " snap points)" << std::endl;
+
+        EXPECT_NEAR(allDistance, treeDistance, 1e-6);
+        EXPECT_GT(snapPoints, 0);
+    }
+}
+
+TEST(SplineBenchmark, NearestPoint) {
+    benchmark(1000);
+    benchmark(5000);
+}
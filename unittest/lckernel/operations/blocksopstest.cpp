@@ -3,6 +3,10 @@
 #include <cad/storage/documentimpl.h>
 #include <cad/storage/storagemanagerimpl.h>
 #include <cad/operations/blockops.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/builders/insert.h>
+#include <cad/primitive/insert.h>
+#include <cad/primitive/line.h>
 
 using namespace lc;
 using namespace storage;
@@ -80,4 +84,48 @@ TEST(BlockOps, ReplaceBlock) {
     blocks = document->blocks();
     EXPECT_EQ(1, blocks.size());
     EXPECT_EQ(block2, *blocks.begin());
-}
\ No newline at end of file
+}
+
+TEST(BlockOps, InsertBoundingBox) {
+    auto document = std::make_shared<DocumentImpl>(std::make_shared<StorageManagerImpl>());
+    auto block = std::make_shared<lc::meta::Block>("Name", geo::Coordinate());
+    std::make_shared<operation::AddBlock>(document, block)->execute();
+    auto layer = document->layerByName("0");
+
+    auto builder = std::make_shared<operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(10., 0.),
+                                                         layer, nullptr, block));
+    builder->execute();
+
+    builder::InsertBuilder insertBuilder;
+    insertBuilder.setLayer(layer);
+    insertBuilder.setDisplayBlock(block);
+    insertBuilder.setCoordinate(geo::Coordinate(1000., 1000.));
+    insertBuilder.setDocument(document);
+    auto insert = insertBuilder.build();
+
+    builder = std::make_shared<operation::EntityBuilder>(document);
+    builder->appendEntity(insert);
+    builder->execute();
+
+    auto found = [&document](const geo::Area& area) {
+        unsigned int count = 0;
+        document->entityContainer().eachWithinAndCrossingArea(area, [&count](const entity::CADEntity_CSPtr&) {
+            count++;
+        });
+        return count;
+    };
+
+    const geo::Area extension(geo::Coordinate(990., 1400.), geo::Coordinate(1010., 1600.));
+    EXPECT_EQ(0, found(extension));
+
+    // The block grows after the insert was added, the insert is found within its new bounding box
+    builder = std::make_shared<operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<entity::Line>(geo::Coordinate(0., 0.), geo::Coordinate(0., 500.),
+                                                         layer, nullptr, block));
+    builder->execute();
+
+    EXPECT_EQ(geo::Coordinate(1010., 1500.), insert->boundingBox().maxP());
+    EXPECT_EQ(1, found(extension));
+    EXPECT_EQ(insert, document->entityContainer().entityByID(insert->id()));
+}
@@ -315,4 +315,58 @@ TEST(EntityBuilderTest, SelectByLayer) {
 
 	EXPECT_TRUE((firstEntity_isExpected1 && secondEntity_isExpected2) ||
 				(firstEntity_isExpected2 && secondEntity_isExpected1));
-}
\ No newline at end of file
+}
+
+namespace {
+	struct EntityEventCounter {
+		unsigned int events = 0;
+		unsigned int entities = 0;
+
+		void on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+			events++;
+			entities += event.entities().size();
+		}
+
+		void on_removeEntitiesEvent(const lc::event::RemoveEntitiesEvent& event) {
+			events++;
+			entities += event.entities().size();
+		}
+	};
+}
+
+TEST(EntityBuilderTest, LargeBatch) {
+	auto storageManager = std::make_shared<lc::storage::StorageManagerImpl>();
+	auto document = std::make_shared<lc::storage::DocumentImpl>(storageManager);
+	auto layer = std::make_shared<const lc::meta::Layer>();
+
+	EntityEventCounter addEvents;
+	EntityEventCounter removeEvents;
+	document->addEntitiesEvent().connect<EntityEventCounter, &EntityEventCounter::on_addEntitiesEvent>(&addEvents);
+	document->removeEntitiesEvent().connect<EntityEventCounter, &EntityEventCounter::on_removeEntitiesEvent>(&removeEvents);
+
+	auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+	std::vector<lc::entity::CADEntity_CSPtr> lines;
+	for (unsigned int i = 0; i < 5000; i++) {
+		lines.push_back(std::make_shared<lc::entity::Line>(
+				lc::geo::Coordinate(i, 0),
+				lc::geo::Coordinate(i, 100),
+				layer
+		));
+		builder->appendEntity(lines.back());
+	}
+	builder->execute();
+
+	EXPECT_EQ(5000, document->entityContainer().asVector().size());
+	// A single event for all entities
+	EXPECT_EQ(1, addEvents.events);
+	EXPECT_EQ(5000, addEvents.entities);
+	EXPECT_EQ(lines[1234], document->entityContainer().entityByID(lines[1234]->id()));
+
+	builder->undo();
+	EXPECT_EQ(0, document->entityContainer().asVector().size()) << "Entities still present after undo append";
+	EXPECT_EQ(1, removeEvents.events);
+	EXPECT_EQ(5000, removeEvents.entities);
+
+	builder->redo();
+	EXPECT_EQ(5000, document->entityContainer().asVector().size()) << "Entities not present after redo append";
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/entityops.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/circle.h>
+#include <cad/meta/block.h>
+
+using namespace lc;
+
+/*
+ * Each test processes 600 lines and circles, with and without meta info or block
+ */
+class EntityOpsTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            document = std::make_shared<storage::DocumentImpl>(std::make_shared<storage::StorageManagerImpl>());
+            layer = std::make_shared<const meta::Layer>();
+            metaInfo = meta::MetaInfo::create();
+            block = std::make_shared<const meta::Block>("Block", geo::Coordinate());
+
+            // More entities than a single batch of lines, with other entities in between and points at different z
+            for (int i = 0; i < 600; i++) {
+                if (i % 7 == 0) {
+                    entities.push_back(std::make_shared<entity::Circle>(geo::Coordinate(i, 5.), 2., layer));
+                }
+                else {
+                    entities.push_back(std::make_shared<entity::Line>(geo::Coordinate(i, 0.5 * i, 1.),
+                                                                      geo::Coordinate(-i, 10., -0.25 * i),
+                                                                      layer,
+                                                                      i % 3 == 0 ? metaInfo : nullptr,
+                                                                      i % 5 == 0 ? block : nullptr));
+                }
+            }
+        }
+
+        std::vector<entity::CADEntity_CSPtr> process(const operation::Base_SPtr& operation) {
+            std::vector<entity::CADEntity_CSPtr> workingBuffer;
+            std::vector<entity::CADEntity_CSPtr> removals;
+            return operation->process(document, entities, workingBuffer, removals, {});
+        }
+
+        /**
+         * Compare the result of a operation to the transformation of each entity
+         */
+        template<typename Transform>
+        void expectSame(const std::vector<entity::CADEntity_CSPtr>& result, Transform transform, bool sameID) {
+            ASSERT_EQ(entities.size(), result.size());
+
+            for (size_t i = 0; i < entities.size(); i++) {
+                auto expected = transform(entities[i]);
+                ASSERT_EQ(typeid(*expected), typeid(*result[i]));
+                EXPECT_EQ(sameID, entities[i]->id() == result[i]->id());
+                EXPECT_EQ(entities[i]->layer(), result[i]->layer());
+                EXPECT_EQ(expected->metaInfo(), result[i]->metaInfo());
+                EXPECT_EQ(expected->block(), result[i]->block());
+
+                auto expectedLine = std::dynamic_pointer_cast<const entity::Line>(expected);
+                if (expectedLine != nullptr) {
+                    auto line = std::static_pointer_cast<const entity::Line>(result[i]);
+                    EXPECT_DOUBLE_EQ(expectedLine->start().x(), line->start().x());
+                    EXPECT_DOUBLE_EQ(expectedLine->start().y(), line->start().y());
+                    EXPECT_DOUBLE_EQ(expectedLine->start().z(), line->start().z());
+                    EXPECT_DOUBLE_EQ(expectedLine->end().x(), line->end().x());
+                    EXPECT_DOUBLE_EQ(expectedLine->end().y(), line->end().y());
+                    EXPECT_DOUBLE_EQ(expectedLine->end().z(), line->end().z());
+                }
+            }
+        }
+
+        storage::Document_SPtr document;
+        meta::Layer_CSPtr layer;
+        meta::MetaInfo_CSPtr metaInfo;
+        meta::Block_CSPtr block;
+        std::vector<entity::CADEntity_CSPtr> entities;
+};
+
+TEST_F(EntityOpsTest, Move) {
+    geo::Coordinate offset(3., -2., 1.);
+
+    expectSame(process(std::make_shared<operation::Move>(offset)), [&](const entity::CADEntity_CSPtr& entity) {
+        return entity->move(offset);
+    }, true);
+}
+
+TEST_F(EntityOpsTest, Copy) {
+    geo::Coordinate offset(3., -2.);
+
+    std::vector<entity::CADEntity_CSPtr> workingBuffer;
+    std::vector<entity::CADEntity_CSPtr> removals;
+    auto result = std::make_shared<operation::Copy>(offset)->process(document, entities, workingBuffer, removals, {});
+
+    // The originals are kept
+    EXPECT_EQ(entities, workingBuffer);
+    expectSame(result, [&](const entity::CADEntity_CSPtr& entity) {
+        return entity->copy(offset);
+    }, false);
+}
+
+TEST_F(EntityOpsTest, Rotate) {
+    geo::Coordinate center(1., 2., 3.);
+
+    auto result = process(std::make_shared<operation::Rotate>(center, M_PI / 3.));
+    expectSame(result, [&](const entity::CADEntity_CSPtr& entity) {
+        return entity->rotate(center, M_PI / 3.);
+    }, true);
+
+    // Like geo::Coordinate::rotate(), the points get the z of the center
+    auto line = std::dynamic_pointer_cast<const entity::Line>(result[1]);
+    ASSERT_NE(nullptr, line);
+    EXPECT_EQ(3., line->start().z());
+    EXPECT_EQ(3., line->end().z());
+}
+
+TEST_F(EntityOpsTest, Scale) {
+    geo::Coordinate center(1., 2.);
+    geo::Coordinate factor(2., 3., 4.);
+
+    auto result = process(std::make_shared<operation::Scale>(center, factor));
+    expectSame(result, [&](const entity::CADEntity_CSPtr& entity) {
+        return entity->scale(center, factor);
+    }, true);
+
+    // Each axis is scaled by it's own factor
+    auto line = std::dynamic_pointer_cast<const entity::Line>(result[2]);
+    ASSERT_NE(nullptr, line);
+    EXPECT_DOUBLE_EQ(1. + (2. - 1.) * 2., line->start().x());
+    EXPECT_DOUBLE_EQ(2. + (1. - 2.) * 3., line->start().y());
+    EXPECT_DOUBLE_EQ(4., line->start().z());
+    EXPECT_DOUBLE_EQ(-2., line->end().z());
+}
+
+TEST_F(EntityOpsTest, Loop) {
+    // Copy and rotate by 45 degrees, 8 times
+    std::vector<operation::Base_SPtr> stack{
+            std::make_shared<operation::Copy>(geo::Coordinate(0., 0.)),
+            std::make_shared<operation::Rotate>(geo::Coordinate(0., 0.), M_PI / 4.)
+    };
+    std::vector<entity::CADEntity_CSPtr> workingBuffer;
+    std::vector<entity::CADEntity_CSPtr> removals;
+    auto result = std::make_shared<operation::Loop>(9)->process(document, entities, workingBuffer, removals, stack);
+
+    EXPECT_EQ(8 * entities.size(), workingBuffer.size());
+
+    // A full turn brings the entities back to their position
+    ASSERT_EQ(entities.size(), result.size());
+    for (size_t i = 0; i < entities.size(); i++) {
+        auto line = std::dynamic_pointer_cast<const entity::Line>(entities[i]);
+        if (line == nullptr) {
+            continue;
+        }
+
+        auto rotated = std::dynamic_pointer_cast<const entity::Line>(result[i]);
+        ASSERT_NE(nullptr, rotated);
+        EXPECT_NEAR(line->start().x(), rotated->start().x(), 1e-9);
+        EXPECT_NEAR(line->start().y(), rotated->start().y(), 1e-9);
+        EXPECT_NEAR(line->end().x(), rotated->end().x(), 1e-9);
+        EXPECT_NEAR(line->end().y(), rotated->end().y(), 1e-9);
+    }
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/arc.h>
+#include <cad/primitive/line.h>
+#include <cad/math/intersect.h>
+#include <cmath>
+
+using namespace lc;
+using namespace entity;
+
+namespace {
+    LWPolyline polyline(bool closed) {
+        std::vector<LWVertex2D> vertex;
+        vertex.emplace_back(geo::Coordinate(0., 0.));
+        vertex.emplace_back(geo::Coordinate(10., 0.), 1.);
+        vertex.emplace_back(geo::Coordinate(10., 10.));
+        vertex.emplace_back(geo::Coordinate(0., 10.));
+
+        return LWPolyline(vertex, 0., 0., 0., closed, geo::Coordinate(0., 0., 1.), nullptr);
+    }
+}
+
+TEST(lc__entity__LWPolylineTest, segments) {
+    auto open = polyline(false);
+    ASSERT_EQ(3, open.segments().size());
+    EXPECT_FALSE(open.segments()[0].isArc());
+    EXPECT_TRUE(open.segments()[1].isArc());
+    EXPECT_FALSE(open.segments()[2].isArc());
+
+    // Half circle from 10,0 to 10,10
+    const auto& arc = open.segments()[1];
+    EXPECT_NEAR(10., arc.center.x(), LCTOLERANCE);
+    EXPECT_NEAR(5., arc.center.y(), LCTOLERANCE);
+    EXPECT_NEAR(5., arc.radius, LCTOLERANCE);
+    EXPECT_NEAR(15., arc.boundingBox.maxP().x(), LCTOLERANCE);
+
+    auto closed = polyline(true);
+    ASSERT_EQ(4, closed.segments().size());
+    EXPECT_EQ(geo::Coordinate(0., 10.), closed.segments()[3].start);
+    EXPECT_EQ(geo::Coordinate(0., 0.), closed.segments()[3].end);
+}
+
+TEST(lc__entity__LWPolylineTest, boundingBox) {
+    auto res = polyline(false).boundingBox();
+    EXPECT_NEAR(0., res.minP().x(), LCTOLERANCE);
+    EXPECT_NEAR(0., res.minP().y(), LCTOLERANCE);
+    EXPECT_NEAR(15., res.maxP().x(), LCTOLERANCE);
+    EXPECT_NEAR(10., res.maxP().y(), LCTOLERANCE);
+}
+
+TEST(lc__entity__LWPolylineTest, asEntities) {
+    auto entities = polyline(true).asEntities();
+    ASSERT_EQ(4, entities.size());
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<const Line>(entities[0]));
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<const Arc>(entities[1]));
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<const Line>(entities[3]));
+}
+
+TEST(lc__entity__LWPolylineTest, nearestPointOnPath) {
+    auto lwp = polyline(false);
+
+    auto nearest = lwp.nearestPointOnPath2(geo::Coordinate(16., 5.));
+    ASSERT_NE(nullptr, nearest.second);
+    EXPECT_TRUE(nearest.second->isArc());
+    EXPECT_NEAR(15., nearest.first.x(), LCTOLERANCE);
+    EXPECT_NEAR(5., nearest.first.y(), LCTOLERANCE);
+
+    nearest = lwp.nearestPointOnPath2(geo::Coordinate(5., -1.));
+    ASSERT_EQ(&lwp.segments()[0], nearest.second);
+    EXPECT_NEAR(5., nearest.first.x(), LCTOLERANCE);
+    EXPECT_NEAR(0., nearest.first.y(), LCTOLERANCE);
+
+    std::vector<LWVertex2D> empty;
+    LWPolyline emptyPolyline(empty, 0., 0., 0., false, geo::Coordinate(0., 0., 1.), nullptr);
+    EXPECT_TRUE(emptyPolyline.segments().empty());
+    EXPECT_EQ(nullptr, emptyPolyline.nearestPointOnPath2(geo::Coordinate(0., 0.)).second);
+}
+
+namespace {
+    /**
+     * Zigzag between y = 0 and y = height, with an arc every 7th segment
+     */
+    LWPolyline_CSPtr zigzag(unsigned int count, double height, double step) {
+        std::vector<LWVertex2D> vertex;
+        for (unsigned int i = 0; i < count; i++) {
+            vertex.emplace_back(geo::Coordinate(i * step, (i % 2) * height), i % 7 == 0 ? 0.3 : 0.);
+        }
+
+        return std::make_shared<LWPolyline>(vertex, 0., 0., 0., false, geo::Coordinate(0., 0., 1.), nullptr);
+    }
+}
+
+TEST(lc__entity__LWPolylineTest, segmentTreeNearest) {
+    auto lwp = zigzag(2000, 10., 1.);
+    ASSERT_GE(lwp->segments().size(), LWPolyline::SEGMENT_TREE_MINIMUM_SIZE);
+
+    for (double x = -20.; x < 2020.; x += 37.3) {
+        geo::Coordinate coord(x, 4. + std::sin(x) * 10.);
+
+        double expected = std::numeric_limits<double>::max();
+        for (const auto& segment : lwp->segments()) {
+            expected = std::min(expected, segment.nearestPointOnEntity(coord).distanceTo(coord));
+        }
+
+        auto nearest = lwp->nearestPointOnPath2(coord);
+        ASSERT_NE(nullptr, nearest.second);
+        EXPECT_NEAR(expected, nearest.first.distanceTo(coord), LCTOLERANCE);
+    }
+}
+
+TEST(lc__entity__LWPolylineTest, segmentTreeShared) {
+    auto lwp = zigzag(100, 10., 1.);
+    auto modified = std::dynamic_pointer_cast<const LWPolyline>(lwp->modify(nullptr, nullptr, nullptr));
+    ASSERT_NE(nullptr, modified);
+
+    EXPECT_EQ(lwp->id(), modified->id());
+    EXPECT_EQ(lwp->segments().size(), modified->segments().size());
+
+    // The tree is built once, by whichever entity needs it first
+    EXPECT_EQ(&modified->segmentTree(), &lwp->segmentTree());
+
+    auto copy = std::make_shared<LWPolyline>(lwp, true);
+    EXPECT_EQ(&lwp->segmentTree(), &copy->segmentTree());
+
+    auto moved = std::dynamic_pointer_cast<const LWPolyline>(lwp->move(geo::Coordinate(1., 0.)));
+    EXPECT_NE(&lwp->segmentTree(), &moved->segmentTree());
+}
+
+TEST(lc__entity__LWPolylineTest, segmentTreeIntersect) {
+    auto lwp1 = zigzag(500, 10., 1.);
+    auto lwp2 = zigzag(300, 6., 1.7);
+
+    maths::Intersect intersect(maths::Intersect::OnEntity, LCTOLERANCE);
+    intersect(*lwp1, *lwp2);
+    auto result = intersect.result();
+
+    // Intersect every pair of segments, lwp2 is the shortest so its segments come first
+    std::vector<geo::Coordinate> expected;
+    for (const auto& segment1 : lwp1->segments()) {
+        for (const auto& segment2 : lwp2->segments()) {
+            std::vector<LWVertex2D> vertex1{LWVertex2D(segment1.start, segment1.bulge), LWVertex2D(segment1.end)};
+            std::vector<LWVertex2D> vertex2{LWVertex2D(segment2.start, segment2.bulge), LWVertex2D(segment2.end)};
+            LWPolyline single1(vertex1, 0., 0., 0., false, geo::Coordinate(0., 0., 1.), nullptr);
+            LWPolyline single2(vertex2, 0., 0., 0., false, geo::Coordinate(0., 0., 1.), nullptr);
+
+            maths::Intersect pairIntersect(maths::Intersect::OnEntity, LCTOLERANCE);
+            pairIntersect(single2, single1);
+            auto points = pairIntersect.result();
+            expected.insert(expected.end(), points.begin(), points.end());
+        }
+    }
+
+    auto less = [](const geo::Coordinate& a, const geo::Coordinate& b) {
+        return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+    };
+    std::sort(result.begin(), result.end(), less);
+    std::sort(expected.begin(), expected.end(), less);
+
+    EXPECT_GT(expected.size(), 100);
+    EXPECT_EQ(expected, result);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <cad/storage/entitycontainer.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+
+namespace {
+    lc::entity::Line_CSPtr line(double x) {
+        return std::make_shared<lc::entity::Line>(
+                lc::geo::Coordinate(x, 0.), lc::geo::Coordinate(x, 10.), std::make_shared<const lc::meta::Layer>()
+        );
+    }
+}
+
+TEST(EntityContainerTest, CopyOnWrite) {
+    lc::storage::EntityContainer<lc::entity::CADEntity_CSPtr> container;
+    auto line1 = line(0.);
+    auto line2 = line(10.);
+    container.insert(line1);
+
+    // Modifying the copy doesn't change the original
+    auto copy = container;
+    copy.insert(line2);
+    EXPECT_EQ(1, container.asVector().size());
+    EXPECT_EQ(2, copy.asVector().size());
+    EXPECT_EQ(nullptr, container.entityByID(line2->id()));
+
+    // Modifying the original doesn't change the copy
+    auto snapshot = copy;
+    copy.remove(line1);
+    EXPECT_EQ(1, copy.asVector().size());
+    EXPECT_EQ(2, snapshot.asVector().size());
+    EXPECT_EQ(line1, snapshot.entityByID(line1->id()));
+
+    copy = container;
+    EXPECT_EQ(line1, copy.entityByID(line1->id()));
+    EXPECT_EQ(nullptr, copy.entityByID(line2->id()));
+}
+
+TEST(EntityContainerTest, Replace) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto original = line(0.);
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(original);
+    builder->execute();
+
+    // Same ID, replaces the entity in the document
+    auto moved = original->move(lc::geo::Coordinate(5., 0.));
+    builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(moved);
+    builder->execute();
+
+    ASSERT_EQ(1, document->entityContainer().asVector().size());
+    EXPECT_EQ(moved, document->entityContainer().entityByID(original->id()));
+
+    builder->undo();
+    ASSERT_EQ(1, document->entityContainer().asVector().size());
+    EXPECT_EQ(original, document->entityContainer().entityByID(original->id()));
+}
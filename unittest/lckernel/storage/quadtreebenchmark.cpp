@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <cad/storage/quadtree.h>
+#include <cad/primitive/line.h>
+#include "benchmarkhelpers.h"
+
+using lc::test::elapsed;
+
+/*
+ * Compare the arena based QuadTree against the pointer based QuadTreeSub
+ */
+namespace {
+    const unsigned int BENCHMARK_ENTITIES = 200000;
+    const unsigned int BENCHMARK_QUERIES = 2000;
+
+    const lc::geo::Area BENCHMARK_AREA(lc::geo::Coordinate(-400000., -400000.), lc::geo::Coordinate(400000., 400000.));
+
+    template<typename T>
+    void benchmark(T& tree, const std::vector<lc::entity::CADEntity_CSPtr>& lines,
+                   const std::vector<lc::geo::Area>& queries, const std::string& name) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines) {
+            tree.insert(line);
+        }
+        double insertTime = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t found = 0;
+        for (const auto& query : queries) {
+            found += tree.retrieve(query).size();
+        }
+        double retrieveTime = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < lines.size(); i += 2) {
+            tree.erase(lines[i]);
+        }
+        double eraseTime = elapsed(start);
+
+        std::cout << name << ": insert " << insertTime << "ms, "
+                  << "retrieve " << retrieveTime << "ms (" << found << " results), "
+                  << "erase " << eraseTime << "ms" << std::endl;
+
+        EXPECT_EQ(lines.size() / 2, tree.retrieve().size());
+    }
+}
+
+TEST(QuadTreeBenchmark, InsertRetrieveErase) {
+    auto lines = lc::test::randomLines(BENCHMARK_ENTITIES, BENCHMARK_AREA, 50.);
+    auto queries = lc::test::randomAreas(BENCHMARK_QUERIES, BENCHMARK_AREA, 5000.);
+
+    lc::geo::Area bounds(lc::geo::Coordinate(-500000., -500000.), lc::geo::Coordinate(500000., 500000.));
+
+    lc::storage::QuadTreeSub<lc::entity::CADEntity_CSPtr> pointerTree(bounds);
+    benchmark(pointerTree, lines, queries, "QuadTreeSub");
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> arenaTree(bounds);
+    benchmark(arenaTree, lines, queries, "QuadTree");
+}
+
+/*
+ * Entities crossing the center of the tree can't be moved down, erasing them used to be a linear scan
+ */
+TEST(QuadTreeBenchmark, CrowdedNode) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> position(1., 400000.);
+    auto layer = std::make_shared<const lc::meta::Layer>();
+
+    std::vector<lc::entity::CADEntity_CSPtr> lines;
+    for (unsigned int i = 0; i < BENCHMARK_ENTITIES / 10; i++) {
+        lc::geo::Coordinate start(-position(gen), -position(gen));
+        lines.push_back(std::make_shared<lc::entity::Line>(start, lc::geo::Coordinate(position(gen), position(gen)), layer));
+    }
+
+    std::vector<lc::geo::Area> queries;
+    for (unsigned int i = 0; i < BENCHMARK_QUERIES / 10; i++) {
+        queries.emplace_back(lc::geo::Coordinate(position(gen), position(gen)), 5000., 5000.);
+    }
+
+    lc::geo::Area bounds(lc::geo::Coordinate(-500000., -500000.), lc::geo::Coordinate(500000., 500000.));
+
+    lc::storage::QuadTreeSub<lc::entity::CADEntity_CSPtr> pointerTree(bounds);
+    benchmark(pointerTree, lines, queries, "QuadTreeSub");
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> arenaTree(bounds);
+    benchmark(arenaTree, lines, queries, "QuadTree");
+}
+
+/*
+ * Build the tree in a single pass, as done when opening a file, compared to inserting the entities one by one
+ */
+TEST(QuadTreeBenchmark, BulkLoad) {
+    // Size of a large drawing
+    auto lines = lc::test::randomLines(BENCHMARK_ENTITIES * 5, BENCHMARK_AREA, 50.);
+
+    lc::geo::Area bounds(lc::geo::Coordinate(-500000., -500000.), lc::geo::Coordinate(500000., 500000.));
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> incrementalTree(bounds);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+        incrementalTree.insert(line);
+    }
+    double insertTime = elapsed(start);
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> bulkTree(bounds);
+    start = std::chrono::steady_clock::now();
+    bulkTree.bulkLoad(lines);
+    double bulkLoadTime = elapsed(start);
+
+    std::cout << "QuadTree: insert " << insertTime << "ms, bulkLoad " << bulkLoadTime << "ms" << std::endl;
+
+    EXPECT_EQ(lines.size(), bulkTree.size());
+    EXPECT_TRUE(bulkTree.test());
+}
+
+/*
+ * Geo-referenced drawing in UTM coordinates, outside of the bounds the tree was created with
+ */
+TEST(QuadTreeBenchmark, UTMCoordinates) {
+    lc::geo::Area utmArea(lc::geo::Coordinate(400000., 5600000.), lc::geo::Coordinate(420000., 5620000.));
+    auto lines = lc::test::randomLines(BENCHMARK_ENTITIES / 10, utmArea, 5.);
+    auto queries = lc::test::randomAreas(BENCHMARK_QUERIES / 10, utmArea, 200.);
+
+    lc::geo::Area bounds(lc::geo::Coordinate(-500000., -500000.), lc::geo::Coordinate(500000., 500000.));
+
+    lc::storage::QuadTreeSub<lc::entity::CADEntity_CSPtr> pointerTree(bounds);
+    benchmark(pointerTree, lines, queries, "QuadTreeSub");
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> arenaTree(bounds);
+    benchmark(arenaTree, lines, queries, "QuadTree");
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> bulkTree(bounds);
+    bulkTree.bulkLoad(lines);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (const auto& query : queries) {
+        found += bulkTree.retrieve(query).size();
+    }
+    std::cout << "QuadTree after bulkLoad: retrieve " << elapsed(start) << "ms (" << found << " results)" << std::endl;
+}
+
+/*
+ * Overlap test using the bounding boxes stored in the tree, compared to asking each candidate for it's bounding box
+ */
+TEST(QuadTreeBenchmark, OverlapQuery) {
+    auto lines = lc::test::randomLines(BENCHMARK_ENTITIES, BENCHMARK_AREA, 50.);
+    auto queries = lc::test::randomAreas(BENCHMARK_QUERIES, BENCHMARK_AREA, 20000.);
+
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-500000., -500000.),
+                                                                           lc::geo::Coordinate(500000., 500000.)));
+    tree.bulkLoad(lines);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (const auto& query : queries) {
+        tree.visit(query, [&](const lc::entity::CADEntity_CSPtr& entity) {
+            if (entity->boundingBox().overlaps(query)) {
+                found++;
+            }
+        });
+    }
+    double visitTime = elapsed(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t foundOverlapping = 0;
+    for (const auto& query : queries) {
+        tree.visitOverlapping(query, [&](const lc::entity::CADEntity_CSPtr&, const lc::geo::Area&) {
+            foundOverlapping++;
+        });
+    }
+    double visitOverlappingTime = elapsed(start);
+
+    std::cout << "QuadTree: visit and boundingBox " << visitTime << "ms, "
+              << "visitOverlapping " << visitOverlappingTime << "ms (" << found << " results)" << std::endl;
+
+    EXPECT_EQ(found, foundOverlapping);
+}
@@ -0,0 +1,418 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+#include <cad/storage/quadtree.h>
+#include <cad/primitive/line.h>
+
+namespace {
+    std::vector<lc::entity::CADEntity_CSPtr> randomLines(unsigned int count, double size, double length) {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> position(-size, size);
+        std::uniform_real_distribution<double> offset(-length, length);
+        auto layer = std::make_shared<const lc::meta::Layer>();
+
+        std::vector<lc::entity::CADEntity_CSPtr> lines;
+        lines.reserve(count);
+        for (unsigned int i = 0; i < count; i++) {
+            lc::geo::Coordinate start(position(gen), position(gen));
+            lines.push_back(std::make_shared<lc::entity::Line>(start, start + lc::geo::Coordinate(offset(gen), offset(gen)), layer));
+        }
+
+        return lines;
+    }
+
+    std::vector<ID_DATATYPE> ids(const std::vector<lc::entity::CADEntity_CSPtr>& entities) {
+        std::vector<ID_DATATYPE> result;
+        for (const auto& entity : entities) {
+            result.push_back(entity->id());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    /**
+     * retrieve returns candidates, only the ones overlapping with area are compared
+     */
+    std::vector<ID_DATATYPE> ids(const std::vector<lc::entity::CADEntity_CSPtr>& entities, const lc::geo::Area& area) {
+        std::vector<ID_DATATYPE> result;
+        for (const auto& entity : entities) {
+            if (entity->boundingBox().overlaps(area)) {
+                result.push_back(entity->id());
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+}
+
+TEST(QuadTreeTest, InsertRetrieve) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+    lc::storage::QuadTreeSub<lc::entity::CADEntity_CSPtr> reference(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    for (const auto& line : lines) {
+        tree.insert(line);
+        reference.insert(line);
+    }
+
+    EXPECT_EQ(lines.size(), tree.size());
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(lines), ids(tree.retrieve()));
+
+    lc::geo::Area area(lc::geo::Coordinate(-100, -50), lc::geo::Coordinate(200, 300));
+    EXPECT_EQ(ids(reference.retrieve(area), area), ids(tree.retrieve(area), area));
+    EXPECT_EQ(ids(lines, area), ids(tree.retrieve(area), area));
+}
+
+TEST(QuadTreeTest, Erase) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+
+    std::vector<lc::entity::CADEntity_CSPtr> kept;
+    for (unsigned int i = 0; i < lines.size(); i++) {
+        if (i % 3 == 0) {
+            EXPECT_TRUE(tree.erase(lines[i]));
+            EXPECT_EQ(nullptr, tree.entityByID(lines[i]->id()));
+        }
+        else {
+            kept.push_back(lines[i]);
+        }
+    }
+
+    EXPECT_FALSE(tree.erase(lines[0]));
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(kept), ids(tree.retrieve()));
+    EXPECT_EQ(kept[10], tree.entityByID(kept[10]->id()));
+
+    for (const auto& line : kept) {
+        tree.erase(line);
+    }
+
+    EXPECT_TRUE(tree.optimise());
+    EXPECT_EQ(0, tree.size());
+
+    // Nodes released by optimise get re-used
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(lines), ids(tree.retrieve()));
+}
+
+TEST(QuadTreeTest, OptimiseDirtyNodes) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(20000, 900, 10);
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+    EXPECT_FALSE(tree.dirty());
+
+    auto countNodes = [&tree]() {
+        unsigned int count = 0;
+        tree.walkQuad([&count](const lc::storage::QuadTree<lc::entity::CADEntity_CSPtr>::Node&) {
+            count++;
+        });
+        return count;
+    };
+    const unsigned int nodes = countNodes();
+
+    // Clear the bottom left quarter
+    const lc::geo::Area cleared(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(0, 0));
+    std::vector<lc::entity::CADEntity_CSPtr> kept;
+    for (const auto& line : lines) {
+        if (line->boundingBox().inArea(cleared)) {
+            tree.erase(line);
+        }
+        else {
+            kept.push_back(line);
+        }
+    }
+    EXPECT_TRUE(tree.dirty());
+
+    EXPECT_FALSE(tree.optimise());
+    EXPECT_FALSE(tree.dirty());
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(kept), ids(tree.retrieve()));
+    EXPECT_LT(countNodes(), nodes);
+
+    // Nothing is left below the nodes within the cleared area
+    tree.walkQuad([&cleared](const lc::storage::QuadTree<lc::entity::CADEntity_CSPtr>::Node& node) {
+        if (node.bounds().inArea(cleared)) {
+            EXPECT_EQ(-1, node.firstChild);
+            EXPECT_TRUE(node.objects.empty());
+        }
+    });
+
+    // Nothing changed since the last call
+    EXPECT_FALSE(tree.optimise());
+    EXPECT_TRUE(tree.test());
+}
+
+TEST(QuadTreeTest, Replace) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+    auto layer = std::make_shared<const lc::meta::Layer>();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0, 0), lc::geo::Coordinate(10, 10), layer);
+    auto moved = line->move(lc::geo::Coordinate(500, 500));
+
+    tree.insert(line);
+    tree.insert(moved);
+
+    EXPECT_EQ(1, tree.size());
+    EXPECT_EQ(moved, tree.entityByID(line->id()));
+    EXPECT_TRUE(tree.test());
+}
+
+TEST(QuadTreeTest, BulkLoad) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    // Entities that can't be moved down, and one outside of the tree
+    auto layer = std::make_shared<const lc::meta::Layer>();
+    lines.push_back(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(-10, -10), lc::geo::Coordinate(10, 10), layer));
+    lines.push_back(std::make_shared<lc::entity::Line>(lc::geo::Coordinate(900, 900), lc::geo::Coordinate(1500, 1500), layer));
+
+    tree.bulkLoad(lines);
+
+    EXPECT_EQ(lines.size(), tree.size());
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(lines), ids(tree.retrieve()));
+
+    lc::geo::Area area(lc::geo::Coordinate(-100, -50), lc::geo::Coordinate(200, 300));
+    EXPECT_EQ(ids(lines, area), ids(tree.retrieve(area), area));
+
+    // Existing entities are replaced and kept when the tree is rebuild
+    std::vector<lc::entity::CADEntity_CSPtr> batch;
+    std::vector<lc::entity::CADEntity_CSPtr> expected;
+    for (unsigned int i = 0; i < lines.size(); i++) {
+        if (i % 2 == 0) {
+            batch.push_back(lines[i]->move(lc::geo::Coordinate(5, 5)));
+            expected.push_back(batch.back());
+        }
+        else {
+            expected.push_back(lines[i]);
+        }
+    }
+    auto extra = randomLines(4000, 900, 10);
+    batch.insert(batch.end(), extra.begin(), extra.end());
+    expected.insert(expected.end(), extra.begin(), extra.end());
+
+    tree.bulkLoad(batch);
+
+    EXPECT_EQ(expected.size(), tree.size());
+    EXPECT_TRUE(tree.test());
+    EXPECT_EQ(ids(expected, area), ids(tree.retrieve(area), area));
+    EXPECT_EQ(batch[0], tree.entityByID(lines[0]->id()));
+
+    // Small batches and duplicates within a batch
+    auto moved = lines[1]->move(lc::geo::Coordinate(-5, -5));
+    tree.bulkLoad({lines[1], moved});
+
+    EXPECT_EQ(expected.size(), tree.size());
+    EXPECT_EQ(moved, tree.entityByID(lines[1]->id()));
+    EXPECT_TRUE(tree.test());
+}
+
+TEST(QuadTreeTest, Grow) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(2000, 900, 10);
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+
+    // Entities far outside of the root in all directions
+    auto layer = std::make_shared<const lc::meta::Layer>();
+    std::vector<lc::entity::CADEntity_CSPtr> all = lines;
+    for (auto offset : {lc::geo::Coordinate(500000, 5000000), lc::geo::Coordinate(-30000, 2000), lc::geo::Coordinate(0, -80000)}) {
+        for (const auto& line : randomLines(500, 900, 10)) {
+            all.push_back(line->move(offset));
+            tree.insert(all.back());
+        }
+    }
+
+    EXPECT_EQ(all.size(), tree.size());
+    EXPECT_TRUE(tree.test());
+    EXPECT_TRUE(lc::geo::Area(lc::geo::Coordinate(-30900, -80900), lc::geo::Coordinate(500900, 5000900)).inArea(tree.bounds()));
+    EXPECT_EQ(ids(all), ids(tree.retrieve()));
+
+    lc::geo::Area area(lc::geo::Coordinate(499900, 4999900), lc::geo::Coordinate(500100, 5000100));
+    EXPECT_EQ(ids(all, area), ids(tree.retrieve(area), area));
+}
+
+TEST(QuadTreeTest, BulkLoadFit) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-500000, -500000), lc::geo::Coordinate(500000, 500000)));
+
+    std::vector<lc::entity::CADEntity_CSPtr> lines;
+    for (const auto& line : randomLines(5000, 900, 10)) {
+        lines.push_back(line->move(lc::geo::Coordinate(500000, 5000000)));
+    }
+
+    tree.bulkLoad(lines);
+
+    EXPECT_TRUE(tree.test());
+    EXPECT_LT(tree.bounds().width(), 2000);
+    EXPECT_TRUE(lc::geo::Area(lc::geo::Coordinate(499100, 4999100), lc::geo::Coordinate(500900, 5000900)).inArea(tree.bounds()));
+
+    lc::geo::Area area(lc::geo::Coordinate(499900, 4999900), lc::geo::Coordinate(500100, 5000100));
+    EXPECT_EQ(ids(lines, area), ids(tree.retrieve(area), area));
+}
+
+TEST(QuadTreeTest, Rebalance) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    tree.bulkLoad(lines);
+    EXPECT_FALSE(tree.needsRebalance());
+    EXPECT_FALSE(tree.rebalance());
+
+    // A few entities far away grow the root
+    auto far = randomLines(10, 900, 10);
+    for (auto& line : far) {
+        line = line->move(lc::geo::Coordinate(500000, 500000));
+        tree.insert(line);
+    }
+    EXPECT_FALSE(tree.needsRebalance());
+    EXPECT_GT(tree.bounds().width(), 500000);
+
+    // Once a large part of the tree changed, the root gets fitted again
+    for (const auto& line : far) {
+        tree.erase(line);
+    }
+    for (unsigned int i = 0; i < lines.size() / 4; i++) {
+        tree.erase(lines[i]);
+    }
+    ASSERT_TRUE(tree.needsRebalance());
+    EXPECT_TRUE(tree.rebalance());
+    EXPECT_FALSE(tree.needsRebalance());
+    EXPECT_FALSE(tree.dirty());
+
+    std::vector<lc::entity::CADEntity_CSPtr> kept(lines.begin() + lines.size() / 4, lines.end());
+    EXPECT_TRUE(tree.test());
+    EXPECT_LT(tree.bounds().width(), 2000);
+    EXPECT_EQ(ids(kept), ids(tree.retrieve()));
+
+    lc::geo::Area area(lc::geo::Coordinate(-100, -50), lc::geo::Coordinate(200, 300));
+    EXPECT_EQ(ids(kept, area), ids(tree.retrieve(area), area));
+}
+
+TEST(QuadTreeTest, VisitOverlapping) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+
+    for (const auto& area : {lc::geo::Area(lc::geo::Coordinate(-100, -50), lc::geo::Coordinate(200, 300)),
+                             lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)),
+                             lc::geo::Area(lc::geo::Coordinate(5, 5), lc::geo::Coordinate(5, 5))}) {
+        std::vector<lc::entity::CADEntity_CSPtr> found;
+        tree.visitOverlapping(area, [&](const lc::entity::CADEntity_CSPtr& entity, const lc::geo::Area& boundingBox) {
+            EXPECT_EQ(entity->boundingBox(), boundingBox);
+            found.push_back(entity);
+        });
+
+        EXPECT_EQ(ids(lines, area), ids(found));
+    }
+}
+
+TEST(QuadTreeTest, LevelOfDetail) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(20000, 100, 2);
+    for (const auto& line : lines) {
+        tree.insert(line);
+    }
+
+    EXPECT_EQ(SHRT_MAX, tree.levelForSize(0.));
+    EXPECT_EQ(tree.level(), tree.levelForSize(5000.));
+
+    const double size = 10.;
+    const short maxLevel = tree.levelForSize(size);
+    EXPECT_LT(maxLevel, tree.maxLevels());
+
+    lc::geo::Area area(lc::geo::Coordinate(-50, -50), lc::geo::Coordinate(50, 50));
+
+    std::vector<ID_DATATYPE> visited;
+    tree.visitOverlapping(area, [&](const lc::entity::CADEntity_CSPtr& entity, const lc::geo::Area&) {
+        visited.push_back(entity->id());
+    }, maxLevel);
+    std::sort(visited.begin(), visited.end());
+
+    std::vector<lc::geo::Area> culled;
+    tree.visitCulled(area, [&](const lc::entity::CADEntity_CSPtr& entity, const lc::geo::Area& nodeBounds) {
+        EXPECT_TRUE(entity->boundingBox().inArea(nodeBounds));
+        culled.push_back(nodeBounds);
+    }, maxLevel);
+    EXPECT_FALSE(culled.empty());
+
+    // Each skipped entity is smaller than size and within one of the culled areas
+    unsigned int skipped = 0;
+    for (const auto& line : lines) {
+        auto box = line->boundingBox();
+        if (!box.overlaps(area) || std::binary_search(visited.begin(), visited.end(), line->id())) {
+            continue;
+        }
+
+        skipped++;
+        EXPECT_LT(box.width(), size);
+        EXPECT_LT(box.height(), size);
+        EXPECT_TRUE(std::any_of(culled.begin(), culled.end(), [&](const lc::geo::Area& culledArea) {
+            return box.inArea(culledArea);
+        }));
+    }
+    EXPECT_GT(skipped, 0);
+}
+
+TEST(QuadTreeTest, Nearest) {
+    lc::storage::QuadTree<lc::entity::CADEntity_CSPtr> tree(lc::geo::Area(lc::geo::Coordinate(-1000, -1000), lc::geo::Coordinate(1000, 1000)));
+
+    auto lines = randomLines(5000, 900, 10);
+    tree.bulkLoad(lines);
+
+    auto pathDistance = [](const lc::geo::Coordinate& point, const lc::entity::CADEntity_CSPtr& entity) {
+        auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity);
+        return line->nearestPointOnEntity(point).distanceTo(point);
+    };
+
+    for (const auto& point : {lc::geo::Coordinate(0, 0), lc::geo::Coordinate(-450, 300), lc::geo::Coordinate(2000, 2000)}) {
+        std::vector<double> expected;
+        for (const auto& line : lines) {
+            expected.push_back(pathDistance(point, line));
+        }
+        std::sort(expected.begin(), expected.end());
+
+        const unsigned int k = 10;
+        unsigned int tested = 0;
+        auto nearest = tree.nearest(point, k, std::numeric_limits<double>::infinity(), [&](const lc::entity::CADEntity_CSPtr& entity) {
+            tested++;
+            return pathDistance(point, entity);
+        });
+
+        ASSERT_EQ(k, nearest.size());
+        for (unsigned int i = 0; i < k; i++) {
+            EXPECT_DOUBLE_EQ(expected[i], nearest[i].second);
+            EXPECT_DOUBLE_EQ(expected[i], pathDistance(point, nearest[i].first));
+        }
+
+        // Only entities with a bounding box close to the point are tested
+        EXPECT_LT(tested, lines.size() / 10);
+    }
+
+    // Entities further away than the maximum distance are not returned
+    auto nearest = tree.nearest(lc::geo::Coordinate(0, 0), 100, 20., [&](const lc::entity::CADEntity_CSPtr& entity) {
+        return pathDistance(lc::geo::Coordinate(0, 0), entity);
+    });
+    for (const auto& item : nearest) {
+        EXPECT_LE(item.second, 20.);
+    }
+    EXPECT_TRUE(tree.nearest(lc::geo::Coordinate(0, 0), 0, 20., [](const lc::entity::CADEntity_CSPtr&) {
+        return 0.;
+    }).empty());
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+#include <cad/storage/segmentbvh.h>
+#include <cad/geometry/geovector.h>
+
+namespace {
+    std::vector<lc::geo::Vector> randomSegments(unsigned int count, double size, double length) {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> position(-size, size);
+        std::uniform_real_distribution<double> offset(-length, length);
+
+        std::vector<lc::geo::Vector> segments;
+        segments.reserve(count);
+        for (unsigned int i = 0; i < count; i++) {
+            lc::geo::Coordinate start(position(gen), position(gen));
+            segments.emplace_back(start, start + lc::geo::Coordinate(offset(gen), offset(gen)));
+        }
+
+        return segments;
+    }
+
+    std::vector<lc::geo::Area> boxes(const std::vector<lc::geo::Vector>& segments) {
+        std::vector<lc::geo::Area> result;
+        for (const auto& segment : segments) {
+            result.emplace_back(segment.start(), segment.end());
+        }
+        return result;
+    }
+}
+
+TEST(SegmentBVHTest, VisitOverlapping) {
+    auto segments = randomSegments(5000, 1000., 20.);
+    auto segmentBoxes = boxes(segments);
+    lc::storage::SegmentBVH bvh(segmentBoxes);
+    EXPECT_EQ(segments.size(), bvh.size());
+
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<double> position(-1000., 1000.);
+
+    for (int i = 0; i < 50; i++) {
+        lc::geo::Coordinate corner(position(gen), position(gen));
+        lc::geo::Area area(corner, corner + lc::geo::Coordinate(100., 50.));
+
+        std::vector<size_t> expected;
+        for (size_t index = 0; index < segmentBoxes.size(); index++) {
+            if (segmentBoxes[index].overlaps(area)) {
+                expected.push_back(index);
+            }
+        }
+
+        std::vector<size_t> visited;
+        bvh.visitOverlapping(area, [&visited](size_t index) {
+            visited.push_back(index);
+        });
+        std::sort(visited.begin(), visited.end());
+
+        EXPECT_EQ(expected, visited);
+    }
+}
+
+TEST(SegmentBVHTest, Nearest) {
+    auto segments = randomSegments(5000, 1000., 20.);
+    lc::storage::SegmentBVH bvh(boxes(segments));
+
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> position(-1100., 1100.);
+
+    for (int i = 0; i < 50; i++) {
+        lc::geo::Coordinate point(position(gen), position(gen));
+
+        double expected = std::numeric_limits<double>::infinity();
+        for (const auto& segment : segments) {
+            expected = std::min(expected, segment.nearestPointOnEntity(point).distanceTo(point));
+        }
+
+        size_t tested = 0;
+        auto nearest = bvh.nearest(point, [&](size_t index) {
+            tested++;
+            return segments[index].nearestPointOnEntity(point).distanceTo(point);
+        });
+
+        ASSERT_LT(nearest.first, segments.size());
+        EXPECT_DOUBLE_EQ(expected, nearest.second);
+        EXPECT_LT(tested, segments.size() / 10);
+    }
+}
+
+TEST(SegmentBVHTest, Empty) {
+    lc::storage::SegmentBVH bvh({});
+    EXPECT_EQ(0, bvh.size());
+
+    auto nearest = bvh.nearest(lc::geo::Coordinate(0., 0.), [](size_t index) {
+        return 0.;
+    });
+    EXPECT_EQ(0, nearest.first);
+
+    bool visited = false;
+    bvh.visitOverlapping(lc::geo::Area(lc::geo::Coordinate(-1., -1.), lc::geo::Coordinate(1., 1.)), [&visited](size_t index) {
+        visited = true;
+    });
+    EXPECT_FALSE(visited);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <cad/storage/undomanagerimpl.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+
+namespace {
+    const unsigned int LINES = 100;
+
+    void addLines(const std::shared_ptr<lc::storage::DocumentImpl>& document) {
+        auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+        for (unsigned int i = 0; i < LINES; i++) {
+            builder->appendEntity(std::make_shared<lc::entity::Line>(
+                    lc::geo::Coordinate(i, 0.), lc::geo::Coordinate(i, 10.), document->layerByName("0")));
+        }
+        builder->execute();
+    }
+
+    /**
+     * Move all lines
+     */
+    void moveLines(const std::shared_ptr<lc::storage::DocumentImpl>& document) {
+        auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+        for (const auto& entity : document->entityContainer().asVector()) {
+            builder->appendEntity(entity->move(lc::geo::Coordinate(1., 0.)));
+        }
+        builder->execute();
+    }
+
+    unsigned int undoAll(const lc::storage::UndoManagerImpl_SPtr& undoManager) {
+        unsigned int count = 0;
+        while (undoManager->canUndo()) {
+            undoManager->undo();
+            count++;
+        }
+        return count;
+    }
+}
+
+TEST(UndoManagerTest, MaximumUndoLevels) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(3, lc::storage::UndoManagerImpl::DEFAULT_MAXIMUM_UNDO_SIZE);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+    addLines(document);
+
+    for (int i = 0; i < 5; i++) {
+        moveLines(document);
+    }
+
+    // The 3 last moves are undone
+    EXPECT_EQ(3, undoAll(undoManager));
+    EXPECT_EQ(LINES, document->entityContainer().asVector().size());
+    EXPECT_EQ(2., document->entityContainer().boundingBox().minP().x());
+}
+
+TEST(UndoManagerTest, MaximumUndoSize) {
+    // Each move keeps the previous lines
+    const size_t moveSize = LINES * lc::operation::EntityBuilder::ENTITY_MEMORY_SIZE;
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(100, 3 * moveSize + moveSize / 2);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+    addLines(document);
+
+    for (int i = 0; i < 10; i++) {
+        moveLines(document);
+        EXPECT_LE(undoManager->memorySize(), 3 * moveSize + moveSize / 2);
+    }
+
+    EXPECT_EQ(3, undoAll(undoManager));
+}
+
+TEST(UndoManagerTest, KeepLastOperation) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(100, 1);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+    addLines(document);
+
+    moveLines(document);
+    moveLines(document);
+
+    EXPECT_EQ(1, undoAll(undoManager));
+}
+
+TEST(UndoManagerTest, PurgeRedo) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto undoManager = std::make_shared<lc::storage::UndoManagerImpl>(100, lc::storage::UndoManagerImpl::DEFAULT_MAXIMUM_UNDO_SIZE);
+    document->commitProcessEvent().connect<lc::storage::UndoManagerImpl, &lc::storage::UndoManagerImpl::on_CommitProcessEvent>(undoManager.get());
+    addLines(document);
+
+    moveLines(document);
+    moveLines(document);
+    auto size = undoManager->memorySize();
+
+    // Undone operations are counted until a new operation is done
+    undoManager->undo();
+    undoManager->undo();
+    EXPECT_TRUE(undoManager->canRedo());
+    EXPECT_EQ(size, undoManager->memorySize());
+
+    moveLines(document);
+    EXPECT_FALSE(undoManager->canRedo());
+    EXPECT_LT(undoManager->memorySize(), size);
+
+    undoManager->removeUndoables();
+    EXPECT_EQ(0, undoManager->memorySize());
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "documentcanvas.h"
+#include "lcdrawoptions.h"
+#include "nullpainter.h"
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/blockops.h>
+#include <cad/builders/insert.h>
+#include <cad/meta/metacolor.h>
+#include <cad/primitive/line.h>
+#include <cad/primitive/insert.h>
+
+namespace {
+    const unsigned int INSERTS = 100;
+
+    /**
+     * Painter remembering the translation and color of each stroke
+     */
+    class StrokePainter : public NullPainter {
+        public:
+            struct Stroke {
+                double x;
+                double y;
+                lc::Color color;
+            };
+
+            void stroke() override {
+                NullPainter::stroke();
+
+                double x = 0.;
+                double y = 0.;
+                getTranslate(&x, &y);
+                _strokes.push_back({x, y, lc::Color(red(), green(), blue())});
+            }
+
+            std::vector<Stroke>& strokeList() {
+                return _strokes;
+            }
+
+        private:
+            std::vector<Stroke> _strokes;
+    };
+}
+
+/*
+ * Each test draws 100 inserts on a row of a block containing 2 lines
+ */
+class BlockDrawListTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+            docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+            block = std::make_shared<lc::meta::Block>("Block", lc::geo::Coordinate(0., 0.));
+
+            std::make_shared<lc::operation::AddBlock>(document, block)->execute();
+            auto layer = document->layerByName("0");
+
+            // Inserts on a row, a insert of a block is drawn from 0,0 to 10,10
+            auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+            builder->appendEntity(std::make_shared<lc::entity::Line>(
+                    lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 0.), layer, nullptr, block));
+            builder->appendEntity(std::make_shared<lc::entity::Line>(
+                    lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(0., 10.), layer,
+                    lc::meta::MetaInfo::create()->add(std::make_shared<lc::meta::MetaColorByBlock>()), block));
+
+            for (unsigned int i = 0; i < INSERTS; i++) {
+                lc::builder::InsertBuilder insertBuilder;
+                insertBuilder.setLayer(layer);
+                insertBuilder.setMetaInfo(
+                        lc::meta::MetaInfo::create()->add(std::make_shared<lc::meta::MetaColorByValue>(1., 0., 0.)));
+                insertBuilder.setDisplayBlock(block);
+                insertBuilder.setCoordinate(lc::geo::Coordinate(i * 100., 0.));
+                insertBuilder.setDocument(document);
+                builder->appendEntity(insertBuilder.build());
+            }
+            builder->execute();
+        }
+
+        void render() {
+            painter.strokeList().clear();
+            docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT,
+                              lc::geo::Area(lc::geo::Coordinate(-50., -50.), lc::geo::Coordinate(INSERTS * 100., 50.)));
+        }
+
+        std::shared_ptr<lc::storage::DocumentImpl> document;
+        lc::viewer::DocumentCanvas_SPtr docCanvas;
+        lc::meta::Block_SPtr block;
+        StrokePainter painter;
+};
+
+TEST_F(BlockDrawListTest, Render) {
+    render();
+    auto& strokes = painter.strokeList();
+    ASSERT_EQ(2 * INSERTS, strokes.size());
+
+    // Each insert draws the entities of the block translated to its position
+    for (unsigned int i = 0; i < INSERTS; i++) {
+        auto count = std::count_if(strokes.begin(), strokes.end(), [i](const StrokePainter::Stroke& stroke) {
+            return stroke.x == i * 100. && stroke.y == 0.;
+        });
+        EXPECT_EQ(2, count);
+    }
+
+    // The translation of a insert is not kept after drawing
+    double x = 1.;
+    double y = 1.;
+    painter.getTranslate(&x, &y);
+    EXPECT_EQ(0., x);
+    EXPECT_EQ(0., y);
+}
+
+TEST_F(BlockDrawListTest, ColorByBlock) {
+    render();
+    auto& strokes = painter.strokeList();
+
+    // Only the line with a color ByBlock uses the color of the insert
+    auto red = std::count_if(strokes.begin(), strokes.end(), [](const StrokePainter::Stroke& stroke) {
+        return stroke.color.red() == 1. && stroke.color.green() == 0. && stroke.color.blue() == 0.;
+    });
+    EXPECT_EQ(INSERTS, red);
+}
+
+TEST_F(BlockDrawListTest, AddBlockEntity) {
+    render();
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<lc::entity::Line>(
+            lc::geo::Coordinate(10., 0.), lc::geo::Coordinate(10., 10.), document->layerByName("0"), nullptr, block));
+    builder->execute();
+
+    // Every insert shows the new entity
+    render();
+    EXPECT_EQ(3 * INSERTS, painter.strokeList().size());
+}
+
+TEST_F(BlockDrawListTest, Selection) {
+    // Select the second insert
+    docCanvas->makeSelection(95., -5., 20., 20., false);
+    docCanvas->closeSelection();
+    ASSERT_EQ(1, docCanvas->selectedDrawables().size());
+
+    render();
+    const auto& selectedColor = docCanvas->drawOptions().selectedColor();
+    auto& strokes = painter.strokeList();
+    for (const auto& stroke : strokes) {
+        bool selected = stroke.color.red() == selectedColor.red() &&
+                        stroke.color.green() == selectedColor.green() &&
+                        stroke.color.blue() == selectedColor.blue();
+        EXPECT_EQ(stroke.x == 100., selected);
+    }
+}
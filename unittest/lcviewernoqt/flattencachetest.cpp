@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include "nullpainter.h"
+#include "drawitems/flattencache.h"
+#include "drawitems/lcvarc.h"
+#include "drawitems/lcvcircle.h"
+#include "drawitems/lcvellipse.h"
+#include "drawitems/lcvspline.h"
+#include "lcdrawoptions.h"
+
+namespace {
+    /**
+     * Painter remembering the path, and how many analytic curves were drawn
+     */
+    class PathPainter : public NullPainter {
+        public:
+            void move_to(double x, double y) override {
+                moves++;
+                path.emplace_back(x, y);
+            }
+
+            void line_to(double x, double y) override {
+                path.emplace_back(x, y);
+            }
+
+            void circle(double x, double y, double r) override {
+                curves++;
+            }
+
+            void curve_to(double x1, double y1, double x2, double y2, double x3, double y3) override {
+                curves++;
+            }
+
+            void reset() {
+                path.clear();
+                moves = 0;
+                curves = 0;
+            }
+
+            std::vector<lc::geo::Coordinate> path;
+            unsigned int moves = 0;
+            unsigned int curves = 0;
+    };
+
+    /**
+     * Largest distance between the middle of a segment of the path and a circle
+     */
+    double circleDeviation(const std::vector<lc::geo::Coordinate>& path, const lc::geo::Coordinate& center, double radius) {
+        double deviation = 0.;
+        for (size_t i = 1; i < path.size(); i++) {
+            deviation = std::max(deviation, std::abs(path[i - 1].mid(path[i]).distanceTo(center) - radius));
+        }
+        return deviation;
+    }
+
+    const auto layer = std::make_shared<const lc::meta::Layer>();
+}
+
+TEST(FlattenCacheTest, Circle) {
+    lc::viewer::LCVCircle circle(std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(10., 20.), 100., layer));
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+
+    circle.draw(painter, options, lc::geo::Area());
+    EXPECT_EQ(0, painter.curves);
+    EXPECT_EQ(1, painter.moves);
+    ASSERT_GT(painter.path.size(), 8);
+    EXPECT_EQ(1, painter.strokes());
+
+    // Closed, and within tolerance of the circle at the largest scale of the bucket
+    EXPECT_NEAR(0., painter.path.front().distanceTo(painter.path.back()), 1e-9);
+    EXPECT_LE(circleDeviation(painter.path, lc::geo::Coordinate(10., 20.), 100.), lc::viewer::FlattenCache::TOLERANCE / 2.);
+}
+
+TEST(FlattenCacheTest, ScaleBucket) {
+    lc::viewer::LCVCircle circle(std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(0., 0.), 100., layer));
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+
+    circle.draw(painter, options, lc::geo::Area());
+    auto path = painter.path;
+
+    // Same power of two, the cached polyline is used
+    painter.reset();
+    painter.scale(1.5);
+    circle.draw(painter, options, lc::geo::Area());
+    EXPECT_EQ(path, painter.path);
+
+    // Zoomed in, more points are needed
+    painter.reset();
+    painter.scale(4.);
+    circle.draw(painter, options, lc::geo::Area());
+    EXPECT_GT(painter.path.size(), path.size());
+    EXPECT_LE(circleDeviation(painter.path, lc::geo::Coordinate(0., 0.), 100.),
+              lc::viewer::FlattenCache::TOLERANCE / 8.);
+}
+
+TEST(FlattenCacheTest, TooManyPoints) {
+    lc::viewer::LCVCircle circle(std::make_shared<lc::entity::Circle>(lc::geo::Coordinate(0., 0.), 1e6, layer));
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+    painter.scale(1000.);
+
+    // Drawn as analytic curve
+    circle.draw(painter, options, lc::geo::Area());
+    EXPECT_TRUE(painter.path.empty());
+    EXPECT_EQ(1, painter.curves);
+    EXPECT_EQ(1, painter.strokes());
+}
+
+TEST(FlattenCacheTest, Arc) {
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+
+    auto ccw = std::make_shared<lc::entity::Arc>(lc::geo::Coordinate(0., 0.), 10., 0., M_PI / 2., true, layer);
+    lc::viewer::LCVArc(ccw).draw(painter, options, lc::geo::Area());
+    EXPECT_EQ(0, painter.curves);
+    EXPECT_NEAR(0., painter.path.front().distanceTo(ccw->startP()), 1e-9);
+    EXPECT_NEAR(0., painter.path.back().distanceTo(ccw->endP()), 1e-9);
+    for (const auto& point : painter.path) {
+        EXPECT_GE(point.x(), -1e-9);
+        EXPECT_GE(point.y(), -1e-9);
+    }
+
+    // Clockwise from 0 to 90 degrees goes around through 270 degrees
+    painter.reset();
+    auto cw = std::make_shared<lc::entity::Arc>(lc::geo::Coordinate(0., 0.), 10., 0., M_PI / 2., false, layer);
+    lc::viewer::LCVArc(cw).draw(painter, options, lc::geo::Area());
+    EXPECT_NEAR(0., painter.path.front().distanceTo(cw->startP()), 1e-9);
+    EXPECT_NEAR(0., painter.path.back().distanceTo(cw->endP()), 1e-9);
+    EXPECT_TRUE(std::any_of(painter.path.begin(), painter.path.end(), [](const lc::geo::Coordinate& point) {
+        return point.distanceTo(lc::geo::Coordinate(0., -10.)) < 1.;
+    }));
+}
+
+TEST(FlattenCacheTest, Ellipse) {
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+
+    // Major axis rotated by 30 degrees
+    lc::geo::Coordinate majorP(std::cos(M_PI / 6.) * 50., std::sin(M_PI / 6.) * 50.);
+    auto ellipse = std::make_shared<lc::entity::Ellipse>(lc::geo::Coordinate(5., 5.), majorP, 20., 0., 0., false, layer);
+    lc::viewer::LCVEllipse(ellipse).draw(painter, options, lc::geo::Area());
+
+    ASSERT_GT(painter.path.size(), 8);
+    for (const auto& point : painter.path) {
+        auto local = (point - lc::geo::Coordinate(5., 5.)).rotate(-M_PI / 6.);
+        EXPECT_NEAR(1., std::pow(local.x() / 50., 2.) + std::pow(local.y() / 20., 2.), 1e-9);
+    }
+}
+
+TEST(FlattenCacheTest, Spline) {
+    std::vector<lc::geo::Coordinate> cp;
+    for (int i = 0; i < 200; i++) {
+        cp.emplace_back(i * 10., std::sin(i * 0.7) * 40.);
+    }
+    auto spline = std::make_shared<lc::entity::Spline>(cp, std::vector<double>(), std::vector<lc::geo::Coordinate>(),
+                                                       3, false, 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.,
+                                                       lc::geo::Spline::splineflag(0), layer);
+
+    lc::viewer::LcDrawOptions options;
+    PathPainter painter;
+    lc::viewer::LCVSpline(spline).draw(painter, options, lc::geo::Area());
+
+    // A single polyline instead of a curve for each bezier
+    EXPECT_EQ(0, painter.curves);
+    EXPECT_EQ(1, painter.moves);
+
+    for (size_t i = 1; i < painter.path.size(); i++) {
+        auto middle = painter.path[i - 1].mid(painter.path[i]);
+        EXPECT_LE(spline->nearestPointOnEntity(middle).distanceTo(middle), lc::viewer::FlattenCache::TOLERANCE / 2.);
+    }
+}
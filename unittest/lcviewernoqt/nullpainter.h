@@ -0,0 +1,119 @@
+#pragma once
+
+#include <painters/lcpainter.h>
+#include <tuple>
+#include <vector>
+
+/**
+ * Painter that doesn't draw anything, used to measure the cost of the document canvas itself
+ * Only scale and translation are tracked so device/user conversions work
+ */
+class NullPainter : public lc::viewer::LcPainter {
+    public:
+        NullPainter() : _scale(1.), _translateX(0.), _translateY(0.), _strokes(0), _points(0), _red(0.), _green(0.), _blue(0.) {
+        }
+
+        void new_path() override {}
+        void close_path() override {}
+        void new_sub_path() override {}
+        void clear(double r, double g, double b) override {}
+        void clear(double r, double g, double b, double a) override {}
+        void move_to(double x, double y) override {}
+        void line_to(double x, double y) override {}
+        void lineWidthCompensation(double lwc) override {}
+        void line_width(double lineWidth) override {}
+        double scale() override { return _scale; }
+        void scale(double s) override { _scale *= s; }
+        void rotate(double r) override {}
+        void arc(double x, double y, double r, double start, double end) override {}
+        void arcNegative(double x, double y, double r, double start, double end) override {}
+        void circle(double x, double y, double r) override {}
+        void ellipse(double cx, double cy, double rx, double ry, double sa, double ea, double ra) override {}
+        void rectangle(double x1, double y1, double w, double h) override {}
+        void stroke() override { _strokes++; }
+        void source_rgb(double r, double g, double b) override {}
+        void source_rgba(double r, double g, double b, double a) override { _red = r; _green = g; _blue = b; }
+        void translate(double x, double y) override { _translateX += x; _translateY += y; }
+
+        void user_to_device(double* x, double* y) override {
+            *x = (*x + _translateX) * _scale;
+            *y = (*y + _translateY) * _scale;
+        }
+
+        void device_to_user(double* x, double* y) override {
+            *x = *x / _scale - _translateX;
+            *y = *y / _scale - _translateY;
+        }
+
+        void user_to_device_distance(double* dx, double* dy) override {
+            *dx = *dx * _scale;
+            *dy = *dy * _scale;
+        }
+
+        void device_to_user_distance(double* dx, double* dy) override {
+            *dx = *dx / _scale;
+            *dy = *dy / _scale;
+        }
+
+        void font_size(double size, bool deviceCoords) override {}
+        void select_font_face(const char* text_val) override {}
+        void text(const char* text_val) override {}
+        lc::viewer::TextExtends text_extends(const char* text_val) override { return lc::viewer::TextExtends(); }
+        void quadratic_curve_to(double x1, double y1, double x2, double y2) override {}
+        void curve_to(double x1, double y1, double x2, double y2, double x3, double y3) override {}
+        void save() override { _saved.emplace_back(_scale, _translateX, _translateY); }
+
+        void restore() override {
+            if (!_saved.empty()) {
+                std::tie(_scale, _translateX, _translateY) = _saved.back();
+                _saved.pop_back();
+            }
+        }
+        long pattern_create_linear(double x1, double y1, double x2, double y2) override { return 0; }
+        void pattern_add_color_stop_rgba(long pat, double offset, double r, double g, double b, double a) override {}
+        void set_pattern_source(long pat) override {}
+        void pattern_destroy(long pat) override {}
+        void fill() override {}
+        void point(double x, double y, double size, bool deviceCoords) override { _points++; }
+        void reset_transformations() override { _scale = 1.; _translateX = 0.; _translateY = 0.; }
+        unsigned char* data() override { return nullptr; }
+        void set_dash(const double* dashes, const int num_dashes, double offset, bool scaled) override {}
+        long image_create(const std::string& file) override { return 0; }
+        void image_destroy(long image) override {}
+        void image(long image, double uvx, double vy, double vvx, double vvy, double x, double y) override {}
+        void disable_antialias() override {}
+        void enable_antialias() override {}
+        void getTranslate(double* x, double* y) override { *x = _translateX; *y = _translateY; }
+
+        /**
+         * Number of strokes since creation
+         */
+        unsigned long strokes() const {
+            return _strokes;
+        }
+
+        /**
+         * Number of points since creation
+         */
+        unsigned long points() const {
+            return _points;
+        }
+
+        /**
+         * Components of the last color set with source_rgba
+         */
+        double red() const { return _red; }
+        double green() const { return _green; }
+        double blue() const { return _blue; }
+
+    private:
+        double _scale;
+        double _translateX;
+        double _translateY;
+        unsigned long _strokes;
+        unsigned long _points;
+        double _red;
+        double _green;
+        double _blue;
+        std::vector<std::tuple<double, double, double>> _saved;
+};
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "documentcanvas.h"
+#include "nullpainter.h"
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/line.h>
+#include "benchmarkhelpers.h"
+
+using lc::test::elapsed;
+
+/*
+ * Count heap allocations so the benchmark can show how many allocations a single frame takes
+ */
+namespace {
+    std::atomic<unsigned long> allocations(0);
+}
+
+void* operator new(std::size_t size) {
+    allocations++;
+
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    const unsigned int BENCHMARK_GRID = 300;
+    const unsigned int BENCHMARK_FRAMES = 20;
+    const unsigned int RENDER_THREADS_FRAMES = 3;
+
+    void fillDocument(const std::shared_ptr<lc::storage::DocumentImpl>& document, unsigned int grid = BENCHMARK_GRID) {
+        auto layer = document->layerByName("0");
+
+        auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+        for (unsigned int x = 0; x < grid; x++) {
+            for (unsigned int y = 0; y < grid; y++) {
+                builder->appendEntity(std::make_shared<lc::entity::Line>(
+                        lc::geo::Coordinate(x * 10., y * 10.),
+                        lc::geo::Coordinate(x * 10. + 5., y * 10. + 5.),
+                        layer
+                ));
+            }
+        }
+        builder->execute();
+    }
+
+    /**
+     * Same area as used by render, for a 800x600 device
+     */
+    lc::geo::Area visibleArea(NullPainter& painter) {
+        double x = 0.;
+        double y = 0.;
+        double w = 800.;
+        double h = 600.;
+        painter.device_to_user(&x, &y);
+        painter.device_to_user_distance(&w, &h);
+        return lc::geo::Area(lc::geo::Coordinate(x, y), w, h);
+    }
+}
+
+TEST(RenderBenchmark, FrameAllocations) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+    docCanvas->setRenderThreads(1);
+    fillDocument(document);
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(1000., 1000.)));
+
+    lc::geo::Area visibleUserArea = visibleArea(painter);
+
+    // Query as it was done before: a new container for each frame
+    auto start = std::chrono::steady_clock::now();
+    unsigned long before = allocations;
+    size_t visible = 0;
+    for (unsigned int i = 0; i < BENCHMARK_FRAMES; i++) {
+        auto visibleEntities = document->entityContainer().entitiesWithinAndCrossingAreaFast(visibleUserArea);
+        visible = visibleEntities.asVector().size();
+    }
+    unsigned long containerAllocations = (allocations - before) / BENCHMARK_FRAMES;
+    double containerTime = elapsed(start) / BENCHMARK_FRAMES;
+
+    // Warm up, this sizes the list of visible drawables
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+
+    start = std::chrono::steady_clock::now();
+    before = allocations;
+    for (unsigned int i = 0; i < BENCHMARK_FRAMES; i++) {
+        docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    }
+    unsigned long renderAllocations = (allocations - before) / BENCHMARK_FRAMES;
+    double renderTime = elapsed(start) / BENCHMARK_FRAMES;
+
+    std::cout << "Visible entities: " << visible << std::endl
+              << "entitiesWithinAndCrossingAreaFast: " << containerAllocations << " allocations, " << containerTime << "ms per frame" << std::endl
+              << "DocumentCanvas::render: " << renderAllocations << " allocations, " << renderTime << "ms per frame" << std::endl;
+
+    EXPECT_EQ((BENCHMARK_FRAMES + 1) * visible, painter.strokes());
+    EXPECT_EQ(0, renderAllocations);
+}
+
+/*
+ * Frame time with the style of the visible entities resolved by multiple threads
+ */
+TEST(RenderBenchmark, RenderThreads) {
+    for (unsigned int grid : {317, 1000}) {
+        auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+        auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+        fillDocument(document, grid);
+
+        NullPainter painter;
+        docCanvas->newDeviceSize(800, 600);
+        docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(grid * 10., grid * 10.)));
+
+        // Every entity is drawn, so all threads have the same amount of work
+        auto options = docCanvas->drawOptions();
+        options.setLevelOfDetail(lc::viewer::LOD_NONE);
+        docCanvas->setDrawOptions(options);
+
+        size_t visible = 0;
+        document->entityContainer().eachWithinAndCrossingAreaFast(visibleArea(painter), [&](const lc::entity::CADEntity_CSPtr&) {
+            visible++;
+        });
+        std::cout << "Visible entities: " << visible << std::endl;
+
+        for (unsigned int threads : {1, 2, 4, 8}) {
+            docCanvas->setRenderThreads(threads);
+            docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+
+            unsigned long strokes = painter.strokes();
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < RENDER_THREADS_FRAMES; i++) {
+                docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+            }
+            double renderTime = elapsed(start) / RENDER_THREADS_FRAMES;
+
+            std::cout << threads << " threads: " << renderTime << "ms per frame" << std::endl;
+
+            EXPECT_EQ(RENDER_THREADS_FRAMES * visible, painter.strokes() - strokes);
+        }
+    }
+}
+
+/*
+ * Frame time of a zoomed out drawing where most entities are smaller than a pixel
+ */
+TEST(RenderBenchmark, LevelOfDetail) {
+    const unsigned int grid = 1000;
+
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+    docCanvas->setRenderThreads(1);
+    fillDocument(document, grid);
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(grid * 10., grid * 10.)));
+
+    unsigned long allStrokes = 0;
+
+    for (auto levelOfDetail : {lc::viewer::LOD_NONE, lc::viewer::LOD_SKIP, lc::viewer::LOD_PLACEHOLDER}) {
+        auto options = docCanvas->drawOptions();
+        options.setLevelOfDetail(levelOfDetail);
+        docCanvas->setDrawOptions(options);
+        docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+
+        unsigned long strokes = painter.strokes();
+        unsigned long points = painter.points();
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < RENDER_THREADS_FRAMES; i++) {
+            docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+        }
+        double renderTime = elapsed(start) / RENDER_THREADS_FRAMES;
+
+        strokes = (painter.strokes() - strokes) / RENDER_THREADS_FRAMES;
+        points = (painter.points() - points) / RENDER_THREADS_FRAMES;
+
+        std::cout << "Level of detail " << levelOfDetail << ": " << strokes << " strokes, " << points << " placeholders, "
+                  << renderTime << "ms per frame" << std::endl;
+
+        if (levelOfDetail == lc::viewer::LOD_NONE) {
+            allStrokes = strokes;
+        }
+        else {
+            EXPECT_LT(strokes, allStrokes);
+            EXPECT_EQ(levelOfDetail == lc::viewer::LOD_PLACEHOLDER, points > 0);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "renderworkers.h"
+
+using namespace lc::viewer;
+
+TEST(RenderWorkersTest, EachChunkOnce) {
+    RenderWorkers workers(4);
+    EXPECT_EQ(4, workers.threads());
+
+    // The same workers are used for each run
+    for (unsigned int run = 0; run < 100; run++) {
+        std::atomic<unsigned int> calls[4];
+        for (auto& c : calls) {
+            c = 0;
+        }
+
+        const unsigned int chunks = run % 4 + 1;
+        auto task = [&](unsigned int chunk) {
+            calls[chunk]++;
+        };
+        workers.run(chunks, task);
+
+        for (unsigned int chunk = 0; chunk < 4; chunk++) {
+            EXPECT_EQ(chunk < chunks ? 1 : 0, calls[chunk]);
+        }
+    }
+}
+
+TEST(RenderWorkersTest, Resize) {
+    RenderWorkers workers(1);
+    EXPECT_EQ(1, workers.threads());
+
+    // Without workers all chunks are done by the calling thread
+    std::thread::id caller = std::this_thread::get_id();
+    unsigned int calls = 0;
+    auto onCaller = [&](unsigned int chunk) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        calls++;
+    };
+    workers.run(3, onCaller);
+    EXPECT_EQ(3, calls);
+
+    workers.resize(3);
+    EXPECT_EQ(3, workers.threads());
+
+    std::atomic<unsigned int> done(0);
+    auto task = [&](unsigned int chunk) {
+        done++;
+    };
+    workers.run(3, task);
+    EXPECT_EQ(3, done);
+}
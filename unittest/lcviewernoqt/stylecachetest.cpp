@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "documentcanvas.h"
+#include "lcdrawoptions.h"
+#include "nullpainter.h"
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/meta/dxflinepattern.h>
+#include <cad/primitive/line.h>
+
+TEST(StyleCacheTest, ResolvedOnce) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto layer = std::make_shared<lc::meta::Layer>("1", lc::meta::MetaLineWidthByValue(1.), lc::Color(0., 1., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, layer)->execute();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 10.), layer);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(line);
+    builder->execute();
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(-10., -10.), lc::geo::Coordinate(20., 20.)));
+    auto drawable = docCanvas->getDrawable(line);
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    auto generation = drawable->style().generation;
+    EXPECT_NE(0, generation);
+    EXPECT_EQ(1., painter.green());
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_EQ(generation, drawable->style().generation);
+    EXPECT_EQ(1., painter.green());
+    EXPECT_EQ(2, painter.strokes());
+}
+
+TEST(StyleCacheTest, ReplaceLinePattern) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto layer = std::make_shared<lc::meta::Layer>("1", lc::meta::MetaLineWidthByValue(1.), lc::Color(0., 1., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, layer)->execute();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 10.), layer);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(line);
+    builder->execute();
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(-10., -10.), lc::geo::Coordinate(20., 20.)));
+    auto drawable = docCanvas->getDrawable(line);
+
+    auto pattern = std::make_shared<lc::meta::DxfLinePatternByValue>("DASHED", "", std::vector<double>{1., -1.}, 2.);
+    auto pattern2 = std::make_shared<lc::meta::DxfLinePatternByValue>("DASHED", "", std::vector<double>{2., -1.}, 3.);
+    document->addDocumentMetaType(pattern);
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    auto generation = drawable->style().generation;
+
+    document->replaceDocumentMetaType(pattern, pattern2);
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_NE(generation, drawable->style().generation);
+}
+
+TEST(StyleCacheTest, ReplaceLayer) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto layer = std::make_shared<lc::meta::Layer>("1", lc::meta::MetaLineWidthByValue(1.), lc::Color(0., 1., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, layer)->execute();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 10.), layer);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(line);
+    builder->execute();
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(-10., -10.), lc::geo::Coordinate(20., 20.)));
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_EQ(0., painter.red());
+    EXPECT_EQ(1., painter.green());
+
+    auto layer2 = std::make_shared<lc::meta::Layer>("2", lc::meta::MetaLineWidthByValue(1.), lc::Color(1., 0., 0.));
+    std::make_shared<lc::operation::ReplaceLayer>(document, layer, layer2)->execute();
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_EQ(1., painter.red());
+    EXPECT_EQ(0., painter.green());
+}
+
+TEST(StyleCacheTest, Selection) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    auto docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+    auto layer = std::make_shared<lc::meta::Layer>("1", lc::meta::MetaLineWidthByValue(1.), lc::Color(0., 1., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, layer)->execute();
+
+    auto line = std::make_shared<lc::entity::Line>(lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 10.), layer);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(line);
+    builder->execute();
+
+    NullPainter painter;
+    docCanvas->newDeviceSize(800, 600);
+    docCanvas->setDisplayArea(painter, lc::geo::Area(lc::geo::Coordinate(-10., -10.), lc::geo::Coordinate(20., 20.)));
+    auto drawable = docCanvas->getDrawable(line);
+    lc::viewer::LcDrawOptions options;
+
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    auto generation = drawable->style().generation;
+
+    drawable->selected(true);
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_EQ(options.selectedColor().red(), painter.red());
+    EXPECT_EQ(options.selectedColor().green(), painter.green());
+    EXPECT_EQ(options.selectedColor().blue(), painter.blue());
+
+    drawable->selected(false);
+    docCanvas->render(painter, lc::viewer::VIEWER_DOCUMENT);
+    EXPECT_EQ(1., painter.green());
+
+    // Selecting doesn't require the style to be resolved again
+    EXPECT_EQ(generation, drawable->style().generation);
+}
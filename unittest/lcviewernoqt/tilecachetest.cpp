@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "documentcanvas.h"
+#include "tilecache.h"
+#include "lcdrawoptions.h"
+#include "nullpainter.h"
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/operations/layerops.h>
+#include <cad/primitive/line.h>
+
+namespace {
+    const unsigned int DEVICE_WIDTH = 800;
+    const unsigned int DEVICE_HEIGHT = 600;
+    const unsigned int TILE_SIZE = 128;
+
+    /**
+     * Painter filling its image when something is drawn, so copied tiles can be recognised
+     */
+    class FillPainter : public NullPainter {
+        public:
+            FillPainter(unsigned char* data, unsigned int width, unsigned int height) :
+                    _data(data),
+                    _size(width * height * 4) {
+            }
+
+            void stroke() override {
+                NullPainter::stroke();
+                std::fill(_data, _data + _size, 0xFF);
+            }
+
+        private:
+            unsigned char* _data;
+            unsigned int _size;
+    };
+}
+
+/*
+ * Each test renders a drawing of 100x100 lines, covering 0,0 to 995,995
+ */
+class TileCacheTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+            docCanvas = std::make_shared<lc::viewer::DocumentCanvas>(document);
+
+            auto layer = document->layerByName("0");
+            auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+            for (unsigned int x = 0; x < 100; x++) {
+                for (unsigned int y = 0; y < 100; y++) {
+                    builder->appendEntity(std::make_shared<lc::entity::Line>(
+                            lc::geo::Coordinate(x * 10., y * 10.),
+                            lc::geo::Coordinate(x * 10. + 5., y * 10. + 5.),
+                            layer
+                    ));
+                }
+            }
+            builder->execute();
+
+            // Show 150,150 to 817,650, which is filled with lines
+            docCanvas->newDeviceSize(DEVICE_WIDTH, DEVICE_HEIGHT);
+            painter.scale(1.2);
+            painter.translate(-150., -150.);
+
+            image.assign(DEVICE_WIDTH * DEVICE_HEIGHT * 4, 0);
+            createTileCache(lc::viewer::TileCache::DEFAULT_MAXIMUM_BYTES);
+        }
+
+        void createTileCache(size_t maximumBytes) {
+            tileCache.reset();
+            tileCache.reset(new lc::viewer::TileCache(docCanvas, [](unsigned char* data, unsigned int width, unsigned int height) {
+                return new FillPainter(data, width, height);
+            }, maximumBytes, TILE_SIZE));
+        }
+
+        void render() {
+            tileCache->render(painter, image.data(), DEVICE_WIDTH, DEVICE_HEIGHT);
+        }
+
+        std::shared_ptr<lc::storage::DocumentImpl> document;
+        lc::viewer::DocumentCanvas_SPtr docCanvas;
+        std::unique_ptr<lc::viewer::TileCache> tileCache;
+        NullPainter painter;
+        std::vector<unsigned char> image;
+};
+
+TEST_F(TileCacheTest, Render) {
+    render();
+    auto rendered = tileCache->renderedTiles();
+    EXPECT_GT(rendered, 0);
+    EXPECT_EQ(rendered, tileCache->size());
+
+    // All tiles contain lines, so the whole image is filled
+    EXPECT_TRUE(std::all_of(image.begin(), image.end(), [](unsigned char value) {
+        return value == 0xFF;
+    }));
+
+    // Nothing changed, every tile comes from the cache
+    render();
+    EXPECT_EQ(rendered, tileCache->renderedTiles());
+}
+
+TEST_F(TileCacheTest, Pan) {
+    render();
+    auto rendered = tileCache->renderedTiles();
+
+    // Move a tile to the left, only a single column of tiles becomes visible
+    painter.translate(-(double) TILE_SIZE / painter.scale(), 0.);
+    render();
+
+    auto tilesPerColumn = (DEVICE_HEIGHT + TILE_SIZE - 1) / TILE_SIZE + 1;
+    EXPECT_GT(tileCache->renderedTiles(), rendered);
+    EXPECT_LE(tileCache->renderedTiles() - rendered, tilesPerColumn);
+}
+
+TEST_F(TileCacheTest, Invalidate) {
+    render();
+    auto tiles = tileCache->size();
+    auto rendered = tileCache->renderedTiles();
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<lc::entity::Line>(
+            lc::geo::Coordinate(501., 501.),
+            lc::geo::Coordinate(502., 502.),
+            document->layerByName("0")
+    ));
+    builder->execute();
+
+    // Only the tiles around the new line are rendered again
+    EXPECT_LT(tileCache->size(), tiles);
+    EXPECT_GE(tileCache->size(), tiles - 4);
+
+    render();
+    EXPECT_EQ(tiles, tileCache->size());
+    EXPECT_LE(tileCache->renderedTiles() - rendered, 4);
+}
+
+TEST_F(TileCacheTest, InvalidateBatch) {
+    render();
+    auto tiles = tileCache->size();
+
+    // Remove the lines of a area in a single operation
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    unsigned int removed = 0;
+    for (const auto& entity : document->entityContainer().asVector()) {
+        if (entity->boundingBox().inArea(lc::geo::Area(lc::geo::Coordinate(400., 400.), lc::geo::Coordinate(500., 500.)))) {
+            builder->appendEntity(entity);
+            removed++;
+        }
+    }
+    builder->appendOperation(std::make_shared<lc::operation::Push>());
+    builder->appendOperation(std::make_shared<lc::operation::Remove>());
+    builder->execute();
+
+    ASSERT_EQ(100, removed);
+    EXPECT_EQ(10000 - removed, document->entityContainer().asVector().size());
+    EXPECT_LT(tileCache->size(), tiles);
+    EXPECT_GT(tileCache->size(), 0);
+
+    render();
+    EXPECT_EQ(tiles, tileCache->size());
+}
+
+TEST_F(TileCacheTest, MaximumBytes) {
+    const size_t maximumBytes = 4 * TILE_SIZE * TILE_SIZE * 4;
+    createTileCache(maximumBytes);
+
+    render();
+    EXPECT_LE(tileCache->bytes(), maximumBytes);
+    EXPECT_EQ(4, tileCache->size());
+
+    EXPECT_TRUE(std::all_of(image.begin(), image.end(), [](unsigned char value) {
+        return value == 0xFF;
+    }));
+}
+
+TEST_F(TileCacheTest, Selection) {
+    render();
+    auto tiles = tileCache->size();
+
+    // Selecting a single line only invalidates the tiles around it
+    docCanvas->makeSelection(499., 499., 8., 8., true);
+    docCanvas->closeSelection();
+    EXPECT_EQ(1, docCanvas->selectedDrawables().size());
+    EXPECT_LT(tileCache->size(), tiles);
+    EXPECT_GE(tileCache->size(), tiles - 4);
+}
+
+TEST_F(TileCacheTest, SelectPoint) {
+    render();
+    auto tiles = tileCache->size();
+    auto rendered = tileCache->renderedTiles();
+
+    // Clicking a line selects it and invalidates the tiles around it
+    docCanvas->selectPoint(502., 502.);
+    ASSERT_EQ(1, docCanvas->selectedDrawables().size());
+    EXPECT_TRUE(docCanvas->selectedDrawables().front()->selected());
+    EXPECT_LT(tileCache->size(), tiles);
+    EXPECT_GE(tileCache->size(), tiles - 4);
+
+    render();
+    EXPECT_GT(tileCache->renderedTiles(), rendered);
+    EXPECT_EQ(tiles, tileCache->size());
+
+    // Clicking it again removes the selection
+    docCanvas->selectPoint(502., 502.);
+    EXPECT_TRUE(docCanvas->selectedDrawables().empty());
+    EXPECT_LT(tileCache->size(), tiles);
+}
+
+TEST_F(TileCacheTest, DrawOptions) {
+    render();
+    auto tiles = tileCache->size();
+    auto rendered = tileCache->renderedTiles();
+
+    // Tiles rendered with other options can't be used anymore
+    auto options = docCanvas->drawOptions();
+    options.setLevelOfDetail(lc::viewer::LOD_SKIP);
+    docCanvas->setDrawOptions(options);
+    EXPECT_EQ(0, tileCache->size());
+
+    render();
+    EXPECT_EQ(tiles, tileCache->size());
+    EXPECT_EQ(rendered + tiles, tileCache->renderedTiles());
+}
+
+TEST_F(TileCacheTest, WideLines) {
+    render();
+    auto tiles = tileCache->size();
+    auto rendered = tileCache->renderedTiles();
+
+    // A line far outside the visible area, but wider than the default margin
+    auto layer = std::make_shared<lc::meta::Layer>("wide", lc::meta::MetaLineWidthByValue(20.), lc::Color(0., 1., 0.));
+    std::make_shared<lc::operation::AddLayer>(document, layer)->execute();
+
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    builder->appendEntity(std::make_shared<lc::entity::Line>(
+            lc::geo::Coordinate(5000., 5000.),
+            lc::geo::Coordinate(5001., 5001.),
+            layer
+    ));
+    builder->execute();
+
+    EXPECT_EQ(tiles, tileCache->size());
+    EXPECT_GE(docCanvas->maximumStrokeWidth(), 30.);
+
+    // The cached tiles were rendered with a too small margin
+    render();
+    EXPECT_EQ(tiles, tileCache->size());
+    EXPECT_EQ(rendered + tiles, tileCache->renderedTiles());
+}
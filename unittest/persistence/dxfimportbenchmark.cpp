@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <file.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include "benchmarkhelpers.h"
+
+using lc::test::elapsed;
+
+/*
+ * Open and save a generated DXF file with a large number of lines, circles and arcs
+ */
+namespace {
+    const unsigned int BENCHMARK_ENTITIES = 1000000;
+
+    const lc::geo::Area BENCHMARK_AREA(lc::geo::Coordinate(-400000., -400000.), lc::geo::Coordinate(400000., 400000.));
+
+    void writeDXF(const std::string& path, unsigned int entities) {
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<int> color(1, 255);
+
+        std::ofstream file(path);
+        file << "0\nSECTION\n2\nENTITIES\n";
+
+        auto randomEntities = lc::test::randomEntities(entities, BENCHMARK_AREA, 50.);
+        for (unsigned int i = 0; i < randomEntities.size(); i++) {
+            const auto& entity = randomEntities[i];
+            auto line = std::dynamic_pointer_cast<const lc::entity::Line>(entity);
+            auto circle = std::dynamic_pointer_cast<const lc::entity::Circle>(entity);
+            auto arc = std::dynamic_pointer_cast<const lc::entity::Arc>(entity);
+
+            if (line) {
+                file << "0\nLINE\n8\n0\n";
+            }
+            else if (circle) {
+                file << "0\nCIRCLE\n8\n0\n";
+            }
+            else {
+                file << "0\nARC\n8\n0\n";
+            }
+
+            // Some entities with a color, most are BYLAYER
+            if (i % 10 == 0) {
+                file << "62\n" << color(gen) << "\n";
+            }
+
+            if (line) {
+                file << "10\n" << line->start().x() << "\n20\n" << line->start().y() << "\n30\n0.0\n"
+                     << "11\n" << line->end().x() << "\n21\n" << line->end().y() << "\n31\n0.0\n";
+            }
+            else if (circle) {
+                file << "10\n" << circle->center().x() << "\n20\n" << circle->center().y() << "\n30\n0.0\n"
+                     << "40\n" << circle->radius() << "\n";
+            }
+            else if (arc) {
+                file << "10\n" << arc->center().x() << "\n20\n" << arc->center().y() << "\n30\n0.0\n"
+                     << "40\n" << arc->radius() << "\n"
+                     << "50\n" << arc->startAngle() * 180. / M_PI << "\n51\n" << arc->endAngle() * 180. / M_PI << "\n";
+            }
+        }
+
+        file << "0\nENDSEC\n0\nEOF\n";
+    }
+}
+
+/*
+ * The generated file is shared by all benchmarks and written only once
+ */
+class DXFImportBenchmark : public testing::Test {
+    protected:
+        static void SetUpTestCase() {
+            writeDXF(path(), BENCHMARK_ENTITIES);
+        }
+
+        static void TearDownTestCase() {
+            std::remove(path().c_str());
+        }
+
+        static std::string path() {
+            return testing::TempDir() + "dxfimportbenchmark.dxf";
+        }
+};
+
+TEST_F(DXFImportBenchmark, OpenFile) {
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+
+    auto start = std::chrono::steady_clock::now();
+    lc::persistence::File::open(document, path(), lc::persistence::File::LIBDXFRW);
+    double openTime = elapsed(start);
+
+    std::cout << "DXF import: " << BENCHMARK_ENTITIES << " entities in " << openTime << "ms, "
+              << BENCHMARK_ENTITIES / (openTime / 1000.) << " entities/s" << std::endl;
+
+    EXPECT_EQ(BENCHMARK_ENTITIES, document->entityContainer().asVector().size());
+}
+
+TEST_F(DXFImportBenchmark, SaveFile) {
+    const std::string savePath = testing::TempDir() + "dxfexportbenchmark.dxf";
+
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    lc::persistence::File::open(document, path(), lc::persistence::File::LIBDXFRW);
+
+    auto start = std::chrono::steady_clock::now();
+    lc::persistence::File::save(document, savePath, lc::persistence::File::LIBDXFRW_DXF_R2000);
+    double saveTime = elapsed(start);
+
+    std::cout << "DXF export: " << BENCHMARK_ENTITIES << " entities in " << saveTime << "ms, "
+              << BENCHMARK_ENTITIES / (saveTime / 1000.) << " entities/s" << std::endl;
+
+    // Round trip
+    auto saved = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    lc::persistence::File::open(saved, savePath, lc::persistence::File::LIBDXFRW);
+    EXPECT_EQ(BENCHMARK_ENTITIES, saved->entityContainer().asVector().size());
+
+    std::remove(savePath.c_str());
+}
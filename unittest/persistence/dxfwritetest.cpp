@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <file.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/operations/entitybuilder.h>
+#include <cad/primitive/dimaligned.h>
+#include <cad/primitive/lwpolyline.h>
+#include <cad/primitive/text.h>
+
+/*
+ * Save entities and open them again
+ */
+namespace {
+    template<typename T>
+    std::shared_ptr<const T> findEntity(const lc::storage::Document_SPtr& document) {
+        for (const auto& entity : document->entityContainer().asVector()) {
+            auto result = std::dynamic_pointer_cast<const T>(entity);
+            if (result != nullptr) {
+                return result;
+            }
+        }
+
+        return nullptr;
+    }
+
+    lc::storage::Document_SPtr roundTrip(const std::vector<lc::entity::CADEntity_CSPtr>& entities) {
+        const std::string path = "dxfwritetest.dxf";
+
+        auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+        auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+        for (const auto& entity : entities) {
+            builder->appendEntity(entity);
+        }
+        builder->execute();
+
+        lc::persistence::File::save(document, path, lc::persistence::File::LIBDXFRW_DXF_R2000);
+
+        auto saved = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+        lc::persistence::File::open(saved, path, lc::persistence::File::LIBDXFRW);
+
+        std::remove(path.c_str());
+        return saved;
+    }
+
+    const auto layer = std::make_shared<const lc::meta::Layer>();
+}
+
+TEST(DXFWriteTest, LWPolyline) {
+    std::vector<lc::entity::LWVertex2D> vertex;
+    vertex.emplace_back(lc::geo::Coordinate(0., 0.));
+    vertex.emplace_back(lc::geo::Coordinate(10., 0.), 1.);
+    vertex.emplace_back(lc::geo::Coordinate(10., 10.));
+
+    auto document = roundTrip({std::make_shared<lc::entity::LWPolyline>(
+            vertex, 0., 0., 0., true, lc::geo::Coordinate(0., 0., 1.), layer
+    )});
+
+    auto lwPolyline = findEntity<lc::entity::LWPolyline>(document);
+    ASSERT_NE(nullptr, lwPolyline);
+    EXPECT_TRUE(lwPolyline->closed());
+    ASSERT_EQ(3, lwPolyline->vertex().size());
+    EXPECT_EQ(lc::geo::Coordinate(10., 10.), lwPolyline->vertex()[2].location());
+    EXPECT_DOUBLE_EQ(1., lwPolyline->vertex()[1].bulge());
+}
+
+TEST(DXFWriteTest, Text) {
+    auto document = roundTrip({std::make_shared<lc::entity::Text>(
+            lc::geo::Coordinate(5., 6.), "LibreCAD", 2.5, 0., "STANDARD",
+            lc::TextConst::None, lc::TextConst::HALeft, lc::TextConst::VABaseline, layer
+    )});
+
+    auto text = findEntity<lc::entity::Text>(document);
+    ASSERT_NE(nullptr, text);
+    EXPECT_EQ("LibreCAD", text->text_value());
+    EXPECT_EQ(lc::geo::Coordinate(5., 6.), text->insertion_point());
+    EXPECT_DOUBLE_EQ(2.5, text->height());
+}
+
+TEST(DXFWriteTest, DimAligned) {
+    auto document = roundTrip({std::make_shared<lc::entity::DimAligned>(
+            lc::geo::Coordinate(10., 5.), lc::geo::Coordinate(5., 5.), lc::TextConst::Middle_center, 0., 1.,
+            lc::TextConst::AtLeast, "", lc::geo::Coordinate(0., 0.), lc::geo::Coordinate(10., 0.), layer
+    )});
+
+    auto dimension = findEntity<lc::entity::DimAligned>(document);
+    ASSERT_NE(nullptr, dimension);
+    EXPECT_EQ(lc::geo::Coordinate(10., 5.), dimension->definitionPoint());
+    EXPECT_EQ(lc::geo::Coordinate(0., 0.), dimension->definitionPoint2());
+    EXPECT_EQ(lc::geo::Coordinate(10., 0.), dimension->definitionPoint3());
+}
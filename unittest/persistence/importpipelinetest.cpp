@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <generic/importpipeline.h>
+#include <cad/storage/documentimpl.h>
+#include <cad/storage/storagemanagerimpl.h>
+#include <cad/primitive/line.h>
+
+using lc::persistence::ImportPipeline;
+
+namespace {
+    /**
+     * Remember the order in which entities are added to the document
+     */
+    struct AddEntityRecorder {
+        std::vector<lc::entity::CADEntity_CSPtr> entities;
+
+        void on_addEntitiesEvent(const lc::event::AddEntitiesEvent& event) {
+            entities.insert(entities.end(), event.entities().begin(), event.entities().end());
+        }
+    };
+}
+
+TEST(ImportPipelineTest, Order) {
+    AddEntityRecorder recorder;
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    document->addEntitiesEvent().connect<AddEntityRecorder, &AddEntityRecorder::on_addEntitiesEvent>(&recorder);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    auto layer = document->layerByName("0");
+
+    const unsigned int count = ImportPipeline::BATCH_SIZE * ImportPipeline::MAXIMUM_QUEUED_BATCHES * 3 + 17;
+
+    ImportPipeline pipeline(builder, 4);
+    for (unsigned int i = 0; i < count; i++) {
+        pipeline.push([i, layer]() {
+            return std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0.), lc::geo::Coordinate(i, 10.), layer);
+        });
+    }
+
+    EXPECT_EQ(count, pipeline.finish());
+    builder->execute();
+
+    // Entities are added in the order of the file, not in the order the workers finished, and so are their IDs
+    ASSERT_EQ(count, recorder.entities.size());
+    for (unsigned int i = 0; i < count; i++) {
+        auto line = std::dynamic_pointer_cast<const lc::entity::Line>(recorder.entities[i]);
+        ASSERT_NE(nullptr, line);
+        EXPECT_EQ(i, line->start().x());
+        EXPECT_EQ(recorder.entities[0]->id() + i, line->id());
+    }
+    EXPECT_EQ(count, document->entityContainer().asVector().size());
+}
+
+TEST(ImportPipelineTest, SmallFile) {
+    AddEntityRecorder recorder;
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    document->addEntitiesEvent().connect<AddEntityRecorder, &AddEntityRecorder::on_addEntitiesEvent>(&recorder);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    auto layer = document->layerByName("0");
+
+    ImportPipeline pipeline(builder);
+    for (unsigned int i = 0; i < 10; i++) {
+        pipeline.push([i, layer]() {
+            return std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0.), lc::geo::Coordinate(i, 10.), layer);
+        });
+    }
+
+    // Skipped entity
+    pipeline.push([]() {
+        return nullptr;
+    });
+
+    EXPECT_EQ(10, pipeline.finish());
+    builder->execute();
+    EXPECT_EQ(10, recorder.entities.size());
+}
+
+TEST(ImportPipelineTest, Exception) {
+    AddEntityRecorder recorder;
+    auto document = std::make_shared<lc::storage::DocumentImpl>(std::make_shared<lc::storage::StorageManagerImpl>());
+    document->addEntitiesEvent().connect<AddEntityRecorder, &AddEntityRecorder::on_addEntitiesEvent>(&recorder);
+    auto builder = std::make_shared<lc::operation::EntityBuilder>(document);
+    auto layer = document->layerByName("0");
+
+    ImportPipeline pipeline(builder, 2);
+    for (unsigned int i = 0; i < ImportPipeline::BATCH_SIZE * 4; i++) {
+        if (i == ImportPipeline::BATCH_SIZE * 2) {
+            pipeline.push([]() -> lc::entity::CADEntity_CSPtr {
+                throw std::runtime_error("Invalid entity");
+            });
+        }
+
+        pipeline.push([i, layer]() {
+            return std::make_shared<lc::entity::Line>(lc::geo::Coordinate(i, 0.), lc::geo::Coordinate(i, 10.), layer);
+        });
+    }
+
+    EXPECT_THROW(pipeline.finish(), std::runtime_error);
+    builder->execute();
+    EXPECT_TRUE(recorder.entities.empty());
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <generic/metainfocache.h>
+
+using namespace lc;
+
+TEST(MetaInfoCacheTest, Shared) {
+    persistence::MetaInfoCache cache;
+    auto color = std::make_shared<const meta::MetaColorByValue>(1., 0., 0.);
+    auto lineWidth = std::make_shared<const meta::MetaLineWidthByValue>(0.5);
+
+    auto metaInfo = cache.metaInfo(color, lineWidth, nullptr);
+    ASSERT_NE(nullptr, metaInfo);
+    EXPECT_EQ(color, metaInfo->at(meta::MetaColor::LCMETANAME()));
+    EXPECT_EQ(2, metaInfo->size());
+
+    // Same meta types, same MetaInfo
+    EXPECT_EQ(metaInfo, cache.metaInfo(color, lineWidth, nullptr));
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(MetaInfoCacheTest, Different) {
+    persistence::MetaInfoCache cache;
+    auto red = std::make_shared<const meta::MetaColorByValue>(1., 0., 0.);
+    auto otherRed = std::make_shared<const meta::MetaColorByValue>(1., 0., 0.);
+
+    // Meta types are compared by pointer
+    auto metaInfo = cache.metaInfo(red, nullptr, nullptr);
+    EXPECT_NE(metaInfo, cache.metaInfo(otherRed, nullptr, nullptr));
+    EXPECT_NE(metaInfo, cache.metaInfo(red, std::make_shared<const meta::MetaLineWidthByValue>(0.5), nullptr));
+    EXPECT_EQ(3, cache.size());
+}
+
+TEST(MetaInfoCacheTest, Empty) {
+    persistence::MetaInfoCache cache;
+
+    EXPECT_EQ(nullptr, cache.metaInfo(nullptr, nullptr, nullptr));
+    EXPECT_EQ(0, cache.size());
+}